@@ -0,0 +1,102 @@
+// Farm - a headless command line tool that plays many games on every core and
+// reports how they went.
+//
+// usage: Farm [games] [policy] [threads] [seed] [maxShapes]
+//   games:     how many games to play (default 1000)
+//   policy:    who plays them (default bot):
+//                bot       - BotPolicy with its default weights
+//                beam      - BeamPolicy with its default weights and beam width
+//                            (one search thread per game: the farm already fills every core)
+//                expectimax - ExpectimaxPolicy with its default weights and depth, one
+//                            search thread per game and no time budget (so a run
+//                            plays the same games on any machine)
+//                random    - RandomPolicy
+//                LRDUH.    - any other word is a ScriptedPolicy script (see InputPolicy.h)
+//   threads:   worker threads (default 0, one per core)
+//   seed:      the seed every game's seed is dealt from (default 1)
+//   maxShapes: stop a game after this many shapes (0 to play until it tops out; the
+//              default is BOT_MAX_SHAPES for bot, beam and expectimax and 0 for
+//              the others)
+//
+// It prints the throughput (shapes and games per second) and the spread of the
+// scores and rows cleared.  The same seed always plays the same games, so two bot
+// versions can be compared on exactly the same piece sequences.
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include "BeamSearch.h"
+#include "ExpectimaxSearch.h"
+#include "GameFarm.h"
+#include "InputPolicy.h"
+
+static const int BOT_MAX_SHAPES = 10000;	// the default shape cap for the bots (a good one may never top out)
+
+// print one line of a distribution
+// - param 1: a string, what the numbers are
+// - param 2: the Distribution
+// - return: nothing
+static void printDistribution(const std::string &name, const GameFarm::Distribution &spread)
+{
+	std::cout << name << "  min " << spread.min << "  p10 " << spread.p10 << "  median " << spread.median
+		<< "  p90 " << spread.p90 << "  max " << spread.max << "  mean " << spread.mean << "\n";
+}
+
+int main(int argc, char *argv[])
+{
+	int games = (argc > 1) ? std::atoi(argv[1]) : 1000;
+	std::string policy = (argc > 2) ? argv[2] : "bot";
+	int threads = (argc > 3) ? std::atoi(argv[3]) : 0;
+	uint64_t seed = (argc > 4) ? std::strtoull(argv[4], nullptr, 10) : 1;
+
+	if (games < 1)
+	{
+		std::cerr << "games must be at least 1\n";
+		return 1;
+	}
+
+	GameFarm::PolicyFactory makePolicy;
+	int defaultShapes = 0;
+	if (policy == "bot")
+	{
+		makePolicy = []() { return std::unique_ptr<InputPolicy>(new BotPolicy()); };
+		defaultShapes = BOT_MAX_SHAPES;
+	}
+	else if (policy == "beam")
+	{
+		makePolicy = []() { return std::unique_ptr<InputPolicy>(new BeamPolicy(BotPolicy::Weights(), BeamSearch::DEFAULT_BEAM_WIDTH, 1)); };
+		defaultShapes = BOT_MAX_SHAPES;
+	}
+	else if (policy == "expectimax")
+	{
+		makePolicy = []() { return std::unique_ptr<InputPolicy>(new ExpectimaxPolicy(BotPolicy::Weights(), ExpectimaxSearch::DEFAULT_CHANCE_PLIES,
+			0, ExpectimaxSearch::DEFAULT_BRANCHING, 1)); };
+		defaultShapes = BOT_MAX_SHAPES;
+	}
+	else if (policy == "random")
+	{
+		makePolicy = []() { return std::unique_ptr<InputPolicy>(new RandomPolicy()); };
+	}
+	else if (policy.find_first_not_of("LRDUH.") == std::string::npos)
+	{
+		makePolicy = [policy]() { return std::unique_ptr<InputPolicy>(new ScriptedPolicy(policy)); };
+	}
+	else
+	{
+		std::cerr << "unknown policy: " << policy << " (use bot, beam, expectimax, random or a script of LRDUH.)\n";
+		return 1;
+	}
+	int maxShapes = (argc > 5) ? std::atoi(argv[5]) : defaultShapes;
+
+	GameFarm farm(makePolicy, threads);
+	std::cout << "farm " << games << " games, " << policy << " policy, " << farm.getThreads() << " threads, seed " << seed << "\n";
+	GameFarm::Report report = farm.run(games, seed, maxShapes);
+
+	std::cout << "time " << report.seconds << "s  shapes " << report.shapes << "  frames " << report.frames
+		<< "  steals " << report.steals << "\n";
+	std::cout << "shapes/s " << static_cast<uint64_t>(report.shapesPerSecond) << "  games/s " << report.gamesPerSecond << "\n";
+	printDistribution("score", report.scores);
+	printDistribution("rows ", report.rowsCleared);
+	return 0;
+}
@@ -0,0 +1,204 @@
+// Playback - a headless command line tool that checks recorded games.
+//
+// usage: Playback file...
+//          play each replay back as fast as it will go and check it ends as recorded
+//        Playback record file [seed] [maxShapes]
+//          record a game played by BotPolicy (default seed 1, play until it tops out),
+//          with keyframes every Replay::KEYFRAME_INTERVAL shapes
+//        Playback index file [interval]
+//          (re)build a replay's keyframes, every interval shapes
+//        Playback seek file piece
+//          seek to the start of a shape and time it, with the keyframes and without
+//
+// Checking prints one line per replay (ok or FAILED, its size, inputs and frames,
+// and for a replay that plays out differently, the frame of the first recorded
+// checksum that no longer matches) and then the totals: replays and frames
+// checked per second.  The exit code is the number of replays that failed (so 0
+// when every replay checked out).
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "InputPolicy.h"
+#include "Replay.h"
+#include "TetrisListener.h"
+
+// counts the shapes a game locks
+class ShapeCounter : public TetrisListener
+{
+public:
+	int shapes{ 0 };
+
+	void onShapeLocked() override { shapes++; }
+};
+
+// record a bot game
+// - param 1: a string, the file to save the replay to
+// - param 2: a uint64_t, the game's seed
+// - param 3: an int, the most shapes to play (0 for no cap)
+// - return: an int, the exit code
+static int record(const std::string &path, uint64_t seed, int maxShapes)
+{
+	BotPolicy bot;
+	Replay replay;
+	TetrisEngine engine(seed);
+	ShapeCounter counter;
+	engine.setListener(&counter);
+	bot.newGame(seed);
+	replay.start(engine);
+
+	TetrisEngine::Input inputs[InputPolicy::MAX_INPUTS];
+	while (!engine.getGameOver() && (maxShapes <= 0 || counter.shapes < maxShapes))
+	{
+		int count = bot.chooseInputs(engine, inputs);
+		for (int i = 0; i < count; i++)
+		{
+			replay.record(engine.getFrame(), inputs[i]);
+			engine.input(inputs[i]);
+		}
+		engine.step();
+		replay.recordChecksum(engine);
+	}
+	replay.finish(engine);
+	replay.buildKeyframes();
+
+	if (!replay.save(path))
+	{
+		std::cerr << "could not write " << path << "\n";
+		return 1;
+	}
+	std::cout << path << ": " << counter.shapes << " shapes, " << replay.getEvents().size() << " inputs, "
+		<< replay.getFinalFrame() << " frames, score " << replay.getFinalScore() << ", "
+		<< replay.encode().size() << " bytes, " << replay.getKeyframes().size() << " keyframes\n";
+	return 0;
+}
+
+// rebuild a replay's keyframes
+// - param 1: a string, the replay's file
+// - param 2: an int, the shapes between keyframes
+// - return: an int, the exit code
+static int index(const std::string &path, int interval)
+{
+	Replay replay;
+	if (interval < 1 || !replay.load(path))
+	{
+		std::cerr << "could not read " << path << "\n";
+		return 1;
+	}
+	replay.buildKeyframes(interval);
+	if (!replay.save(path))
+	{
+		std::cerr << "could not write " << path << "\n";
+		return 1;
+	}
+	std::cout << path << ": " << replay.getKeyframes().size() << " keyframes, " << replay.encode().size() << " bytes\n";
+	return 0;
+}
+
+// seek a replay to a shape, with its keyframes and then without, and time both
+// - param 1: a string, the replay's file
+// - param 2: an int, the shapes locked
+// - return: an int, the exit code (1 if the two seeks disagree)
+static int seek(const std::string &path, int piece)
+{
+	Replay replay;
+	if (!replay.load(path))
+	{
+		std::cerr << "could not read " << path << "\n";
+		return 1;
+	}
+	auto start = std::chrono::steady_clock::now();
+	TetrisEngine sought = replay.seekPiece(piece);
+	std::chrono::duration<double, std::milli> keyed = std::chrono::steady_clock::now() - start;
+
+	// the same seek from the start of the game
+	start = std::chrono::steady_clock::now();
+	TetrisEngine played = replay.createEngine();
+	ShapeCounter counter;
+	played.setListener(&counter);
+	while (counter.shapes < piece && played.getFrame() < replay.getFinalFrame() && !played.getGameOver())
+	{
+		replay.playTo(played, played.getFrame() + 1);
+	}
+	std::chrono::duration<double, std::milli> unkeyed = std::chrono::steady_clock::now() - start;
+
+	bool same = sought.getFrame() == played.getFrame() && sought.getScore() == played.getScore();
+	std::cout << path << ": shape " << piece << " is frame " << sought.getFrame() << ", score " << sought.getScore()
+		<< "  seek " << keyed.count() << "ms with " << replay.getKeyframes().size() << " keyframes, "
+		<< unkeyed.count() << "ms without" << (same ? "" : "  MISMATCH") << "\n";
+	return same ? 0 : 1;
+}
+
+int main(int argc, char *argv[])
+{
+	if (argc < 2)
+	{
+		std::cerr << "usage: Playback file...  or  Playback record|index|seek ... (see PlaybackMain.cpp)\n";
+		return 1;
+	}
+	if (std::string(argv[1]) == "record")
+	{
+		if (argc < 3)
+		{
+			std::cerr << "usage: Playback record file [seed] [maxShapes]\n";
+			return 1;
+		}
+		uint64_t seed = (argc > 3) ? std::strtoull(argv[3], nullptr, 10) : 1;
+		int maxShapes = (argc > 4) ? std::atoi(argv[4]) : 0;
+		return record(argv[2], seed, maxShapes);
+	}
+	if (std::string(argv[1]) == "index")
+	{
+		if (argc < 3)
+		{
+			std::cerr << "usage: Playback index file [interval]\n";
+			return 1;
+		}
+		return index(argv[2], (argc > 3) ? std::atoi(argv[3]) : Replay::KEYFRAME_INTERVAL);
+	}
+	if (std::string(argv[1]) == "seek")
+	{
+		if (argc < 4)
+		{
+			std::cerr << "usage: Playback seek file piece\n";
+			return 1;
+		}
+		return seek(argv[2], std::atoi(argv[3]));
+	}
+
+	int failed = 0;
+	uint64_t frames = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 1; i < argc; i++)
+	{
+		Replay replay;
+		if (!replay.load(argv[i]))
+		{
+			std::cout << argv[i] << ": FAILED (not a replay)\n";
+			failed++;
+			continue;
+		}
+		bool ok = replay.verify();
+		failed += ok ? 0 : 1;
+		frames += replay.getFinalFrame();
+		std::cout << argv[i] << ": " << (ok ? "ok" : "FAILED") << "  " << replay.encode().size() << " bytes  "
+			<< replay.getEvents().size() << " inputs  " << replay.getFinalFrame() << " frames";
+		uint32_t desync = ok ? Replay::NO_DESYNC : replay.findDesync();
+		if (desync != Replay::NO_DESYNC)
+		{
+			std::cout << "  (drifts from the recording by frame " << desync << ")";
+		}
+		std::cout << "\n";
+	}
+	std::chrono::duration<double> seconds = std::chrono::steady_clock::now() - start;
+
+	std::cout << (argc - 1 - failed) << " of " << (argc - 1) << " replays ok  time " << seconds.count() << "s";
+	if (seconds.count() > 0)
+	{
+		std::cout << "  replays/s " << (argc - 1) / seconds.count() << "  frames/s " << static_cast<uint64_t>(frames / seconds.count());
+	}
+	std::cout << "\n";
+	return failed;
+}
@@ -0,0 +1,26 @@
+#include <cstdlib>
+#include <new>
+#include "CountingAllocator.h"
+
+std::atomic<long long> allocationCount{ 0 };
+
+// Replace the global allocation functions so every heap allocation is counted.
+//   (the array forms and the nothrow forms call these, so they are counted too)
+
+void* operator new(std::size_t size)
+{
+	allocationCount++;
+	void* memory = std::malloc(size > 0 ? size : 1);
+	if (memory == nullptr) { throw std::bad_alloc(); }
+	return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+	std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept
+{
+	std::free(memory);
+}
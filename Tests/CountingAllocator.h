@@ -0,0 +1,18 @@
+// CountingAllocator replaces the global operator new and delete so the test
+// suite can check that code does not touch the heap: allocationCount goes up by
+// one for every allocation made through operator new.
+//
+// Only the Tests project links CountingAllocator.cpp (and defines ALLOCATIONS,
+// which turns on the tests that read the count).  The game and the tools keep
+// the standard allocation functions.
+
+#ifndef COUNTINGALLOCATOR_H
+#define COUNTINGALLOCATOR_H
+
+#include <atomic>
+
+// the heap allocations made since the program started
+//   (atomic, as some tests - GameFarm - allocate on several threads at once)
+extern std::atomic<long long> allocationCount;
+
+#endif /* COUNTINGALLOCATOR_H */
@@ -0,0 +1,15 @@
+// Tests - a headless command line tool that runs the TestSuite.
+//
+// usage: Tests
+//
+// It runs the same tests as the game does at startup, plus the ones that need
+// heap allocations counted (ALLOCATIONS, see CountingAllocator.h), which only
+// this project can run.  A failed test stops it with an assert.
+
+#include "TestSuite.h"
+
+int main()
+{
+	TestSuite::runTestSuite();
+	return 0;
+}
@@ -0,0 +1,123 @@
+#include <cassert>
+#include <cstring>
+#include "BatchLegality.h"
+
+using TetrominoTables::Orientation;
+using TetrominoTables::ROTATION_COUNT;
+
+static const uint16_t LEFT_WALL = (1 << BatchLegality::WALL_BITS) - 1;
+static const uint16_t RIGHT_WALL = static_cast<uint16_t>(0xFFFF << (BatchLegality::WALL_BITS + Gameboard::MAX_X));
+static const uint16_t FULL_ROW = 0xFFFF;
+
+// a shape's 4 row masks in one word, row 0 in the low 16 bits
+static uint64_t shapeWord(const Orientation &o)
+{
+	uint64_t word = 0;
+	for (int row = 0; row < TetrominoTables::BLOCK_COUNT; row++)
+	{
+		word |= static_cast<uint64_t>(o.rowMasks[row]) << (16 * row);
+	}
+	return word;
+}
+
+// 4 padded rows in one word, the top row in the low 16 bits (x86 is little endian)
+static uint64_t rowsWord(const uint16_t *rows)
+{
+	uint64_t word;
+	std::memcpy(&word, rows, sizeof(word));
+	return word;
+}
+
+// where a candidate's shape word lines up against the board: the shift that puts
+// its left column in place and the padded row its top row is on (clamped so the
+// shape still hits a wall or the floor, or stays above the board)
+static void lineUp(const Orientation *orientations, const BatchLegality::Candidate &candidate, int &rotation, int &shift, int &rowIndex)
+{
+	rotation = candidate.rotation & (ROTATION_COUNT - 1);
+	int left = candidate.x + orientations[rotation].minX;
+	int top = candidate.y + orientations[rotation].minY;
+	left = (left < -BatchLegality::WALL_BITS) ? -BatchLegality::WALL_BITS : ((left > Gameboard::MAX_X) ? Gameboard::MAX_X : left);
+	top = (top < -BatchLegality::ABOVE_BOARD) ? -BatchLegality::ABOVE_BOARD : ((top > Gameboard::MAX_Y) ? Gameboard::MAX_Y : top);
+	shift = left + BatchLegality::WALL_BITS;
+	rowIndex = top + BatchLegality::ABOVE_BOARD;
+}
+
+// copy a board into a PaddedBoard
+//   (worth keeping when several batches are tested against the same board)
+// - param 1: the Gameboard to copy
+// - param 2: a PaddedBoard, filled in
+// - return: nothing
+void BatchLegality::pad(const Gameboard &board, PaddedBoard &padded)
+{
+	const uint16_t *rows = board.getRowMasks();
+	for (int y = 0; y < ABOVE_BOARD; y++)
+	{
+		padded.rows[y] = LEFT_WALL | RIGHT_WALL;
+	}
+	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	{
+		padded.rows[ABOVE_BOARD + y] = static_cast<uint16_t>(rows[y] << WALL_BITS) | LEFT_WALL | RIGHT_WALL;
+	}
+	for (int y = ABOVE_BOARD + Gameboard::MAX_Y; y < PADDED_ROWS; y++)
+	{
+		padded.rows[y] = FULL_ROW;
+	}
+}
+
+// Test which candidate positions of a shape fit on a board.
+// assert count is not more than MAX_CANDIDATES
+// - param 1: a PaddedBoard (see pad())
+// - param 2: the TetShape to test
+// - param 3: an array of Candidates
+// - param 4: an int, the number of candidates
+// - return: a uint64_t with bit i set when candidate i fits
+uint64_t BatchLegality::test(const PaddedBoard &padded, TetShape shape, const Candidate *candidates, int count)
+{
+	assert(count <= MAX_CANDIDATES && "BatchLegality - too many candidates");
+
+	const Orientation *orientations = TetrominoTables::SHAPES.orientations[shape];
+	uint64_t shapes[ROTATION_COUNT];
+	for (int rotation = 0; rotation < ROTATION_COUNT; rotation++)
+	{
+		shapes[rotation] = shapeWord(orientations[rotation]);
+	}
+
+	// every candidate: all 4 rows, the walls and the floor in one 64-bit AND
+	uint64_t legal = 0;
+	for (int i = 0; i < count; i++)
+	{
+		int rotation, shift, rowIndex;
+		lineUp(orientations, candidates[i], rotation, shift, rowIndex);
+		uint64_t hits = (shapes[rotation] << shift) & rowsWord(padded.rows + rowIndex);
+		legal |= static_cast<uint64_t>(hits == 0) << i;
+	}
+	return legal;
+}
+
+// Test which candidate positions of a shape fit on a board.
+//   (pads the board, then tests against that)
+// assert count is not more than MAX_CANDIDATES
+// - param 1: the Gameboard to test against
+// - param 2: the TetShape to test
+// - param 3: an array of Candidates
+// - param 4: an int, the number of candidates
+// - return: a uint64_t with bit i set when candidate i fits
+uint64_t BatchLegality::test(const Gameboard &board, TetShape shape, const Candidate *candidates, int count)
+{
+	PaddedBoard padded;
+	pad(board, padded);
+	return test(padded, shape, candidates, count);
+}
+
+// Test whether a single candidate position of a shape fits (the same test as test())
+// - param 1: a PaddedBoard (see pad())
+// - param 2: the TetShape to test
+// - param 3: a Candidate
+// - return: true if the candidate fits
+bool BatchLegality::fits(const PaddedBoard &padded, TetShape shape, const Candidate &candidate)
+{
+	const Orientation *orientations = TetrominoTables::SHAPES.orientations[shape];
+	int rotation, shift, rowIndex;
+	lineUp(orientations, candidate, rotation, shift, rowIndex);
+	return ((shapeWord(orientations[rotation]) << shift) & rowsWord(padded.rows + rowIndex)) == 0;
+}
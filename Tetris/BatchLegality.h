@@ -0,0 +1,87 @@
+// Batch legality tests many candidate positions of one shape against one board.
+//
+// Search code (move generators, kick resolvers, bots) tends to ask the same
+// question dozens of times in a row: does this shape fit at (x, y, rotation)?
+// test() answers it for a whole array of candidates and returns the answers as
+// a bitmask (bit i set when candidate i fits).
+//
+// The board is first copied into a PaddedBoard: its row masks with the walls
+// and the floor filled in, and open rows (walls only) above the top.  Then any
+// 4 consecutive rows can be read as one 64-bit word, and so can a shape's 4 row
+// masks (see TetrominoTables.h).  Each candidate is one shift and one AND of
+// those words - all 4 rows of the shape, the walls and the floor checked at
+// once, with no branches - and the padding is done once per board, not once
+// per candidate.
+//
+// Out of range candidates are clamped to a position that is just as illegal
+// (or, above the board, just as legal), so any x and y can be passed in.  The
+// same rules as Gameboard::canPlaceRows() apply: the walls and floor block,
+// the space above the board does not.
+
+#ifndef BATCHLEGALITY_H
+#define BATCHLEGALITY_H
+
+#include <cstdint>
+#include "Gameboard.h"
+#include "Tetromino.h"
+#include "TetrominoTables.h"
+
+namespace BatchLegality
+{
+	static const int MAX_CANDIDATES = 64;		// candidates per test() (one bit each in the result)
+	static const int WALL_BITS = 3;				// wall columns kept on each side of a padded row
+	static const int ABOVE_BOARD = TetrominoTables::BLOCK_COUNT;	// empty rows kept above the board
+	static const int PADDED_ROWS = ABOVE_BOARD + Gameboard::MAX_Y + TetrominoTables::BLOCK_COUNT;
+
+	static_assert(Gameboard::MAX_X + 2 * WALL_BITS <= 16, "a padded row must fit in 16 bits");
+
+	// a position to test: a gridLoc and rotation
+	struct Candidate
+	{
+		int8_t x;
+		int8_t y;
+		int8_t rotation;
+	};
+
+	// a board's rows ready for testing: bit (x + WALL_BITS) of rows[y + ABOVE_BOARD]
+	// is set for a filled cell, and the walls and the rows below the floor are full
+	struct PaddedBoard
+	{
+		uint16_t rows[PADDED_ROWS];
+	};
+
+	// copy a board into a PaddedBoard
+	//   (worth keeping when several batches are tested against the same board)
+	// - param 1: the Gameboard to copy
+	// - param 2: a PaddedBoard, filled in
+	// - return: nothing
+	void pad(const Gameboard &board, PaddedBoard &padded);
+
+	// Test which candidate positions of a shape fit on a board.
+	// assert count is not more than MAX_CANDIDATES
+	// - param 1: a PaddedBoard (see pad())
+	// - param 2: the TetShape to test
+	// - param 3: an array of Candidates
+	// - param 4: an int, the number of candidates
+	// - return: a uint64_t with bit i set when candidate i fits
+	uint64_t test(const PaddedBoard &padded, TetShape shape, const Candidate *candidates, int count);
+
+	// Test which candidate positions of a shape fit on a board.
+	//   (pads the board, then tests against that)
+	// assert count is not more than MAX_CANDIDATES
+	// - param 1: the Gameboard to test against
+	// - param 2: the TetShape to test
+	// - param 3: an array of Candidates
+	// - param 4: an int, the number of candidates
+	// - return: a uint64_t with bit i set when candidate i fits
+	uint64_t test(const Gameboard &board, TetShape shape, const Candidate *candidates, int count);
+
+	// Test whether a single candidate position of a shape fits (the same test as test())
+	// - param 1: a PaddedBoard (see pad())
+	// - param 2: the TetShape to test
+	// - param 3: a Candidate
+	// - return: true if the candidate fits
+	bool fits(const PaddedBoard &padded, TetShape shape, const Candidate &candidate);
+}
+
+#endif /* BATCHLEGALITY_H */
@@ -0,0 +1,282 @@
+#include <cassert>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include "BatchTetris.h"
+#include "WallKicks.h"
+
+using BatchLegality::Candidate;
+using BatchLegality::ABOVE_BOARD;
+using BatchLegality::WALL_BITS;
+
+static const uint16_t FULL_PADDED_ROW = 0xFFFF;			// a padded row with every column (and the walls) filled
+static const int LINE_SCORES[] = { 0, 40, 100, 300, 1200 };	// score for clearing 0-4 rows at once (times level + 1)
+
+static_assert(sizeof(BatchTetris::Board) == BatchTetris::CACHE_LINE, "a board should fill exactly one cache line");
+static_assert(BatchLegality::PADDED_ROWS <= 32, "completed rows are reported in a 32-bit mask");
+static_assert(std::is_trivially_destructible<Randomizer>::value, "randomizers are never destroyed");
+
+// round a number of bytes up to a whole number of cache lines
+static size_t roundUp(size_t bytes)
+{
+	return (bytes + BatchTetris::CACHE_LINE - 1) & ~static_cast<size_t>(BatchTetris::CACHE_LINE - 1);
+}
+
+// take an array of count Ts from the front of some cache line aligned memory
+//   (next is moved on to the cache line after the array)
+template <typename T>
+static T *carve(unsigned char *&next, int count)
+{
+	T *array = reinterpret_cast<T *>(next);
+	next += roundUp(count * sizeof(T));
+	return array;
+}
+
+// constructor - set up count games and start each one
+//   the games' seeds are dealt from a Randomizer seeded with the seed given
+// assert count is positive
+// - param 1: an int, the number of games
+// - param 2: a uint64_t, the seed all the games' seeds come from
+BatchTetris::BatchTetris(int count, uint64_t seed)
+	:count(count)
+{
+	assert(count > 0 && "BatchTetris needs at least one game");
+
+	// one allocation holds every array, each starting on its own cache line
+	storage.resize(CACHE_LINE + roundUp(count * sizeof(Board)) + roundUp(count * sizeof(Randomizer)) +
+		2 * roundUp(count * sizeof(uint64_t)) + 2 * roundUp(count * sizeof(TetShape)) + 2 * roundUp(count * sizeof(int32_t)));
+	uintptr_t address = reinterpret_cast<uintptr_t>(storage.data());
+	unsigned char *next = storage.data() + (roundUp(address) - address);
+	boards = carve<Board>(next, count);
+	randomizers = carve<Randomizer>(next, count);
+	seeds = carve<uint64_t>(next, count);
+	shapes = carve<TetShape>(next, count);
+	nextShapes = carve<TetShape>(next, count);
+	scores = carve<int64_t>(next, count);
+	levels = carve<int32_t>(next, count);
+	cleared = carve<int32_t>(next, count);
+
+	BatchLegality::pad(Gameboard(), emptyBoard);
+	Randomizer seeder(seed, Randomizer::UNIFORM);
+	for (int game = 0; game < count; game++)
+	{
+		new (&randomizers[game]) Randomizer(0, Randomizer::SEVEN_BAG);
+		startGame(game, seeder.nextRandom());
+	}
+}
+
+// play one shape in every game
+//   see the top of BatchTetris.h for how an action is played.
+//   A game that tops out is restarted before step() returns.
+// assert each action is between 0 and ACTION_COUNT-1
+// - param 1: an array of count actions
+// - param 2: an array of count int32_t, set to the score each game gained
+// - param 3: an array of count uint8_t, set to 1 for each game that ended (and restarted), else 0
+// - return: nothing
+void BatchTetris::step(const int32_t *actions, int32_t *rewards, uint8_t *dones)
+{
+	const Candidate spawn{ Gameboard::SPAWN_X, Gameboard::SPAWN_Y, 0 };
+	for (int game = 0; game < count; game++)
+	{
+		assert(actions[game] >= 0 && actions[game] < ACTION_COUNT && "BatchTetris - action out of range");
+		uint32_t completed = playShape(game, actions[game]);
+
+		// the next shape spawns before the completed rows are removed (as in TetrisEngine)
+		if (!BatchLegality::fits(boards[game].padded, nextShapes[game], spawn))
+		{
+			newGame(game);
+			rewards[game] = 0;
+			dones[game] = 1;
+			continue;
+		}
+		shapes[game] = nextShapes[game];
+		nextShapes[game] = randomizers[game].next();
+
+		int rowsRemoved = 0;
+		if (completed != 0)
+		{
+			removeRows(game, completed);
+			for (uint32_t rows = completed; rows != 0; rows &= rows - 1)
+			{
+				rowsRemoved++;
+			}
+		}
+		int gained = LINE_SCORES[rowsRemoved] * (levels[game] + 1);
+		scores[game] += gained;
+		cleared[game] += rowsRemoved;
+		if (cleared[game] >= 10)
+		{
+			levels[game]++;
+			cleared[game] %= 10;
+		}
+		rewards[game] = gained;
+		dones[game] = 0;
+	}
+}
+
+// start a new game in one environment (seeded from its randomizer)
+// - param 1: an int, the game
+// - return: nothing
+void BatchTetris::newGame(int game)
+{
+	startGame(game, randomizers[game].nextRandom());
+}
+
+int BatchTetris::getCount() const
+{
+	return count;
+}
+
+TetShape BatchTetris::getShape(int game) const
+{
+	return shapes[game];
+}
+
+TetShape BatchTetris::getNextShape(int game) const
+{
+	return nextShapes[game];
+}
+
+int64_t BatchTetris::getScore(int game) const
+{
+	return scores[game];
+}
+
+int BatchTetris::getLevel(int game) const
+{
+	return levels[game];
+}
+
+uint64_t BatchTetris::getSeed(int game) const
+{
+	return seeds[game];
+}
+
+// get the occupancy mask of a row of a game's board (the same as Gameboard::getRowMask())
+// - param 1: an int, the game
+// - param 2: an int, the row (0 to MAX_Y-1)
+// - return: a uint16_t with bit x set when column x holds a block
+uint16_t BatchTetris::getRowMask(int game, int y) const
+{
+	assert(0 <= y && y < Gameboard::MAX_Y && "BatchTetris - row not on the board");
+	return (boards[game].padded.rows[y + ABOVE_BOARD] >> WALL_BITS) & Gameboard::FULL_ROW_MASK;
+}
+
+// start a game from a seed
+// - param 1: an int, the game
+// - param 2: a uint64_t, the seed for its piece sequence
+// - return: nothing
+void BatchTetris::startGame(int game, uint64_t seed)
+{
+	seeds[game] = seed;
+	randomizers[game].reset(seed);
+	boards[game].padded = emptyBoard;
+	shapes[game] = randomizers[game].next();
+	nextShapes[game] = randomizers[game].next();
+	scores[game] = 0;
+	levels[game] = 0;
+	cleared[game] = 0;
+}
+
+// play a game's shape where an action puts it (rotate, move, hard drop) and lock it
+// - param 1: an int, the game
+// - param 2: an int, the action
+// - return: a uint32_t with bit r set for each padded row index r the lock completed
+uint32_t BatchTetris::playShape(int game, int action)
+{
+	BatchLegality::PaddedBoard &padded = boards[game].padded;
+	TetShape shape = shapes[game];
+	int rotations = action / Gameboard::MAX_X;
+	int targetX = action % Gameboard::MAX_X;
+	Candidate at{ Gameboard::SPAWN_X, Gameboard::SPAWN_Y, 0 };
+
+	// rotate, each turn taking the first kick that fits (O never kicks, I has its own table)
+	int kickCount = (shape == TetShape::O) ? 1 : WallKicks::KICK_COUNT;
+	for (int turn = 0; turn < rotations; turn++)
+	{
+		const WallKicks::Kick *kicks = WallKicks::getKicks(shape, at.rotation);
+		int k = 0;
+		Candidate turned;
+		do
+		{
+			turned.x = static_cast<int8_t>(at.x + kicks[k].x);
+			turned.y = static_cast<int8_t>(at.y + kicks[k].y);
+			turned.rotation = static_cast<int8_t>((at.rotation + 1) % TetrominoTables::ROTATION_COUNT);
+		} while (!BatchLegality::fits(padded, shape, turned) && ++k < kickCount);
+		if (k == kickCount)
+		{
+			break;	// blocked: later turns would be blocked too
+		}
+		at = turned;
+	}
+
+	// slide towards the column until it is reached or blocked
+	int direction = (targetX > at.x) ? 1 : -1;
+	while (at.x != targetX)
+	{
+		Candidate moved = at;
+		moved.x = static_cast<int8_t>(at.x + direction);
+		if (!BatchLegality::fits(padded, shape, moved))
+		{
+			break;
+		}
+		at = moved;
+	}
+
+	// hard drop
+	Candidate below = at;
+	below.y++;
+	while (BatchLegality::fits(padded, shape, below))
+	{
+		at = below;
+		below.y++;
+	}
+
+	// lock (blocks above the board are dropped, as Gameboard::lockBlocks() does),
+	// noting the rows that are now full
+	const TetrominoTables::Orientation &o = TetrominoTables::SHAPES.orientations[shape][at.rotation];
+	int left = at.x + o.minX;
+	int top = at.y + o.minY;
+	uint32_t completed = 0;
+	for (int row = 0; row <= o.maxY - o.minY; row++)
+	{
+		if (top + row < 0)
+		{
+			continue;
+		}
+		int index = top + row + ABOVE_BOARD;
+		padded.rows[index] |= static_cast<uint16_t>(o.rowMasks[row] << (left + WALL_BITS));
+		if (padded.rows[index] == FULL_PADDED_ROW)
+		{
+			completed |= 1u << index;
+		}
+	}
+	return completed;
+}
+
+// remove completed rows from a game's board, moving the rows above them down
+// - param 1: an int, the game
+// - param 2: a uint32_t with bit r set for each padded row index r to remove
+// - return: nothing
+void BatchTetris::removeRows(int game, uint32_t completed)
+{
+	uint16_t *rows = boards[game].padded.rows;
+
+	// start at the lowest completed row: nothing below it moves
+	int write = ABOVE_BOARD + Gameboard::MAX_Y - 1;
+	while (((completed >> write) & 1) == 0)
+	{
+		write--;
+	}
+	for (int read = write - 1; read >= ABOVE_BOARD; read--)
+	{
+		if (((completed >> read) & 1) == 0)
+		{
+			rows[write--] = rows[read];
+		}
+	}
+	for (; write >= ABOVE_BOARD; write--)
+	{
+		rows[write] = emptyBoard.rows[write];
+	}
+}
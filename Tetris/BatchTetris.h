@@ -0,0 +1,130 @@
+// BatchTetris runs many tetris games ("environments") in lock-step, for training
+// bots with reinforcement learning.
+//
+// One step() call plays one shape in every game.  An action picks where the shape
+// goes: a rotation (0-3) and a column (the x of its gridLoc), as
+//   action = rotation * Gameboard::MAX_X + x
+// The shape is played the way a player would play it from the spawn location:
+// rotated clockwise that many times (with SRS wall kicks, see WallKicks.h), moved
+// one column at a time towards x until it reaches it or is blocked, then hard
+// dropped.  After that the game carries on exactly like TetrisEngine: the shape
+// locks, the next shape spawns (on the board before rows are cleared), completed
+// rows are removed and scored, and the level goes up every 10 rows.  So each game
+// plays the same as a TetrisEngine with the same seed given ROTATE, MOVE_LEFT/RIGHT
+// and HARD_DROP inputs.  A game that tops out starts a new game straight away,
+// seeded from its own randomizer (like TetrisEngine::newGame()), and reports done.
+//
+// The state is kept as a structure of arrays: one array each for the boards,
+// randomizers, shapes, scores, levels and rows cleared, all carved out of a
+// single allocation and aligned to cache lines.  A board is only its occupancy -
+// the padded row masks of BatchLegality.h (walls and floor filled in) - which is
+// 54 bytes, so each board sits alone in one 64 byte cache line.  Every legality
+// test on it (kicks, moves, each row of the drop) is one 64-bit shift and AND,
+// and locking and row completion touch only the 4 rows under the shape.
+
+#ifndef BATCHTETRIS_H
+#define BATCHTETRIS_H
+
+#include <cstdint>
+#include <vector>
+#include "BatchLegality.h"
+#include "Gameboard.h"
+#include "Randomizer.h"
+#include "Tetromino.h"
+#include "TetrominoTables.h"
+
+class BatchTetris
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+public:
+	// CONSTANTS
+	static const int ACTION_COUNT = TetrominoTables::ROTATION_COUNT * Gameboard::MAX_X;	// actions per step
+	static const int CACHE_LINE = 64;		// the alignment of every array (and the size of a board)
+
+	// a board, alone in its cache line
+	struct alignas(CACHE_LINE) Board
+	{
+		BatchLegality::PaddedBoard padded;
+	};
+
+private:
+	// MEMBER VARIABLES
+	int count;								// the number of games
+	std::vector<unsigned char> storage;		// the memory every array below is carved from
+
+	// State members (one entry per game) ---------------------------
+	Board *boards;				// the blocks on each board
+	Randomizer *randomizers;	// each game's piece sequence
+	uint64_t *seeds;			// the seed each current game's piece sequence started from
+	TetShape *shapes;			// the shape to play next step
+	TetShape *nextShapes;		// the "on deck" shape
+	int64_t *scores;
+	int32_t *levels;
+	int32_t *cleared;			// rows cleared on the current level
+
+	BatchLegality::PaddedBoard emptyBoard;	// a board with nothing on it, copied in by startGame()
+
+public:
+	// constructor - set up count games and start each one
+	//   the games' seeds are dealt from a Randomizer seeded with the seed given
+	// assert count is positive
+	// - param 1: an int, the number of games
+	// - param 2: a uint64_t, the seed all the games' seeds come from
+	BatchTetris(int count, uint64_t seed);
+
+	// (the arrays point into storage, so a BatchTetris can't be copied)
+	BatchTetris(const BatchTetris &) = delete;
+	BatchTetris &operator=(const BatchTetris &) = delete;
+
+	// play one shape in every game
+	//   see the top of this file for how an action is played.
+	//   A game that tops out is restarted before step() returns.
+	// assert each action is between 0 and ACTION_COUNT-1
+	// - param 1: an array of count actions
+	// - param 2: an array of count int32_t, set to the score each game gained
+	// - param 3: an array of count uint8_t, set to 1 for each game that ended (and restarted), else 0
+	// - return: nothing
+	void step(const int32_t *actions, int32_t *rewards, uint8_t *dones);
+
+	// start a new game in one environment (seeded from its randomizer)
+	// - param 1: an int, the game
+	// - return: nothing
+	void newGame(int game);
+
+	// getters for the number of games, and a game's state
+	// - param 1: an int, the game
+	// - return: the matching member (see above)
+	int getCount() const;
+	TetShape getShape(int game) const;
+	TetShape getNextShape(int game) const;
+	int64_t getScore(int game) const;
+	int getLevel(int game) const;
+	uint64_t getSeed(int game) const;
+
+	// get the occupancy mask of a row of a game's board (the same as Gameboard::getRowMask())
+	// - param 1: an int, the game
+	// - param 2: an int, the row (0 to MAX_Y-1)
+	// - return: a uint16_t with bit x set when column x holds a block
+	uint16_t getRowMask(int game, int y) const;
+
+private:
+	// start a game from a seed
+	// - param 1: an int, the game
+	// - param 2: a uint64_t, the seed for its piece sequence
+	// - return: nothing
+	void startGame(int game, uint64_t seed);
+
+	// play a game's shape where an action puts it (rotate, move, hard drop) and lock it
+	// - param 1: an int, the game
+	// - param 2: an int, the action
+	// - return: a uint32_t with bit r set for each padded row index r the lock completed
+	uint32_t playShape(int game, int action);
+
+	// remove completed rows from a game's board, moving the rows above them down
+	// - param 1: an int, the game
+	// - param 2: a uint32_t with bit r set for each padded row index r to remove
+	// - return: nothing
+	void removeRows(int game, uint32_t completed);
+};
+
+#endif /* BATCHTETRIS_H */
@@ -0,0 +1,229 @@
+#include <algorithm>
+#include <cassert>
+#include "BeamSearch.h"
+
+static const int RESERVED_PLACEMENTS = 64;	// candidates reserved per beam board (most shapes have under 40 placements)
+
+// constructor - allocate the beam, the arenas and the evaluation table, and start the workers
+// assert beamWidth is positive
+// - param 1: the Weights to score boards with
+// - param 2: an int, the boards kept at each ply
+// - param 3: an int, the worker threads (0 for one per hardware thread)
+BeamSearch::BeamSearch(const BotPolicy::Weights &weights, int beamWidth, int threads)
+	:weights(weights), beamWidth(beamWidth), pool(threads)
+{
+	assert(beamWidth > 0 && "BeamSearch - the beam needs room for a board");
+	arenas.resize(pool.getWorkers());
+	for (auto &arena : arenas)
+	{
+		arena.candidates.reserve(beamWidth * RESERVED_PLACEMENTS);
+	}
+	beam.resize(beamWidth);
+	nextBeam.resize(beamWidth);
+	ranked.reserve(beamWidth * RESERVED_PLACEMENTS);
+	keptKeys.reserve(beamWidth);
+	roots.resize(MoveGenerator::MAX_PLACEMENTS);
+}
+
+// choose where a shape should lock
+// assert previewCount is between 0 and MAX_PLIES - 1
+// - param 1: the Gameboard
+// - param 2: a GridTetromino, the falling shape where it is now
+// - param 3: a pointer to the shapes after it, in order (the preview)
+// - param 4: an int, the number of shapes in the preview
+// - return: a Result
+BeamSearch::Result BeamSearch::search(const Gameboard &board, const GridTetromino &current, const TetShape *preview, int previewCount)
+{
+	assert(previewCount >= 0 && previewCount < MAX_PLIES && "BeamSearch - preview too long");
+	Result result;
+	evaluations.newSearch();
+	beam[0].board = board;
+	beam[0].reward = 0.0f;
+	beam[0].root = -1;
+	beamSize = 1;
+
+	for (int ply = 0; ply <= previewCount; ply++)
+	{
+		// the falling shape starts where it is; the ones after it where they will spawn
+		GridTetromino shape = current;
+		if (ply > 0)
+		{
+			shape.setShape(preview[ply - 1]);
+			shape.setGridLoc(board.getSpawnLoc());
+		}
+
+		for (auto &arena : arenas)
+		{
+			arena.candidates.clear();
+		}
+		pool.run(beamSize, [this, &shape](int task, int worker) { expand(task, shape, worker); });
+		rankCandidates();
+		if (ranked.empty())
+		{
+			break;		// every board in the beam has topped out: go with the deepest ply that didn't
+		}
+
+		if (ply == 0)
+		{
+			for (const Candidate &candidate : ranked)
+			{
+				roots[candidate.root] = candidate.placement;
+			}
+		}
+		result.found = true;
+		result.placement = roots[ranked[0].root];
+		result.score = ranked[0].score;
+		result.plies = ply + 1;
+		result.nodes += static_cast<int>(ranked.size());
+
+		if (ply < previewCount)
+		{
+			keepBest(shape);
+		}
+	}
+	return result;
+}
+
+// get the number of workers the search runs on
+// - params: none
+// - return: an int
+int BeamSearch::getWorkers() const
+{
+	return pool.getWorkers();
+}
+
+// score every placement of a shape on one board of the beam, into a worker's arena
+//   The board's feature score comes from the evaluation table when it is there.
+//   A placement that completes no rows is looked up by the key it would leave
+//   (Gameboard::getZobristKeyAfterLock()), so a hit costs no copy of the board.
+// - param 1: an int, the index of the board in the beam
+// - param 2: a GridTetromino, the shape where it starts
+// - param 3: an int, the worker
+// - return: nothing
+void BeamSearch::expand(int parent, const GridTetromino &shape, int worker)
+{
+	Arena &arena = arenas[worker];
+	const Node &node = beam[parent];
+	int count = MoveGenerator::generatePlacements(node.board, shape, arena.placements);
+
+	GridTetromino placed = shape;
+	for (int i = 0; i < count; i++)
+	{
+		const MoveGenerator::Placement &placement = arena.placements.placements[i];
+		placed.setRotation(placement.rotation);
+		placed.setGridLoc(placement.x, placement.y);
+		BlockList blocks = placed.getBlockLocsMappedToGrid();
+
+		int rowsCompleted;
+		uint64_t key = node.board.getZobristKeyAfterLock(blocks, rowsCompleted);
+		TranspositionTable::Entry entry;
+		if (rowsCompleted > 0 || !evaluations.probe(key, entry))
+		{
+			arena.scratch = node.board;
+			arena.scratch.removeRows(arena.scratch.lockBlocks(blocks, placed.getColor()));
+			key = arena.scratch.getZobristKey();
+			if (rowsCompleted == 0 || !evaluations.probe(key, entry))
+			{
+				entry.value = static_cast<float>(weights.evaluate(arena.scratch, 0));
+				evaluations.store(key, entry.value);
+			}
+		}
+
+		Candidate candidate;
+		candidate.reward = node.reward + static_cast<float>(weights.rowsCleared * rowsCompleted);
+		candidate.score = candidate.reward + entry.value;
+		candidate.key = key;
+		candidate.parent = parent;
+		candidate.order = i;
+		candidate.root = (node.root < 0) ? i : node.root;
+		candidate.placement = placement;
+		arena.candidates.push_back(candidate);
+	}
+}
+
+// gather the workers' candidates and rank them, best first
+//   (ties go to the earlier board in the beam, then the earlier placement, so the
+//   ranking is the same however the boards were shared between the workers)
+// - params: none
+// - return: nothing
+void BeamSearch::rankCandidates()
+{
+	ranked.clear();
+	for (const auto &arena : arenas)
+	{
+		ranked.insert(ranked.end(), arena.candidates.begin(), arena.candidates.end());
+	}
+	std::sort(ranked.begin(), ranked.end(), [](const Candidate &a, const Candidate &b)
+	{
+		if (a.score != b.score) { return a.score > b.score; }
+		if (a.parent != b.parent) { return a.parent < b.parent; }
+		return a.order < b.order;
+	});
+}
+
+// fill nextBeam with the best beamWidth distinct boards in ranked, then swap it into beam
+//   (a board reached by two routes is kept once, by its better route - the beam is
+//   small, so the keys kept are searched in a line)
+// - param 1: a GridTetromino, the shape the ply placed
+// - return: nothing
+void BeamSearch::keepBest(const GridTetromino &shape)
+{
+	keptKeys.clear();
+	int kept = 0;
+	for (size_t i = 0; i < ranked.size() && kept < beamWidth; i++)
+	{
+		if (std::find(keptKeys.begin(), keptKeys.end(), ranked[i].key) == keptKeys.end())
+		{
+			keptKeys.push_back(ranked[i].key);
+			ranked[kept++] = ranked[i];
+		}
+	}
+
+	pool.run(kept, [this, &shape](int task, int worker)
+	{
+		const Candidate &candidate = ranked[task];
+		GridTetromino placed = shape;
+		placed.setRotation(candidate.placement.rotation);
+		placed.setGridLoc(candidate.placement.x, candidate.placement.y);
+		Node &child = nextBeam[task];
+		child.board = beam[candidate.parent].board;
+		child.board.removeRows(child.board.lockBlocks(placed.getBlockLocsMappedToGrid(), placed.getColor()));
+		child.reward = candidate.reward;
+		child.root = candidate.root;
+	});
+	std::swap(beam, nextBeam);
+	beamSize = kept;
+}
+
+// constructor
+// - param 1: the Weights to score boards with
+// - param 2: an int, the boards kept at each ply
+// - param 3: an int, the worker threads (0 for one per hardware thread)
+BeamPolicy::BeamPolicy(const BotPolicy::Weights &weights, int beamWidth, int threads)
+	:search(weights, beamWidth, threads)
+{
+}
+
+// search from the falling shape and the one on deck, and give every input to
+// lock the shape where the search chose at once (ending with a hard drop)
+//   (if the shape has nowhere to lock, or the path is too long, it is just hard dropped)
+int BeamPolicy::chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs)
+{
+	if (engine.getGameOver())
+	{
+		return 0;
+	}
+	TetShape preview[1] = { engine.getNextShape().getShape() };
+	BeamSearch::Result result = search.search(engine.getBoard(), engine.getCurrentShape(), preview, 1);
+
+	int count = 0;
+	if (result.found)
+	{
+		count = MoveGenerator::findInputs(engine.getBoard(), engine.getCurrentShape(), result.placement, inputs, MAX_INPUTS);
+	}
+	if (count == 0)
+	{
+		inputs[count++] = TetrisEngine::HARD_DROP;
+	}
+	return count;
+}
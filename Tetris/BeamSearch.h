@@ -0,0 +1,163 @@
+// BeamSearch looks ahead over the shapes a player can see - the falling shape
+// and the preview - to choose where the falling shape should lock.
+//
+// It is a beam search, one ply per shape.  The first ply is every placement of
+// the falling shape (see MoveGenerator), each scored by locking it on a copy of
+// the board and weighing the board's features (BotPolicy::Weights).  Only the
+// best beamWidth of them are kept, and each of those is expanded by every
+// placement of the next shape in the preview, and so on to the end of the queue.
+// A board's score is its features' weight plus the rows cleared on the way to it,
+// and the falling shape goes where the best board at the deepest ply started.
+// The engine shows one shape on deck, so a game search is two plies deep; the
+// search itself takes a preview of up to Randomizer::MAX_PREVIEW shapes.
+//
+// Boards reached by two routes (two shapes placed in either order, say) are kept
+// in the beam once, and their feature score is worked out once: the search keeps
+// the boards it scores in a TranspositionTable, by Zobrist key, and a placement
+// that clears no rows is looked up before the board is even copied.
+//
+// Each ply is spread over a WorkerPool, one task per board in the beam.  The
+// placements a worker scores (the search nodes) go into that worker's own arena:
+// buffers allocated when the search is made, and reused by every ply and every
+// move after that (they only grow, rarely, if a ply finds more than they hold),
+// so nothing is allocated in the inner loop.  The nodes are ranked with
+// tie-breaks that don't depend on which worker made them, so a search chooses
+// the same placement on any number of threads.
+//
+// BeamPolicy plays a game with a BeamSearch: once per shape it searches, then
+// gives all the inputs that take the shape to the chosen placement (see
+// MoveGenerator::findInputs()), tucks and spins included, on one frame.
+
+#ifndef BEAMSEARCH_H
+#define BEAMSEARCH_H
+
+#include <cstdint>
+#include <vector>
+#include "Gameboard.h"
+#include "GridTetromino.h"
+#include "InputPolicy.h"
+#include "MoveGenerator.h"
+#include "Randomizer.h"
+#include "TranspositionTable.h"
+#include "WorkerPool.h"
+
+class BeamSearch
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+public:
+	// CONSTANTS
+	static const int DEFAULT_BEAM_WIDTH = 64;				// boards kept at each ply, by default
+	static const int MAX_PLIES = 1 + Randomizer::MAX_PREVIEW;	// the falling shape and a full preview
+	static const int TABLE_BUCKET_BITS = 14;				// log2 of the evaluation table's buckets (1MB)
+
+	// what a search found
+	struct Result
+	{
+		bool found{ false };					// false if the falling shape has nowhere to lock
+		MoveGenerator::Placement placement{};	// where the falling shape should lock
+		float score{ 0.0f };					// the score of the best board at the deepest ply
+		int plies{ 0 };							// the plies searched (fewer than asked if every line tops out)
+		int nodes{ 0 };							// the placements scored
+	};
+
+private:
+	// a board in the beam
+	struct Node
+	{
+		Gameboard board;
+		float reward;		// the score of the rows cleared on the way to the board
+		int root;			// the first ply placement it came from
+	};
+
+	// a placement scored by a worker (a search node), waiting to be ranked
+	struct Candidate
+	{
+		float score;		// reward + the board's feature score
+		float reward;		// the parent's reward + the rows this placement clears
+		uint64_t key;		// the Zobrist key of the board it leaves
+		int parent;			// the index of the board it was placed on, in the beam
+		int order;			// its index in the parent's PlacementList
+		int root;			// the first ply placement it came from
+		MoveGenerator::Placement placement;
+	};
+
+	// one worker's scratch memory
+	struct Arena
+	{
+		std::vector<Candidate> candidates;			// the nodes scored this ply
+		MoveGenerator::PlacementList placements;	// the placements of the board being expanded
+		Gameboard scratch;							// a board to lock placements on
+	};
+
+	BotPolicy::Weights weights;
+	int beamWidth;
+	WorkerPool pool;
+	std::vector<Arena> arenas;			// one per worker
+	std::vector<Node> beam;				// the boards kept at the last ply
+	std::vector<Node> nextBeam;			// the boards being kept at this ply
+	int beamSize{ 0 };					// the boards in beam
+	std::vector<Candidate> ranked;		// every worker's candidates, best first
+	std::vector<uint64_t> keptKeys;		// the keys of the boards in nextBeam (to keep each board once)
+	std::vector<MoveGenerator::Placement> roots;	// the first ply placements
+	TranspositionTable evaluations{ TABLE_BUCKET_BITS };	// board feature scores, by Zobrist key
+
+public:
+	// constructor - allocate the beam, the arenas and the evaluation table, and start the workers
+	// assert beamWidth is positive
+	// - param 1: the Weights to score boards with
+	// - param 2: an int, the boards kept at each ply
+	// - param 3: an int, the worker threads (0 for one per hardware thread)
+	BeamSearch(const BotPolicy::Weights &weights = BotPolicy::Weights(), int beamWidth = DEFAULT_BEAM_WIDTH, int threads = 0);
+
+	// choose where a shape should lock
+	// assert previewCount is between 0 and MAX_PLIES - 1
+	// - param 1: the Gameboard
+	// - param 2: a GridTetromino, the falling shape where it is now
+	// - param 3: a pointer to the shapes after it, in order (the preview)
+	// - param 4: an int, the number of shapes in the preview
+	// - return: a Result
+	Result search(const Gameboard &board, const GridTetromino &current, const TetShape *preview, int previewCount);
+
+	// get the number of workers the search runs on
+	// - params: none
+	// - return: an int
+	int getWorkers() const;
+
+private:
+	// score every placement of a shape on one board of the beam, into a worker's arena
+	// - param 1: an int, the index of the board in the beam
+	// - param 2: a GridTetromino, the shape where it starts
+	// - param 3: an int, the worker
+	// - return: nothing
+	void expand(int parent, const GridTetromino &shape, int worker);
+
+	// gather the workers' candidates and rank them, best first
+	// - params: none
+	// - return: nothing
+	void rankCandidates();
+
+	// fill nextBeam with the best beamWidth distinct boards in ranked, then swap it into beam
+	// - param 1: a GridTetromino, the shape the ply placed
+	// - return: nothing
+	void keepBest(const GridTetromino &shape);
+};
+
+class BeamPolicy : public InputPolicy
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+private:
+	BeamSearch search;
+
+public:
+	// constructor
+	// - param 1: the Weights to score boards with
+	// - param 2: an int, the boards kept at each ply
+	// - param 3: an int, the worker threads (0 for one per hardware thread)
+	BeamPolicy(const BotPolicy::Weights &weights = BotPolicy::Weights(), int beamWidth = BeamSearch::DEFAULT_BEAM_WIDTH, int threads = 0);
+
+	// search from the falling shape and the one on deck, and give every input to
+	// lock the shape where the search chose at once (ending with a hard drop)
+	int chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs) override;
+};
+
+#endif /* BEAMSEARCH_H */
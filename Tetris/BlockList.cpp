@@ -0,0 +1,65 @@
+#include <cassert>
+#include "BlockList.h"
+
+// get the number of blocks in the list
+// - params: none
+// - return: an int, the block count
+int BlockList::size() const
+{
+	return count;
+}
+
+// remove all blocks from the list
+// - params: none
+// - return: nothing
+void BlockList::clear()
+{
+	count = 0;
+}
+
+// add a block to the end of the list
+// assert the list is not already full
+// - param 1: a Point, the block location to add
+// - return: nothing
+void BlockList::push_back(const Point &point)
+{
+	assert(count < MAX_BLOCKS && "BlockList is full");
+	blocks[count++] = point;
+}
+
+// access a block by index
+// assert the index is in use
+// - param 1: an int, the block index
+// - return: a reference to the block location
+Point &BlockList::operator[](int index)
+{
+	assert((0 <= index && index < count) && "BlockList index out of range");
+	return blocks[index];
+}
+
+const Point &BlockList::operator[](int index) const
+{
+	assert((0 <= index && index < count) && "BlockList index out of range");
+	return blocks[index];
+}
+
+// iterators over the blocks in use (for range-based for loops)
+Point *BlockList::begin()
+{
+	return blocks;
+}
+
+Point *BlockList::end()
+{
+	return blocks + count;
+}
+
+const Point *BlockList::begin() const
+{
+	return blocks;
+}
+
+const Point *BlockList::end() const
+{
+	return blocks + count;
+}
@@ -0,0 +1,78 @@
+// The BlockList class holds the block locations of a tetromino.
+//
+// A tetromino never has more than 4 blocks, so instead of a std::vector (which
+// allocates on the heap every time it is built or copied) the points live in a
+// fixed array inside the object.  Copying a BlockList is a plain copy of a few
+// bytes, and the lists of every orientation can be built by the compiler (see
+// TetrominoTables.h).  This keeps moving, rotating and testing pieces free of
+// heap allocation.
+//
+// The interface mirrors the small part of std::vector the game uses
+// (size, clear, push_back, [], and range-based for loops).
+
+#ifndef BLOCKLIST_H
+#define BLOCKLIST_H
+
+#include <cassert>
+#include <initializer_list>
+#include "Point.h"
+
+class BlockList
+{
+public:
+	// CONSTANTS
+	static const int MAX_BLOCKS = 4;	// the most blocks a list can hold
+
+private:
+	// MEMBER VARIABLES
+	Point blocks[MAX_BLOCKS];	// the block locations (only the first count are in use)
+	int count{ 0 };				// the number of blocks in use
+
+public:
+	// constructor - an empty list
+	constexpr BlockList() {}
+
+	// constructor - a list holding the given points
+	// (constexpr, so the orientation tables can hold block lists)
+	// assert there are no more than MAX_BLOCKS points
+	// - param 1: the points to hold
+	constexpr BlockList(std::initializer_list<Point> points)
+	{
+		assert(points.size() <= MAX_BLOCKS && "Too many blocks for a BlockList");
+		for (const Point &point : points)
+		{
+			blocks[count++] = point;
+		}
+	}
+
+	// get the number of blocks in the list
+	// - params: none
+	// - return: an int, the block count
+	int size() const;
+
+	// remove all blocks from the list
+	// - params: none
+	// - return: nothing
+	void clear();
+
+	// add a block to the end of the list
+	// assert the list is not already full
+	// - param 1: a Point, the block location to add
+	// - return: nothing
+	void push_back(const Point &point);
+
+	// access a block by index
+	// assert the index is in use
+	// - param 1: an int, the block index
+	// - return: a reference to the block location
+	Point &operator[](int index);
+	const Point &operator[](int index) const;
+
+	// iterators over the blocks in use (for range-based for loops)
+	Point *begin();
+	Point *end();
+	const Point *begin() const;
+	const Point *end() const;
+};
+
+#endif /* BLOCKLIST_H */
@@ -0,0 +1,353 @@
+#include <cstring>
+#include "BoardFeatures.h"
+
+#if defined(__AVX2__)
+#define BOARDFEATURES_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BOARDFEATURES_SSE2
+#include <emmintrin.h>
+#endif
+
+using BoardFeatures::Features;
+
+static_assert(Gameboard::MAX_X <= 16 && Gameboard::MAX_Y < 32, "column masks need 16 columns by 32 rows at most");
+
+static const uint32_t FULL_COLUMN = (1u << Gameboard::MAX_Y) - 1;	// column mask with every row filled
+static const uint32_t FLOOR_BIT = 1u << Gameboard::MAX_Y;			// the row below the board
+static const int PADDED_COLUMNS = 16;	// columns worked on (the ones past MAX_X are full, like the walls)
+
+// count the set bits in a mask
+static int popcount(uint32_t mask)
+{
+	mask = mask - ((mask >> 1) & 0x55555555u);
+	mask = (mask & 0x33333333u) + ((mask >> 2) & 0x33333333u);
+	mask = (mask + (mask >> 4)) & 0x0F0F0F0Fu;
+	return static_cast<int>((mask * 0x01010101u) >> 24);
+}
+
+// fill in the features that come from the column heights alone
+//   (heights, aggregate and max height, bumpiness and wells)
+static void addHeightFeatures(const int32_t *heights, Features &features)
+{
+	features.aggregateHeight = 0;
+	features.maxHeight = 0;
+	features.bumpiness = 0;
+	features.wellSum = 0;
+	for (int x = 0; x < Gameboard::MAX_X; x++)
+	{
+		int height = heights[x];
+		features.columnHeights[x] = height;
+		features.aggregateHeight += height;
+		features.maxHeight = (height > features.maxHeight) ? height : features.maxHeight;
+		if (x > 0)
+		{
+			int step = height - heights[x - 1];
+			features.bumpiness += (step < 0) ? -step : step;
+		}
+
+		int left = (x > 0) ? heights[x - 1] : Gameboard::MAX_Y;
+		int right = (x < Gameboard::MAX_X - 1) ? heights[x + 1] : Gameboard::MAX_Y;
+		int depth = ((left < right) ? left : right) - height;
+		depth = (depth > 0) ? depth : 0;
+		features.wellDepths[x] = depth;
+		features.wellSum += depth * (depth + 1) / 2;
+	}
+}
+
+// Work out every feature of a board one column at a time (no SIMD).
+// - param 1: the Gameboard to measure
+// - param 2: a Features, filled in (the same values extract() gives)
+// - return: nothing
+void BoardFeatures::extractScalar(const Gameboard &board, Features &features)
+{
+	uint32_t columns[Gameboard::MAX_X]{};
+	const uint16_t *rows = board.getRowMasks();
+	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	{
+		for (int x = 0; x < Gameboard::MAX_X; x++)
+		{
+			columns[x] |= ((rows[y] >> x) & 1u) << y;
+		}
+	}
+
+	int32_t heights[Gameboard::MAX_X];
+	features.holes = 0;
+	features.coveredCells = 0;
+	features.rowTransitions = 0;
+	features.columnTransitions = 0;
+	uint32_t previous = FULL_COLUMN;	// the left wall
+	for (int x = 0; x < Gameboard::MAX_X; x++)
+	{
+		uint32_t column = columns[x];
+
+		// every cell from the top of the stack down
+		uint32_t stack = column;
+		stack |= stack << 1;
+		stack |= stack << 2;
+		stack |= stack << 4;
+		stack |= stack << 8;
+		stack |= stack << 16;
+		stack &= FULL_COLUMN;
+		heights[x] = popcount(stack);
+
+		// every cell from the lowest hole up
+		uint32_t holes = stack & ~column;
+		uint32_t aboveHoles = holes;
+		aboveHoles |= aboveHoles >> 1;
+		aboveHoles |= aboveHoles >> 2;
+		aboveHoles |= aboveHoles >> 4;
+		aboveHoles |= aboveHoles >> 8;
+		aboveHoles |= aboveHoles >> 16;
+		features.holes += popcount(holes);
+		features.coveredCells += popcount(aboveHoles & column);
+
+		uint32_t withFloor = column | FLOOR_BIT;
+		features.columnTransitions += popcount((withFloor ^ (withFloor >> 1)) & FULL_COLUMN);
+		features.rowTransitions += popcount(previous ^ column);
+		previous = column;
+	}
+	features.rowTransitions += popcount(previous ^ FULL_COLUMN);	// the right wall
+
+	addHeightFeatures(heights, features);
+}
+
+#if defined(BOARDFEATURES_AVX2)
+
+// count the set bits in each 32-bit lane
+static __m256i popcountLanes(__m256i v)
+{
+	const __m256i m1 = _mm256_set1_epi32(0x55555555);
+	const __m256i m2 = _mm256_set1_epi32(0x33333333);
+	const __m256i m4 = _mm256_set1_epi32(0x0F0F0F0F);
+	v = _mm256_sub_epi32(v, _mm256_and_si256(_mm256_srli_epi32(v, 1), m1));
+	v = _mm256_add_epi32(_mm256_and_si256(v, m2), _mm256_and_si256(_mm256_srli_epi32(v, 2), m2));
+	v = _mm256_and_si256(_mm256_add_epi32(v, _mm256_srli_epi32(v, 4)), m4);
+	v = _mm256_add_epi32(v, _mm256_srli_epi32(v, 8));
+	v = _mm256_add_epi32(v, _mm256_srli_epi32(v, 16));
+	return _mm256_and_si256(v, _mm256_set1_epi32(0x3F));
+}
+
+// add up the 32-bit lanes
+static int32_t sumLanes(__m256i v)
+{
+	alignas(32) int32_t lanes[8];
+	_mm256_store_si256(reinterpret_cast<__m256i *>(lanes), v);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3] + lanes[4] + lanes[5] + lanes[6] + lanes[7];
+}
+
+// Work out every feature of a board, using the widest SIMD the build allows.
+// - param 1: the Gameboard to measure
+// - param 2: a Features, filled in
+// - return: nothing
+void BoardFeatures::extract(const Gameboard &board, Features &features)
+{
+	// transpose the row masks into column masks: with the low (then high) byte of
+	// all 32 rows packed into one register, movemask reads bit 7 of every byte,
+	// which is one column; doubling the register moves the next column into bit 7.
+	alignas(32) uint16_t rows[32]{};
+	std::memcpy(rows, board.getRowMasks(), Gameboard::MAX_Y * sizeof(uint16_t));
+	__m256i top = _mm256_load_si256(reinterpret_cast<const __m256i *>(rows));
+	__m256i bottom = _mm256_load_si256(reinterpret_cast<const __m256i *>(rows + 16));
+	const __m256i lowByte = _mm256_set1_epi16(0x00FF);
+	__m256i low = _mm256_packus_epi16(_mm256_and_si256(top, lowByte), _mm256_and_si256(bottom, lowByte));
+	__m256i high = _mm256_packus_epi16(_mm256_srli_epi16(top, 8), _mm256_srli_epi16(bottom, 8));
+	low = _mm256_permute4x64_epi64(low, 0xD8);		// packus works per 128-bit half, put the rows back in order
+	high = _mm256_permute4x64_epi64(high, 0xD8);
+
+	// edges[0] is the left wall, edges[1 + x] is column x, and the padding is full like the right wall
+	alignas(32) uint32_t edges[PADDED_COLUMNS + 8];
+	for (int x = 7; x >= 0; x--)
+	{
+		edges[1 + x] = static_cast<uint32_t>(_mm256_movemask_epi8(low));
+		edges[9 + x] = static_cast<uint32_t>(_mm256_movemask_epi8(high));
+		low = _mm256_add_epi16(low, low);
+		high = _mm256_add_epi16(high, high);
+	}
+	edges[0] = FULL_COLUMN;
+	for (int x = Gameboard::MAX_X; x < PADDED_COLUMNS + 7; x++)
+	{
+		edges[1 + x] = FULL_COLUMN;
+	}
+
+	// 8 columns at a time (see extractScalar() for the same steps on one column)
+	alignas(32) int32_t heights[PADDED_COLUMNS];
+	const __m256i full = _mm256_set1_epi32(FULL_COLUMN);
+	const __m256i floorBit = _mm256_set1_epi32(FLOOR_BIT);
+	__m256i holeCount = _mm256_setzero_si256();
+	__m256i coveredCount = _mm256_setzero_si256();
+	__m256i rowTransitions = _mm256_setzero_si256();
+	__m256i columnTransitions = _mm256_setzero_si256();
+	for (int x = 0; x < Gameboard::MAX_X + 1; x += 8)
+	{
+		__m256i column = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(edges + 1 + x));
+		__m256i previous = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(edges + x));
+
+		__m256i stack = column;
+		stack = _mm256_or_si256(stack, _mm256_slli_epi32(stack, 1));
+		stack = _mm256_or_si256(stack, _mm256_slli_epi32(stack, 2));
+		stack = _mm256_or_si256(stack, _mm256_slli_epi32(stack, 4));
+		stack = _mm256_or_si256(stack, _mm256_slli_epi32(stack, 8));
+		stack = _mm256_or_si256(stack, _mm256_slli_epi32(stack, 16));
+		stack = _mm256_and_si256(stack, full);
+		_mm256_store_si256(reinterpret_cast<__m256i *>(heights + x), popcountLanes(stack));
+
+		__m256i holes = _mm256_andnot_si256(column, stack);
+		__m256i aboveHoles = holes;
+		aboveHoles = _mm256_or_si256(aboveHoles, _mm256_srli_epi32(aboveHoles, 1));
+		aboveHoles = _mm256_or_si256(aboveHoles, _mm256_srli_epi32(aboveHoles, 2));
+		aboveHoles = _mm256_or_si256(aboveHoles, _mm256_srli_epi32(aboveHoles, 4));
+		aboveHoles = _mm256_or_si256(aboveHoles, _mm256_srli_epi32(aboveHoles, 8));
+		aboveHoles = _mm256_or_si256(aboveHoles, _mm256_srli_epi32(aboveHoles, 16));
+		holeCount = _mm256_add_epi32(holeCount, popcountLanes(holes));
+		coveredCount = _mm256_add_epi32(coveredCount, popcountLanes(_mm256_and_si256(aboveHoles, column)));
+
+		__m256i withFloor = _mm256_or_si256(column, floorBit);
+		__m256i changes = _mm256_and_si256(_mm256_xor_si256(withFloor, _mm256_srli_epi32(withFloor, 1)), full);
+		columnTransitions = _mm256_add_epi32(columnTransitions, popcountLanes(changes));
+		rowTransitions = _mm256_add_epi32(rowTransitions, popcountLanes(_mm256_xor_si256(previous, column)));
+	}
+
+	features.holes = sumLanes(holeCount);
+	features.coveredCells = sumLanes(coveredCount);
+	features.rowTransitions = sumLanes(rowTransitions);
+	features.columnTransitions = sumLanes(columnTransitions);
+	addHeightFeatures(heights, features);
+}
+
+#elif defined(BOARDFEATURES_SSE2)
+
+// count the set bits in each 32-bit lane
+static __m128i popcountLanes(__m128i v)
+{
+	const __m128i m1 = _mm_set1_epi32(0x55555555);
+	const __m128i m2 = _mm_set1_epi32(0x33333333);
+	const __m128i m4 = _mm_set1_epi32(0x0F0F0F0F);
+	v = _mm_sub_epi32(v, _mm_and_si128(_mm_srli_epi32(v, 1), m1));
+	v = _mm_add_epi32(_mm_and_si128(v, m2), _mm_and_si128(_mm_srli_epi32(v, 2), m2));
+	v = _mm_and_si128(_mm_add_epi32(v, _mm_srli_epi32(v, 4)), m4);
+	v = _mm_add_epi32(v, _mm_srli_epi32(v, 8));
+	v = _mm_add_epi32(v, _mm_srli_epi32(v, 16));
+	return _mm_and_si128(v, _mm_set1_epi32(0x3F));
+}
+
+// add up the 32-bit lanes
+static int32_t sumLanes(__m128i v)
+{
+	alignas(16) int32_t lanes[4];
+	_mm_store_si128(reinterpret_cast<__m128i *>(lanes), v);
+	return lanes[0] + lanes[1] + lanes[2] + lanes[3];
+}
+
+// Work out every feature of a board, using the widest SIMD the build allows.
+// - param 1: the Gameboard to measure
+// - param 2: a Features, filled in
+// - return: nothing
+void BoardFeatures::extract(const Gameboard &board, Features &features)
+{
+	// transpose the row masks into column masks: with the low (then high) byte of
+	// 16 rows packed into one register, movemask reads bit 7 of every byte,
+	// which is one column; doubling the register moves the next column into bit 7.
+	alignas(16) uint16_t rows[32]{};
+	std::memcpy(rows, board.getRowMasks(), Gameboard::MAX_Y * sizeof(uint16_t));
+	__m128i lows[2];
+	__m128i highs[2];
+	const __m128i lowByte = _mm_set1_epi16(0x00FF);
+	for (int half = 0; half < 2; half++)
+	{
+		__m128i first = _mm_load_si128(reinterpret_cast<const __m128i *>(rows + 16 * half));
+		__m128i second = _mm_load_si128(reinterpret_cast<const __m128i *>(rows + 16 * half + 8));
+		lows[half] = _mm_packus_epi16(_mm_and_si128(first, lowByte), _mm_and_si128(second, lowByte));
+		highs[half] = _mm_packus_epi16(_mm_srli_epi16(first, 8), _mm_srli_epi16(second, 8));
+	}
+
+	// edges[0] is the left wall, edges[1 + x] is column x, and the padding is full like the right wall
+	alignas(16) uint32_t edges[PADDED_COLUMNS + 4];
+	for (int x = 7; x >= 0; x--)
+	{
+		edges[1 + x] = static_cast<uint32_t>(_mm_movemask_epi8(lows[0])) | (static_cast<uint32_t>(_mm_movemask_epi8(lows[1])) << 16);
+		edges[9 + x] = static_cast<uint32_t>(_mm_movemask_epi8(highs[0])) | (static_cast<uint32_t>(_mm_movemask_epi8(highs[1])) << 16);
+		for (int half = 0; half < 2; half++)
+		{
+			lows[half] = _mm_add_epi16(lows[half], lows[half]);
+			highs[half] = _mm_add_epi16(highs[half], highs[half]);
+		}
+	}
+	edges[0] = FULL_COLUMN;
+	for (int x = Gameboard::MAX_X; x < PADDED_COLUMNS + 3; x++)
+	{
+		edges[1 + x] = FULL_COLUMN;
+	}
+
+	// 4 columns at a time (see extractScalar() for the same steps on one column)
+	alignas(16) int32_t heights[PADDED_COLUMNS];
+	const __m128i full = _mm_set1_epi32(FULL_COLUMN);
+	const __m128i floorBit = _mm_set1_epi32(FLOOR_BIT);
+	__m128i holeCount = _mm_setzero_si128();
+	__m128i coveredCount = _mm_setzero_si128();
+	__m128i rowTransitions = _mm_setzero_si128();
+	__m128i columnTransitions = _mm_setzero_si128();
+	for (int x = 0; x < Gameboard::MAX_X + 1; x += 4)
+	{
+		__m128i column = _mm_loadu_si128(reinterpret_cast<const __m128i *>(edges + 1 + x));
+		__m128i previous = _mm_loadu_si128(reinterpret_cast<const __m128i *>(edges + x));
+
+		__m128i stack = column;
+		stack = _mm_or_si128(stack, _mm_slli_epi32(stack, 1));
+		stack = _mm_or_si128(stack, _mm_slli_epi32(stack, 2));
+		stack = _mm_or_si128(stack, _mm_slli_epi32(stack, 4));
+		stack = _mm_or_si128(stack, _mm_slli_epi32(stack, 8));
+		stack = _mm_or_si128(stack, _mm_slli_epi32(stack, 16));
+		stack = _mm_and_si128(stack, full);
+		_mm_store_si128(reinterpret_cast<__m128i *>(heights + x), popcountLanes(stack));
+
+		__m128i holes = _mm_andnot_si128(column, stack);
+		__m128i aboveHoles = holes;
+		aboveHoles = _mm_or_si128(aboveHoles, _mm_srli_epi32(aboveHoles, 1));
+		aboveHoles = _mm_or_si128(aboveHoles, _mm_srli_epi32(aboveHoles, 2));
+		aboveHoles = _mm_or_si128(aboveHoles, _mm_srli_epi32(aboveHoles, 4));
+		aboveHoles = _mm_or_si128(aboveHoles, _mm_srli_epi32(aboveHoles, 8));
+		aboveHoles = _mm_or_si128(aboveHoles, _mm_srli_epi32(aboveHoles, 16));
+		holeCount = _mm_add_epi32(holeCount, popcountLanes(holes));
+		coveredCount = _mm_add_epi32(coveredCount, popcountLanes(_mm_and_si128(aboveHoles, column)));
+
+		__m128i withFloor = _mm_or_si128(column, floorBit);
+		__m128i changes = _mm_and_si128(_mm_xor_si128(withFloor, _mm_srli_epi32(withFloor, 1)), full);
+		columnTransitions = _mm_add_epi32(columnTransitions, popcountLanes(changes));
+		rowTransitions = _mm_add_epi32(rowTransitions, popcountLanes(_mm_xor_si128(previous, column)));
+	}
+
+	features.holes = sumLanes(holeCount);
+	features.coveredCells = sumLanes(coveredCount);
+	features.rowTransitions = sumLanes(rowTransitions);
+	features.columnTransitions = sumLanes(columnTransitions);
+	addHeightFeatures(heights, features);
+}
+
+#else
+
+// Work out every feature of a board, using the widest SIMD the build allows.
+//   (this build has no SIMD, so this is extractScalar())
+// - param 1: the Gameboard to measure
+// - param 2: a Features, filled in
+// - return: nothing
+void BoardFeatures::extract(const Gameboard &board, Features &features)
+{
+	extractScalar(board, features);
+}
+
+#endif
+
+// the instruction set extract() was built with
+// - params: none
+// - return: "AVX2", "SSE2" or "scalar"
+const char *BoardFeatures::getInstructionSet()
+{
+#if defined(BOARDFEATURES_AVX2)
+	return "AVX2";
+#elif defined(BOARDFEATURES_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,66 @@
+// Board features are the numbers a placement evaluator scores a board by.
+//
+// extract() works them all out in one pass over a Gameboard and fills in a
+// fixed layout Features struct:
+//   - columnHeights:     the height of each column's stack (0 for an empty column)
+//   - aggregateHeight:   the sum of the column heights
+//   - maxHeight:         the tallest column
+//   - bumpiness:         the sum of the height differences between neighbouring columns
+//   - holes:             empty cells with a filled cell somewhere above them
+//   - coveredCells:      filled cells with a hole somewhere below them
+//   - rowTransitions:    filled/empty changes along each row (the walls count as filled)
+//   - columnTransitions: filled/empty changes down each column (the floor counts as filled)
+//   - wellDepths:        how far each column is below both its neighbours (walls are
+//                        as high as the board), 0 when it is not a well
+//   - wellSum:           each well of depth d adds 1+2+..+d (deep wells cost more)
+//
+// The board's row masks are turned into one 32-bit mask per column (bit y set
+// when row y is filled), and every per-column feature is then a handful of
+// shifts, ANDs and popcounts on that mask.  Those run on 8 columns at once with
+// AVX2 or 4 at once with SSE2, whichever the build targets (MSVC: /arch:AVX2;
+// SSE2 is always there on x64), and on one column at a time otherwise.
+// extractScalar() is the plain version, kept as the reference the SIMD
+// versions are tested against.
+
+#ifndef BOARDFEATURES_H
+#define BOARDFEATURES_H
+
+#include <cstdint>
+#include "Gameboard.h"
+
+namespace BoardFeatures
+{
+	// the features of one board
+	struct Features
+	{
+		int32_t columnHeights[Gameboard::MAX_X];
+		int32_t wellDepths[Gameboard::MAX_X];
+		int32_t aggregateHeight;
+		int32_t maxHeight;
+		int32_t bumpiness;
+		int32_t holes;
+		int32_t coveredCells;
+		int32_t rowTransitions;
+		int32_t columnTransitions;
+		int32_t wellSum;
+	};
+
+	// Work out every feature of a board, using the widest SIMD the build allows.
+	// - param 1: the Gameboard to measure
+	// - param 2: a Features, filled in
+	// - return: nothing
+	void extract(const Gameboard &board, Features &features);
+
+	// Work out every feature of a board one column at a time (no SIMD).
+	// - param 1: the Gameboard to measure
+	// - param 2: a Features, filled in (the same values extract() gives)
+	// - return: nothing
+	void extractScalar(const Gameboard &board, Features &features);
+
+	// the instruction set extract() was built with
+	// - params: none
+	// - return: "AVX2", "SSE2" or "scalar"
+	const char *getInstructionSet();
+}
+
+#endif /* BOARDFEATURES_H */
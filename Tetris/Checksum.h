@@ -0,0 +1,76 @@
+// The pieces of the game state checksum (see TetrisEngine::getChecksum()).
+//
+// The checksum is there to catch determinism breaks - two builds, or two
+// networked peers, whose games have quietly drifted apart - on the frame they
+// drift, rather than much later by diffing whole boards.  So it has to be cheap
+// enough to fold in every frame, and each part is only worked out again when
+// the game changes it.
+//   - the board (Gameboard::getChecksum()): every row has a key, the XOR of
+//     cellKey(x, color) over its filled cells, and the board's checksum is the sum
+//     of rowKey * rowWeight(y) over the rows.  The board only changes when a
+//     shape locks, so TetrisEngine works it out then (a few dozen mixes, skipping
+//     empty rows) and keeps it; boards copied and written by bot searches carry
+//     nothing extra.
+//   - the falling shape: shapeKey() of its shape, rotation and position, updated
+//     whenever it moves, rotates or spawns.
+//   - the rest (next shape, randomizer, score, level, rows cleared): updated
+//     once per locked shape.
+// Each step folds the three into a rolling checksum with mix(), so the value on
+// any frame depends on every frame before it.
+//
+// These are mixes, not cryptographic hashes: a deliberate forgery is easy, an
+// accidental match between two different games is not (1 in 2^64).  Changing
+// anything here changes every checksum, so it counts as a rules change (see
+// Replay::RULES_VERSION).
+
+#ifndef CHECKSUM_H
+#define CHECKSUM_H
+
+#include <cstdint>
+
+namespace Checksum
+{
+	// scramble a 64 bit value (the splitmix64 finalizer)
+	// - param 1: a uint64_t
+	// - return: a uint64_t, every bit depending on every input bit
+	inline uint64_t mix(uint64_t value)
+	{
+		value ^= value >> 30;
+		value *= 0xBF58476D1CE4E5B9ull;
+		value ^= value >> 27;
+		value *= 0x94D049BB133111EBull;
+		value ^= value >> 31;
+		return value;
+	}
+
+	// the key of a filled cell, within its row
+	// - param 1: an int for X (column)
+	// - param 2: an int, the cell's content (a color, not EMPTY_BLOCK)
+	// - return: a uint64_t
+	inline uint64_t cellKey(int x, int content)
+	{
+		return mix(0x1000u + static_cast<uint64_t>(x) * 16u + static_cast<uint64_t>(content));
+	}
+
+	// the weight of a row in the board's checksum
+	// - param 1: an int for Y (row)
+	// - return: a uint64_t (odd, so no row's key is ever multiplied away)
+	inline uint64_t rowWeight(int y)
+	{
+		return mix(0x2000u + static_cast<uint64_t>(y)) | 1u;
+	}
+
+	// the key of a shape at a position
+	// - param 1: an int, the TetShape
+	// - param 2: an int, the rotation
+	// - param 3: an int for X (its gridLoc)
+	// - param 4: an int for Y (its gridLoc)
+	// - return: a uint64_t
+	inline uint64_t shapeKey(int shape, int rotation, int x, int y)
+	{
+		return mix(0x3000u + (static_cast<uint64_t>(shape) << 24) + (static_cast<uint64_t>(rotation) << 16) +
+			(static_cast<uint64_t>(static_cast<uint8_t>(x)) << 8) + static_cast<uint8_t>(y));
+	}
+}
+
+#endif /* CHECKSUM_H */
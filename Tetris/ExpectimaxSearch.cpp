@@ -0,0 +1,473 @@
+#include <cassert>
+#include "Checksum.h"
+#include "ExpectimaxSearch.h"
+
+static const float TOP_OUT_SCORE = -1.0e5f;		// the value of a shape with nowhere to lock (far below any board)
+static const uint8_t ALL_SHAPES = (1 << TetShape::COUNT) - 1;
+
+// get the table key of a chance node
+//   (the board's key mixed with what else the node's value depends on, so it
+//   is never mistaken for the board's own feature score, or a shallower search)
+// - param 1: a uint64_t, the Zobrist key of the board
+// - param 2: a uint8_t, the shapes that could come
+// - param 3: an int, the chance plies left
+// - return: a uint64_t
+static uint64_t chanceKey(uint64_t boardKey, uint8_t possible, int plies)
+{
+	return boardKey ^ Checksum::mix(0x3000u + static_cast<uint64_t>(possible) * 16u + static_cast<uint64_t>(plies));
+}
+
+// constructor - allocate the arenas, the frontier and the table, and start the workers
+// assert chancePlies is between 0 and MAX_CHANCE_PLIES, and branching between 1 and MAX_BRANCHING
+// - param 1: the Weights to score boards with
+// - param 2: an int, the deepest search, in chance plies
+// - param 3: an int, the time a search may take in milliseconds (0 for no limit)
+// - param 4: an int, the placements a max node follows down
+// - param 5: an int, the worker threads (0 for one per hardware thread)
+ExpectimaxSearch::ExpectimaxSearch(const BotPolicy::Weights &weights, int chancePlies, int budgetMs, int branching, int threads)
+	:weights(weights), chancePlies(chancePlies), budgetMs(budgetMs), branching(branching), pool(threads)
+{
+	assert(chancePlies >= 0 && chancePlies <= MAX_CHANCE_PLIES && "ExpectimaxSearch - chancePlies out of range");
+	assert(branching >= 1 && branching <= MAX_BRANCHING && "ExpectimaxSearch - branching out of range");
+	arenas.resize(pool.getWorkers());
+	// (room for the frontier of the falling shape and one on deck, as in a game)
+	frontier.reserve(branching * branching);
+	nextFrontier.reserve(branching * branching);
+	branches.reserve(branching * branching * TetShape::COUNT);
+	branchValues.reserve(branching * branching * TetShape::COUNT);
+	roots.resize(MoveGenerator::MAX_PLACEMENTS);
+}
+
+// choose where a shape should lock
+// assert previewCount is between 0 and Randomizer::MAX_PREVIEW, and some shape can come
+// - param 1: the Gameboard
+// - param 2: a GridTetromino, the falling shape where it is now
+// - param 3: a pointer to the shapes after it that are known, in order (the preview)
+// - param 4: an int, the number of shapes in the preview
+// - param 5: a uint8_t, the shapes that could come after the preview, a bit per
+//   TetShape (see Randomizer::getPossibleShapes())
+// - param 6: the Randomizer::Policy the shapes are drawn with
+// - return: a Result
+ExpectimaxSearch::Result ExpectimaxSearch::search(const Gameboard &board, const GridTetromino &current, const TetShape *preview, int previewCount,
+	uint8_t possible, Randomizer::Policy policy)
+{
+	assert(previewCount >= 0 && previewCount <= Randomizer::MAX_PREVIEW && "ExpectimaxSearch - preview too long");
+	assert((possible & ALL_SHAPES) != 0 && "ExpectimaxSearch - some shape has to be able to come");
+	Result result;
+	auto start = std::chrono::steady_clock::now();
+	deadline = start + std::chrono::milliseconds(budgetMs);
+	stopped.store(false, std::memory_order_relaxed);
+	bagged = (policy == Randomizer::SEVEN_BAG);
+	table.newSearch();
+	for (auto &arena : arenas)
+	{
+		arena.nodes = 0;
+	}
+
+	if (placeKnownShapes(board, current, preview, previewCount))
+	{
+		// deepen a chance ply at a time, while a search could still finish in the
+		// time left (the next one takes longer than the last, so not if the last
+		// took longer than what is left)
+		std::chrono::steady_clock::duration last(0);
+		for (int plies = 0; plies <= chancePlies; plies++)
+		{
+			auto started = std::chrono::steady_clock::now();
+			if (plies > 0 && budgetMs > 0 && deadline - started < last)
+			{
+				result.outOfTime = true;
+				break;
+			}
+			if (plies > 0 && !searchFrontier(possible, plies))
+			{
+				result.outOfTime = true;
+				break;
+			}
+			last = std::chrono::steady_clock::now() - started;
+
+			// the best frontier board (the first, on a tie) gives the placement
+			int best = 0;
+			for (size_t i = 1; i < frontier.size(); i++)
+			{
+				best = (frontier[i].value > frontier[best].value) ? static_cast<int>(i) : best;
+			}
+			result.found = true;
+			result.placement = roots[frontier[best].root];
+			result.score = frontier[best].value;
+			result.chancePlies = plies;
+		}
+	}
+
+	for (const auto &arena : arenas)
+	{
+		result.nodes += arena.nodes;
+	}
+	return result;
+}
+
+// get the number of workers the search runs on
+// - params: none
+// - return: an int
+int ExpectimaxSearch::getWorkers() const
+{
+	return pool.getWorkers();
+}
+
+// place the known shapes: fill frontier with the boards they leave, keeping
+// the best branching placements of each shape on each board
+//   (on the caller's thread: it is a few dozen placements, next to the
+//   thousands below the frontier)
+// - param 1: the Gameboard
+// - param 2: a GridTetromino, the falling shape where it is now
+// - param 3: a pointer to the shapes after it that are known
+// - param 4: an int, the number of known shapes after it
+// - return: bool, false if the falling shape has nowhere to lock
+bool ExpectimaxSearch::placeKnownShapes(const Gameboard &board, const GridTetromino &current, const TetShape *preview, int previewCount)
+{
+	Level &level = arenas[0].levels[0];
+	frontier.clear();
+	frontier.push_back(Frontier());
+	frontier[0].board = board;
+	frontier[0].reward = 0.0f;
+	frontier[0].root = -1;
+	frontier[0].toppedOut = false;
+
+	for (int ply = 0; ply <= previewCount; ply++)
+	{
+		// the falling shape starts where it is; the ones after it where they will spawn
+		level.shape = current;
+		if (ply > 0)
+		{
+			level.shape.setShape(preview[ply - 1]);
+			level.shape.setGridLoc(board.getSpawnLoc());
+		}
+
+		nextFrontier.clear();
+		for (const Frontier &node : frontier)
+		{
+			int count = node.toppedOut ? 0 : MoveGenerator::generatePlacements(node.board, level.shape, level.placements);
+			if (count == 0)
+			{
+				if (ply == 0)
+				{
+					return false;
+				}
+				nextFrontier.push_back(node);
+				nextFrontier.back().toppedOut = true;
+				nextFrontier.back().value = TOP_OUT_SCORE;
+				continue;
+			}
+
+			int kept = choosePlacements(node.board, level, count, 0);
+			for (int i = 0; i < kept; i++)
+			{
+				const Choice &choice = level.choices[i];
+				const MoveGenerator::Placement &placement = level.placements.placements[choice.order];
+				GridTetromino placed = level.shape;
+				placed.setRotation(placement.rotation);
+				placed.setGridLoc(placement.x, placement.y);
+
+				nextFrontier.push_back(node);
+				Frontier &child = nextFrontier.back();
+				child.board.removeRows(child.board.lockBlocks(placed.getBlockLocsMappedToGrid(), placed.getColor()));
+				child.reward = node.reward + choice.reward;
+				child.value = node.reward + choice.score;
+				if (ply == 0)
+				{
+					roots[choice.order] = placement;
+					child.root = choice.order;
+				}
+			}
+		}
+		std::swap(frontier, nextFrontier);
+	}
+	return true;
+}
+
+// search every chance branch of the frontier to a depth
+//   A frontier board whose chance node is in the table is not searched again;
+//   the others' branches (one per shape that could come) are shared out over the
+//   workers, then averaged in shape order - the same sum chanceNode() works out,
+//   so a value from the table and one searched here always agree.
+// - param 1: a uint8_t, the shapes that could come first
+// - param 2: an int, the chance plies to search
+// - return: bool, false if the budget ran out first (the frontier values are left as they were)
+bool ExpectimaxSearch::searchFrontier(uint8_t possible, int plies)
+{
+	branches.clear();
+	branchValues.resize(frontier.size() * TetShape::COUNT);
+	for (size_t i = 0; i < frontier.size(); i++)
+	{
+		Frontier &node = frontier[i];
+		TranspositionTable::Entry entry;
+		node.searched = false;
+		if (node.toppedOut)
+		{
+			node.chance = TOP_OUT_SCORE;
+		}
+		else if (table.probe(chanceKey(node.board.getZobristKey(), possible, plies), entry) && entry.depth == plies)
+		{
+			node.chance = entry.value;
+		}
+		else
+		{
+			node.searched = true;
+			for (int shape = 0; shape < TetShape::COUNT; shape++)
+			{
+				if (possible & (1 << shape))
+				{
+					branches.push_back(Branch{ static_cast<int>(i), shape });
+				}
+			}
+		}
+	}
+
+	pool.run(static_cast<int>(branches.size()), [this, possible, plies](int task, int worker)
+	{
+		const Branch &branch = branches[task];
+		branchValues[branch.frontier * TetShape::COUNT + branch.shape] =
+			maxNode(frontier[branch.frontier].board, branch.shape, afterDrawing(possible, branch.shape), plies - 1, 0, worker);
+	});
+	if (stopped.load(std::memory_order_relaxed))
+	{
+		return false;
+	}
+
+	for (size_t i = 0; i < frontier.size(); i++)
+	{
+		Frontier &node = frontier[i];
+		if (node.searched)
+		{
+			float sum = 0.0f;
+			int count = 0;
+			for (int shape = 0; shape < TetShape::COUNT; shape++)
+			{
+				if (possible & (1 << shape))
+				{
+					sum += branchValues[i * TetShape::COUNT + shape];
+					count++;
+				}
+			}
+			node.chance = sum / count;
+			table.store(chanceKey(node.board.getZobristKey(), possible, plies), node.chance, plies);
+		}
+	}
+	for (Frontier &node : frontier)
+	{
+		node.value = node.toppedOut ? TOP_OUT_SCORE : node.reward + node.chance;
+	}
+	return true;
+}
+
+// the value of a max node: the best a shape can do on a board
+//   Only the best branching placements (by the boards they leave) are searched
+//   further down; on the last ply the best board's score is the value.
+// - param 1: the Gameboard
+// - param 2: an int, the TetShape
+// - param 3: a uint8_t, the shapes that could come after it
+// - param 4: an int, the chance plies left after it (0 to score the boards it leaves)
+// - param 5: an int, the ply (the Level of the worker's arena to use)
+// - param 6: an int, the worker
+// - return: a float (meaningless once the budget has run out)
+float ExpectimaxSearch::maxNode(const Gameboard &board, int shape, uint8_t possible, int plies, int level, int worker)
+{
+	if (outOfTime())
+	{
+		return 0.0f;
+	}
+	Level &here = arenas[worker].levels[level];
+	here.shape.setShape(static_cast<TetShape>(shape));
+	here.shape.setGridLoc(board.getSpawnLoc());
+	int count = MoveGenerator::generatePlacements(board, here.shape, here.placements);
+	if (count == 0)
+	{
+		return TOP_OUT_SCORE;
+	}
+
+	int kept = choosePlacements(board, here, count, worker);
+	if (plies == 0)
+	{
+		return here.choices[0].score;
+	}
+
+	float best = TOP_OUT_SCORE;
+	for (int i = 0; i < kept; i++)
+	{
+		const Choice &choice = here.choices[i];
+		const MoveGenerator::Placement &placement = here.placements.placements[choice.order];
+		GridTetromino placed = here.shape;
+		placed.setRotation(placement.rotation);
+		placed.setGridLoc(placement.x, placement.y);
+		here.board = board;
+		here.board.removeRows(here.board.lockBlocks(placed.getBlockLocsMappedToGrid(), placed.getColor()));
+
+		float value = choice.reward + chanceNode(here.board, possible, plies, level + 1, worker);
+		best = (i == 0 || value > best) ? value : best;
+	}
+	return best;
+}
+
+// the value of a chance node: the average, over the shapes that could come,
+// of their max nodes (looked up in the table if it is there)
+// - param 1: the Gameboard
+// - param 2: a uint8_t, the shapes that could come
+// - param 3: an int, the chance plies left (at least 1)
+// - param 4: an int, the ply (the Level of the worker's arena to use)
+// - param 5: an int, the worker
+// - return: a float (meaningless once the budget has run out)
+float ExpectimaxSearch::chanceNode(const Gameboard &board, uint8_t possible, int plies, int level, int worker)
+{
+	uint64_t key = chanceKey(board.getZobristKey(), possible, plies);
+	TranspositionTable::Entry entry;
+	if (table.probe(key, entry) && entry.depth == plies)
+	{
+		return entry.value;
+	}
+
+	float sum = 0.0f;
+	int count = 0;
+	for (int shape = 0; shape < TetShape::COUNT; shape++)
+	{
+		if (possible & (1 << shape))
+		{
+			sum += maxNode(board, shape, afterDrawing(possible, shape), plies - 1, level, worker);
+			count++;
+		}
+	}
+	if (stopped.load(std::memory_order_relaxed))
+	{
+		return 0.0f;	// (a search cut short must not leave its values in the table)
+	}
+	float value = sum / count;
+	table.store(key, value, plies);
+	return value;
+}
+
+// score each placement of a shape by the board it leaves, and keep the best
+// branching of them in a Level's choices
+//   The board's feature score comes from the table when it is there, and a
+//   placement that completes no rows is looked up by the key it would leave
+//   (as in BeamSearch), so a hit costs no copy of the board.  Ties go to the
+//   earlier placement.
+// - param 1: the Gameboard
+// - param 2: a Level, holding the shape (where it starts) and its placements
+// - param 3: an int, the number of placements
+// - param 4: an int, the worker
+// - return: an int, the number of choices kept
+int ExpectimaxSearch::choosePlacements(const Gameboard &board, Level &level, int count, int worker)
+{
+	arenas[worker].nodes += count;
+	int kept = 0;
+	GridTetromino placed = level.shape;
+	for (int i = 0; i < count; i++)
+	{
+		const MoveGenerator::Placement &placement = level.placements.placements[i];
+		placed.setRotation(placement.rotation);
+		placed.setGridLoc(placement.x, placement.y);
+		BlockList blocks = placed.getBlockLocsMappedToGrid();
+
+		int rowsCompleted;
+		uint64_t key = board.getZobristKeyAfterLock(blocks, rowsCompleted);
+		TranspositionTable::Entry entry;
+		if (rowsCompleted > 0 || !table.probe(key, entry) || entry.depth != 0)
+		{
+			level.board = board;
+			level.board.removeRows(level.board.lockBlocks(blocks, placed.getColor()));
+			key = level.board.getZobristKey();
+			if (rowsCompleted == 0 || !table.probe(key, entry) || entry.depth != 0)
+			{
+				entry.value = static_cast<float>(weights.evaluate(level.board, 0));
+				table.store(key, entry.value);
+			}
+		}
+
+		Choice choice;
+		choice.reward = static_cast<float>(weights.rowsCleared * rowsCompleted);
+		choice.score = choice.reward + entry.value;
+		choice.order = i;
+		if (kept < branching || choice.score > level.choices[kept - 1].score)
+		{
+			// insert it in order, pushing the worst off the end if they are all kept
+			int slot = (kept < branching) ? kept++ : kept - 1;
+			while (slot > 0 && level.choices[slot - 1].score < choice.score)
+			{
+				level.choices[slot] = level.choices[slot - 1];
+				slot--;
+			}
+			level.choices[slot] = choice;
+		}
+	}
+	return kept;
+}
+
+// the shapes that could come after a shape is drawn
+//   (a seven bag loses the shape, and is refilled once it is empty; otherwise
+//   any shape can always come)
+// - param 1: a uint8_t, the shapes that could have come
+// - param 2: an int, the TetShape that came
+// - return: a uint8_t
+uint8_t ExpectimaxSearch::afterDrawing(uint8_t possible, int shape) const
+{
+	if (!bagged)
+	{
+		return ALL_SHAPES;
+	}
+	possible &= ~(1 << shape);
+	return (possible != 0) ? possible : ALL_SHAPES;
+}
+
+// check whether the budget has run out (and stop the search if it has)
+// - params: none
+// - return: bool, true once it has
+bool ExpectimaxSearch::outOfTime()
+{
+	if (stopped.load(std::memory_order_relaxed))
+	{
+		return true;
+	}
+	if (budgetMs > 0 && std::chrono::steady_clock::now() >= deadline)
+	{
+		stopped.store(true, std::memory_order_relaxed);
+		return true;
+	}
+	return false;
+}
+
+// constructor
+// - param 1: the Weights to score boards with
+// - param 2: an int, the deepest search, in chance plies
+// - param 3: an int, the time a search may take in milliseconds (0 for no limit)
+// - param 4: an int, the placements a max node follows down
+// - param 5: an int, the worker threads (0 for one per hardware thread)
+ExpectimaxPolicy::ExpectimaxPolicy(const BotPolicy::Weights &weights, int chancePlies, int budgetMs, int branching, int threads)
+	:search(weights, chancePlies, budgetMs, branching, threads)
+{
+}
+
+// search from the falling shape, the one on deck and the shapes that could
+// follow it, and give every input to lock the shape where the search chose at
+// once (ending with a hard drop)
+//   (the shapes that could follow are the ones the player can't rule out - see
+//   Randomizer::getPossibleShapes() - not the ones the randomizer has queued)
+int ExpectimaxPolicy::chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs)
+{
+	if (engine.getGameOver())
+	{
+		return 0;
+	}
+	const Randomizer &randomizer = engine.getRandomizer();
+	TetShape preview[1] = { engine.getNextShape().getShape() };
+	ExpectimaxSearch::Result result = search.search(engine.getBoard(), engine.getCurrentShape(), preview, 1,
+		randomizer.getPossibleShapes(0), randomizer.getPolicy());
+
+	int count = 0;
+	if (result.found)
+	{
+		count = MoveGenerator::findInputs(engine.getBoard(), engine.getCurrentShape(), result.placement, inputs, MAX_INPUTS);
+	}
+	if (count == 0)
+	{
+		inputs[count++] = TetrisEngine::HARD_DROP;
+	}
+	return count;
+}
@@ -0,0 +1,251 @@
+// ExpectimaxSearch looks past the shapes a player can see, to the ones nobody has
+// seen yet, to choose where the falling shape should lock.
+//
+// The falling shape and the preview are known, and are searched like a beam
+// search (see BeamSearch): every placement of each, scored by the board it
+// leaves, keeping the best few at each ply.  That gives the frontier: the boards
+// left once every known shape has been placed.  From there the shapes are
+// random, so the search is an expectimax over them:
+//   - a chance node is a board and the shapes that could come next: its value is
+//     the average, over those shapes, of the best the next ply can do with each
+//   - a max node is a board and a shape: its value is the best, over the
+//     placements of the shape, of the rows it clears plus the value of the chance
+//     node it leaves - or, on the last ply, the feature score of the board
+// A max node scores every placement by the board it leaves (like BotPolicy), and
+// follows only the best branching of them further down.  A shape with nowhere to
+// lock is a top out, scored far below any board.
+//
+// The shapes that could come next are a bit per shape.  Under the seven bag
+// randomizer each draw takes its shape out of the bag, and an empty bag is
+// refilled with all seven (see Randomizer::getPossibleShapes() for where the
+// first one comes from); under the other randomizers it is always all seven.
+//
+// Chance nodes are memoized in a TranspositionTable, by the board's Zobrist key
+// mixed with the shapes that could come and the chance plies left, so a board
+// reached by another route, or by the last move's search, is looked up instead
+// of searched again.  The feature scores of the boards at the leaves are kept in
+// the same table, by the board's key alone.
+//
+// The search deepens one chance ply at a time (iterative deepening), keeping the
+// choice of the deepest search that finished, until it reaches chancePlies or
+// the time budget for the move runs out (a search that is cut short is thrown
+// away).  The known plies alone are always searched, whatever the budget.
+//
+// Each chance ply of the frontier is spread over a WorkerPool, one task per
+// frontier board and shape that could come (its chance branches), each searched
+// to the end on one worker with that worker's own scratch memory, allocated when
+// the search is made - nothing is allocated in the inner loop.  The values are
+// averaged in a fixed order once every task is done, so with no time budget a
+// search chooses the same placement on any number of threads.
+//
+// ExpectimaxPolicy plays a game with an ExpectimaxSearch, the way BeamPolicy
+// does with a BeamSearch; it is the bot to use when the score is what counts.
+
+#ifndef EXPECTIMAXSEARCH_H
+#define EXPECTIMAXSEARCH_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "Gameboard.h"
+#include "GridTetromino.h"
+#include "InputPolicy.h"
+#include "MoveGenerator.h"
+#include "Randomizer.h"
+#include "TranspositionTable.h"
+#include "WorkerPool.h"
+
+class ExpectimaxSearch
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+public:
+	// CONSTANTS
+	static const int DEFAULT_CHANCE_PLIES = 2;		// the deepest search, in shapes nobody has seen, by default
+	static const int MAX_CHANCE_PLIES = 4;			// the deepest search there is room for
+	static const int DEFAULT_BRANCHING = 4;			// placements a max node follows down, by default
+	static const int MAX_BRANCHING = 16;			// the most placements a max node can follow
+	static const int DEFAULT_BUDGET_MS = 20;		// the time a search may take, by default (ms)
+	static const int TABLE_BUCKET_BITS = 16;		// log2 of the table's buckets (4MB)
+
+	// what a search found
+	struct Result
+	{
+		bool found{ false };					// false if the falling shape has nowhere to lock
+		MoveGenerator::Placement placement{};	// where the falling shape should lock
+		float score{ 0.0f };					// the expected score of the placement
+		int chancePlies{ 0 };					// the chance plies of the deepest search that finished
+		int nodes{ 0 };							// the placements scored
+		bool outOfTime{ false };				// true if the budget ran out before chancePlies
+	};
+
+private:
+	// a board left once every known shape is placed
+	struct Frontier
+	{
+		Gameboard board;
+		float reward;		// the score of the rows cleared on the way to the board
+		int root;			// the first ply placement it came from
+		bool toppedOut;		// true if a known shape had nowhere to lock on the way
+		float value;		// reward + its chance node's value, at the deepest search that finished
+		float chance;		// its chance node's value, at the depth being searched
+		bool searched;		// true if its chance branches are being searched (not in the table)
+	};
+
+	// a placement a max node may follow down
+	struct Choice
+	{
+		float score;		// the rows it clears + the feature score of the board it leaves
+		float reward;		// the score of the rows it clears
+		int order;			// its index in the PlacementList
+	};
+
+	// one ply of a worker's search
+	struct Level
+	{
+		MoveGenerator::PlacementList placements;	// the placements of the max node's shape
+		GridTetromino shape;						// the max node's shape
+		Gameboard board;							// a board to lock placements on
+		Choice choices[MAX_BRANCHING];				// the best placements, best first
+	};
+
+	// one worker's scratch memory
+	struct Arena
+	{
+		Level levels[MAX_CHANCE_PLIES];
+		int nodes{ 0 };				// the placements scored this search
+	};
+
+	// a chance branch of the frontier, waiting to be searched
+	struct Branch
+	{
+		int frontier;		// the index of the frontier board
+		int shape;			// the TetShape that comes
+	};
+
+	BotPolicy::Weights weights;
+	int chancePlies;
+	int budgetMs;
+	int branching;
+	WorkerPool pool;
+	std::vector<Arena> arenas;				// one per worker
+	std::vector<Frontier> frontier;			// the boards left by the known shapes
+	std::vector<Frontier> nextFrontier;		// the boards being left by the next known shape
+	std::vector<Branch> branches;			// the chance branches being searched
+	std::vector<float> branchValues;		// their values, by frontier * TetShape::COUNT + shape
+	std::vector<MoveGenerator::Placement> roots;	// the first ply placements
+	TranspositionTable table{ TABLE_BUCKET_BITS };	// chance node values and board feature scores
+
+	bool bagged{ false };					// true if shapes are drawn from a seven bag (this search)
+	std::chrono::steady_clock::time_point deadline;	// when this search's budget runs out
+	std::atomic<bool> stopped{ false };		// set once the budget has run out
+
+public:
+	// constructor - allocate the arenas, the frontier and the table, and start the workers
+	// assert chancePlies is between 0 and MAX_CHANCE_PLIES, and branching between 1 and MAX_BRANCHING
+	// - param 1: the Weights to score boards with
+	// - param 2: an int, the deepest search, in chance plies
+	// - param 3: an int, the time a search may take in milliseconds (0 for no limit)
+	// - param 4: an int, the placements a max node follows down
+	// - param 5: an int, the worker threads (0 for one per hardware thread)
+	ExpectimaxSearch(const BotPolicy::Weights &weights = BotPolicy::Weights(), int chancePlies = DEFAULT_CHANCE_PLIES,
+		int budgetMs = DEFAULT_BUDGET_MS, int branching = DEFAULT_BRANCHING, int threads = 0);
+
+	// choose where a shape should lock
+	// assert previewCount is between 0 and Randomizer::MAX_PREVIEW, and some shape can come
+	// - param 1: the Gameboard
+	// - param 2: a GridTetromino, the falling shape where it is now
+	// - param 3: a pointer to the shapes after it that are known, in order (the preview)
+	// - param 4: an int, the number of shapes in the preview
+	// - param 5: a uint8_t, the shapes that could come after the preview, a bit per
+	//   TetShape (see Randomizer::getPossibleShapes())
+	// - param 6: the Randomizer::Policy the shapes are drawn with
+	// - return: a Result
+	Result search(const Gameboard &board, const GridTetromino &current, const TetShape *preview, int previewCount,
+		uint8_t possible, Randomizer::Policy policy);
+
+	// get the number of workers the search runs on
+	// - params: none
+	// - return: an int
+	int getWorkers() const;
+
+private:
+	// place the known shapes: fill frontier with the boards they leave, keeping
+	// the best branching placements of each shape on each board
+	// - param 1: the Gameboard
+	// - param 2: a GridTetromino, the falling shape where it is now
+	// - param 3: a pointer to the shapes after it that are known
+	// - param 4: an int, the number of known shapes after it
+	// - return: bool, false if the falling shape has nowhere to lock
+	bool placeKnownShapes(const Gameboard &board, const GridTetromino &current, const TetShape *preview, int previewCount);
+
+	// search every chance branch of the frontier to a depth
+	// - param 1: a uint8_t, the shapes that could come first
+	// - param 2: an int, the chance plies to search
+	// - return: bool, false if the budget ran out first (values is left as it was)
+	bool searchFrontier(uint8_t possible, int plies);
+
+	// the value of a max node: the best a shape can do on a board
+	// - param 1: the Gameboard
+	// - param 2: an int, the TetShape
+	// - param 3: a uint8_t, the shapes that could come after it
+	// - param 4: an int, the chance plies left after it (0 to score the boards it leaves)
+	// - param 5: an int, the ply (the Level of the worker's arena to use)
+	// - param 6: an int, the worker
+	// - return: a float
+	float maxNode(const Gameboard &board, int shape, uint8_t possible, int plies, int level, int worker);
+
+	// the value of a chance node: the average, over the shapes that could come,
+	// of their max nodes (looked up in the table if it is there)
+	// - param 1: the Gameboard
+	// - param 2: a uint8_t, the shapes that could come
+	// - param 3: an int, the chance plies left (at least 1)
+	// - param 4: an int, the ply (the Level of the worker's arena to use)
+	// - param 5: an int, the worker
+	// - return: a float
+	float chanceNode(const Gameboard &board, uint8_t possible, int plies, int level, int worker);
+
+	// score each placement of a shape by the board it leaves, and keep the best
+	// branching of them in a Level's choices
+	// - param 1: the Gameboard
+	// - param 2: a Level, holding the shape (where it starts) and its placements
+	// - param 3: an int, the number of placements
+	// - param 4: an int, the worker
+	// - return: an int, the number of choices kept
+	int choosePlacements(const Gameboard &board, Level &level, int count, int worker);
+
+	// the shapes that could come after a shape is drawn
+	// - param 1: a uint8_t, the shapes that could have come
+	// - param 2: an int, the TetShape that came
+	// - return: a uint8_t
+	uint8_t afterDrawing(uint8_t possible, int shape) const;
+
+	// check whether the budget has run out (and stop the search if it has)
+	// - params: none
+	// - return: bool, true once it has
+	bool outOfTime();
+};
+
+class ExpectimaxPolicy : public InputPolicy
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+private:
+	ExpectimaxSearch search;
+
+public:
+	// constructor
+	// - param 1: the Weights to score boards with
+	// - param 2: an int, the deepest search, in chance plies
+	// - param 3: an int, the time a search may take in milliseconds (0 for no limit)
+	// - param 4: an int, the placements a max node follows down
+	// - param 5: an int, the worker threads (0 for one per hardware thread)
+	ExpectimaxPolicy(const BotPolicy::Weights &weights = BotPolicy::Weights(), int chancePlies = ExpectimaxSearch::DEFAULT_CHANCE_PLIES,
+		int budgetMs = ExpectimaxSearch::DEFAULT_BUDGET_MS, int branching = ExpectimaxSearch::DEFAULT_BRANCHING, int threads = 0);
+
+	// search from the falling shape, the one on deck and the shapes that could
+	// follow it, and give every input to lock the shape where the search chose at
+	// once (ending with a hard drop)
+	int chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs) override;
+};
+
+#endif /* EXPECTIMAXSEARCH_H */
@@ -0,0 +1,39 @@
+#include <cassert>
+#include "FixedTimestep.h"
+
+// constructor
+// assert stepsPerSecond is positive
+// - param 1: an int, the number of steps per second of wall clock time
+FixedTimestep::FixedTimestep(int stepsPerSecond)
+	:stepsPerSecond(stepsPerSecond)
+{
+	assert(stepsPerSecond > 0 && "FixedTimestep needs a positive step rate");
+}
+
+// add elapsed wall clock time and find how many steps are now due
+// - param 1: an int64_t, the microseconds since the last call
+// - return: an int, the number of steps to run (0 to MAX_STEPS_PER_ADVANCE)
+int FixedTimestep::advance(int64_t elapsedMicroseconds)
+{
+	if (elapsedMicroseconds > 0)
+	{
+		accumulator += elapsedMicroseconds * stepsPerSecond;
+	}
+
+	int64_t steps = accumulator / MICROSECONDS_PER_SECOND;
+	if (steps > MAX_STEPS_PER_ADVANCE)
+	{
+		accumulator = 0;	// too far behind - drop the backlog
+		return MAX_STEPS_PER_ADVANCE;
+	}
+	accumulator -= steps * MICROSECONDS_PER_SECOND;
+	return static_cast<int>(steps);
+}
+
+// forget any time that has built up
+// - params: none
+// - return: nothing
+void FixedTimestep::reset()
+{
+	accumulator = 0;
+}
@@ -0,0 +1,51 @@
+// The FixedTimestep class turns wall clock time into a whole number of simulation steps.
+//
+// The game is simulated in fixed steps (frames) so that it behaves the same no
+// matter how fast the screen is drawn.  Each game loop the elapsed wall clock
+// time is added to an accumulator, and advance() reports how many whole steps
+// fit into it; whatever is left over carries into the next loop instead of being
+// thrown away, so the simulation keeps pace with real time exactly.
+//
+// Time is kept as an integer (microseconds scaled by the step rate), so there is
+// no floating point drift however long a game runs.
+//
+// If the game falls far behind (e.g. the window was dragged), at most
+// MAX_STEPS_PER_ADVANCE steps are reported and the rest of the backlog is dropped,
+// so the game never tries to catch up on minutes of missed steps at once.
+
+#ifndef FIXEDTIMESTEP_H
+#define FIXEDTIMESTEP_H
+
+#include <cstdint>
+
+class FixedTimestep
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+public:
+	// CONSTANTS
+	static const int64_t MICROSECONDS_PER_SECOND = 1000000;
+	static const int MAX_STEPS_PER_ADVANCE = 10;	// the most steps advance() will ask for at once
+
+private:
+	// MEMBER VARIABLES
+	int stepsPerSecond;		// the simulation step rate
+	int64_t accumulator{ 0 };	// unsimulated time, in microseconds * stepsPerSecond
+
+public:
+	// constructor
+	// assert stepsPerSecond is positive
+	// - param 1: an int, the number of steps per second of wall clock time
+	FixedTimestep(int stepsPerSecond);
+
+	// add elapsed wall clock time and find how many steps are now due
+	// - param 1: an int64_t, the microseconds since the last call
+	// - return: an int, the number of steps to run (0 to MAX_STEPS_PER_ADVANCE)
+	int advance(int64_t elapsedMicroseconds);
+
+	// forget any time that has built up
+	// - params: none
+	// - return: nothing
+	void reset();
+};
+
+#endif /* FIXEDTIMESTEP_H */
@@ -0,0 +1,238 @@
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include "GameFarm.h"
+#include "Randomizer.h"
+#include "TetrisListener.h"
+
+// a worker's share of the games
+struct WorkQueue
+{
+	std::mutex mutex;
+	std::deque<int> games;		// indices into the run's seeds and results
+};
+
+// counts what a game does, for its GameResult
+class FarmListener : public TetrisListener
+{
+public:
+	int shapes{ 0 };
+	int rowsCleared{ 0 };
+
+	void onShapeLocked() override { shapes++; }
+	void onRowsCleared(int rows) override { rowsCleared += rows; }
+};
+
+// take a game from the back of a worker's own deque
+// - param 1: the worker's WorkQueue
+// - param 2: an int, set to the game taken
+// - return: bool, false if the deque is empty
+static bool popGame(WorkQueue &queue, int &game)
+{
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.games.empty())
+	{
+		return false;
+	}
+	game = queue.games.back();
+	queue.games.pop_back();
+	return true;
+}
+
+// take a game from the front of another worker's deque
+// - param 1: the other worker's WorkQueue
+// - param 2: an int, set to the game taken
+// - return: bool, false if the deque is empty
+static bool stealGame(WorkQueue &queue, int &game)
+{
+	std::lock_guard<std::mutex> lock(queue.mutex);
+	if (queue.games.empty())
+	{
+		return false;
+	}
+	game = queue.games.front();
+	queue.games.pop_front();
+	return true;
+}
+
+// constructor
+// assert a policy factory is given
+// - param 1: a PolicyFactory, called once per worker thread for each run
+// - param 2: an int, the number of worker threads (0 for one per core)
+GameFarm::GameFarm(PolicyFactory makePolicy, int threads)
+	:threads(threads), makePolicy(makePolicy)
+{
+	assert(makePolicy && "GameFarm - a policy factory is needed");
+	if (this->threads <= 0)
+	{
+		this->threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	}
+}
+
+// play a run of games and report on it
+// assert games is positive
+// - param 1: an int, the number of games
+// - param 2: a uint64_t, the seed every game's seed is dealt from
+// - param 3: an int, the most shapes to play in a game (0 for no cap)
+// - return: a Report on the run
+GameFarm::Report GameFarm::run(int games, uint64_t seed, int maxShapes)
+{
+	assert(games > 0 && "GameFarm - a run needs at least one game");
+
+	std::vector<uint64_t> seeds(games);
+	Randomizer seeder(seed, Randomizer::UNIFORM);
+	for (uint64_t &gameSeed : seeds)
+	{
+		gameSeed = seeder.nextRandom();
+	}
+	results.assign(games, GameResult());
+
+	// deal each worker a contiguous share
+	int workers = std::min(threads, games);
+	std::vector<WorkQueue> queues(workers);
+	for (int worker = 0; worker < workers; worker++)
+	{
+		int first = static_cast<int>(static_cast<int64_t>(games) * worker / workers);
+		int last = static_cast<int>(static_cast<int64_t>(games) * (worker + 1) / workers);
+		for (int game = first; game < last; game++)
+		{
+			queues[worker].games.push_back(game);
+		}
+	}
+
+	std::atomic<int> steals{ 0 };
+	auto work = [&](int worker)
+	{
+		std::unique_ptr<InputPolicy> policy = makePolicy();
+		int game;
+		for (;;)
+		{
+			if (!popGame(queues[worker], game))
+			{
+				// nothing left of our own: look for a game to steal, starting with the next worker
+				// (games are never added during a run, so finding every deque empty means we are done)
+				bool stolen = false;
+				for (int offset = 1; offset < workers && !stolen; offset++)
+				{
+					stolen = stealGame(queues[(worker + offset) % workers], game);
+				}
+				if (!stolen)
+				{
+					return;
+				}
+				steals++;
+			}
+			results[game] = playGame(*policy, seeds[game], maxShapes);
+		}
+	};
+
+	auto start = std::chrono::steady_clock::now();
+	std::vector<std::thread> pool;
+	for (int worker = 1; worker < workers; worker++)
+	{
+		pool.emplace_back(work, worker);
+	}
+	work(0);
+	for (std::thread &thread : pool)
+	{
+		thread.join();
+	}
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	Report report;
+	report.games = games;
+	report.threads = workers;
+	report.steals = steals;
+	report.seconds = elapsed.count();
+	std::vector<int64_t> scores;
+	std::vector<int64_t> rowsCleared;
+	for (const GameResult &result : results)
+	{
+		report.shapes += result.shapes;
+		report.frames += result.frames;
+		scores.push_back(result.score);
+		rowsCleared.push_back(result.rowsCleared);
+	}
+	if (report.seconds > 0)
+	{
+		report.shapesPerSecond = report.shapes / report.seconds;
+		report.gamesPerSecond = games / report.seconds;
+	}
+	report.scores = distribution(scores);
+	report.rowsCleared = distribution(rowsCleared);
+	return report;
+}
+
+const std::vector<GameFarm::GameResult> &GameFarm::getResults() const
+{
+	return results;
+}
+
+int GameFarm::getThreads() const
+{
+	return threads;
+}
+
+// work out the spread of some numbers
+// - param 1: a vector of int64_ts (reordered)
+// - return: a Distribution, all 0 for no numbers
+GameFarm::Distribution GameFarm::distribution(std::vector<int64_t> &values)
+{
+	Distribution spread;
+	if (values.empty())
+	{
+		return spread;
+	}
+	std::sort(values.begin(), values.end());
+	size_t last = values.size() - 1;
+	spread.min = values.front();
+	spread.p10 = values[last / 10];
+	spread.median = values[last / 2];
+	spread.p90 = values[last - last / 10];
+	spread.max = values.back();
+	double sum = 0.0;
+	for (int64_t value : values)
+	{
+		sum += value;
+	}
+	spread.mean = sum / values.size();
+	return spread;
+}
+
+// play one game to the end (or the shape cap)
+// - param 1: the InputPolicy to play with
+// - param 2: a uint64_t, the game's seed
+// - param 3: an int, the most shapes to play (0 for no cap)
+// - return: a GameResult for the game
+GameFarm::GameResult GameFarm::playGame(InputPolicy &policy, uint64_t seed, int maxShapes)
+{
+	TetrisEngine engine(seed);
+	FarmListener listener;
+	engine.setListener(&listener);
+	policy.newGame(seed);
+
+	TetrisEngine::Input inputs[InputPolicy::MAX_INPUTS];
+	while (!engine.getGameOver() && (maxShapes <= 0 || listener.shapes < maxShapes))
+	{
+		int count = policy.chooseInputs(engine, inputs);
+		for (int i = 0; i < count; i++)
+		{
+			engine.input(inputs[i]);
+		}
+		engine.step();
+	}
+
+	GameResult result;
+	result.seed = seed;
+	result.score = engine.getScore();
+	result.rowsCleared = listener.rowsCleared;
+	result.level = engine.getLevel();
+	result.shapes = listener.shapes;
+	result.frames = engine.getFrame();
+	result.toppedOut = engine.getGameOver();
+	return result;
+}
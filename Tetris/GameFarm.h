@@ -0,0 +1,121 @@
+// GameFarm plays large numbers of independent, headless games on every core,
+// for evaluating bots overnight.
+//
+// Each game is a TetrisEngine with its own seed, played by an InputPolicy: every
+// frame the policy chooses its inputs, then the game is stepped, until the game
+// tops out (or reaches a cap on the shapes played).  The game seeds are dealt
+// from a Randomizer seeded with the run's seed, and each worker thread makes its
+// own policy and starts it again for every game, so the results of a run depend
+// only on the seed - never on the number of threads or on which thread played
+// which game.
+//
+// Scheduling is work stealing.  Every worker has its own deque of games, dealt
+// a contiguous share of the run up front.  A worker takes games from the back of
+// its own deque; once that is empty it steals from the front of the others', so
+// a worker that drew a run of long games is helped out by the ones that finished
+// early, and no thread sits idle while there is a game left to play.  Games are
+// long (thousands of frames), so each deque is a plain mutex and std::deque:
+// the lock is taken once per game and is never contended for long.
+//
+// run() returns a Report: the throughput (shapes and games per second of wall
+// clock time) and the spread of scores and rows cleared over the games.
+
+#ifndef GAMEFARM_H
+#define GAMEFARM_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "InputPolicy.h"
+
+class GameFarm
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+public:
+	// makes a policy for one worker thread
+	typedef std::function<std::unique_ptr<InputPolicy>()> PolicyFactory;
+
+	// how one game went
+	struct GameResult
+	{
+		uint64_t seed;		// the seed the game was played from
+		int64_t score;
+		int rowsCleared;
+		int level;			// the level the game ended on
+		int shapes;			// shapes locked
+		uint32_t frames;	// frames stepped
+		bool toppedOut;		// false if the game was stopped at the shape cap instead
+	};
+
+	// the spread of one number over the games of a run
+	struct Distribution
+	{
+		int64_t min{ 0 };
+		int64_t p10{ 0 };		// 10th percentile
+		int64_t median{ 0 };
+		int64_t p90{ 0 };		// 90th percentile
+		int64_t max{ 0 };
+		double mean{ 0.0 };
+	};
+
+	// what a run did
+	struct Report
+	{
+		int games{ 0 };
+		int threads{ 0 };
+		uint64_t shapes{ 0 };		// shapes locked, over every game
+		uint64_t frames{ 0 };		// frames stepped, over every game
+		int steals{ 0 };			// games a worker took from another worker's deque
+		double seconds{ 0.0 };		// wall clock time
+		double shapesPerSecond{ 0.0 };
+		double gamesPerSecond{ 0.0 };
+		Distribution scores;
+		Distribution rowsCleared;
+	};
+
+private:
+	int threads;					// the number of worker threads
+	PolicyFactory makePolicy;		// makes each worker's policy
+	std::vector<GameResult> results;	// the last run's games, in the order their seeds were dealt
+
+public:
+	// constructor
+	// assert a policy factory is given
+	// - param 1: a PolicyFactory, called once per worker thread for each run
+	// - param 2: an int, the number of worker threads (0 for one per core)
+	GameFarm(PolicyFactory makePolicy, int threads = 0);
+
+	// play a run of games and report on it
+	// assert games is positive
+	// - param 1: an int, the number of games
+	// - param 2: a uint64_t, the seed every game's seed is dealt from
+	// - param 3: an int, the most shapes to play in a game (0 for no cap)
+	// - return: a Report on the run
+	Report run(int games, uint64_t seed, int maxShapes = 0);
+
+	// get the games of the last run (in the order their seeds were dealt)
+	// - params: none
+	// - return: a vector of GameResults
+	const std::vector<GameResult> &getResults() const;
+
+	// get the number of worker threads
+	// - params: none
+	// - return: an int
+	int getThreads() const;
+
+	// work out the spread of some numbers
+	// - param 1: a vector of int64_ts (reordered)
+	// - return: a Distribution, all 0 for no numbers
+	static Distribution distribution(std::vector<int64_t> &values);
+
+private:
+	// play one game to the end (or the shape cap)
+	// - param 1: the InputPolicy to play with
+	// - param 2: a uint64_t, the game's seed
+	// - param 3: an int, the most shapes to play (0 for no cap)
+	// - return: a GameResult for the game
+	static GameResult playGame(InputPolicy &policy, uint64_t seed, int maxShapes);
+};
+
+#endif /* GAMEFARM_H */
@@ -0,0 +1,47 @@
+// A GameState is a snapshot of everything a TetrisEngine needs to carry on a game.
+//
+// It holds the board, the current/next shapes, score, level, cleared rows,
+// the randomizer (generator, bag/history and preview queue), the timers and the
+// rolling checksum - and nothing else: no listener, no window, no sound.  TetrisEngine::saveState() fills
+// one in and TetrisEngine::loadState() puts it back, after which the game plays
+// on exactly as it would have from the moment it was saved.  Anything that can be
+// worked out from the rest is left out: a shape is only its shape, rotation and
+// grid location (its blocks are looked up), and the ghost shape is dropped again
+// from the current shape by loadState().
+//
+// Every member is a plain value (no pointers, no heap memory, no virtual
+// functions), so a GameState is trivially copyable: it can be copied with
+// assignment or memcpy, stored in arrays, and cloned thousands of times a
+// second by tree searches, rollback and training environments.
+
+#ifndef GAMESTATE_H
+#define GAMESTATE_H
+
+#include <cstdint>
+#include <type_traits>
+#include "Gameboard.h"
+#include "GridTetromino.h"
+#include "Randomizer.h"
+
+struct GameState
+{
+	Gameboard board;				// the blocks on the board
+	GridTetromino currentShape;		// the falling shape
+	GridTetromino nextShape;		// the "on deck" shape
+	Gameboard::RowClear lockedRows;	// the rows completed by the last lock (removed next step)
+	Randomizer randomizer;			// the piece sequence
+	uint64_t seed;					// the seed the game's piece sequence started from
+	int64_t score;
+	uint32_t frame;					// frames stepped in the game
+	int32_t gravity;				// the rows per frame, in GRAVITY_UNITs
+	int32_t gravityProgress;		// gravity built up towards the next row
+	int32_t level;
+	int32_t cleared;				// rows cleared on the current level
+	bool gameOver;
+	bool shapePlacedSinceLastStep;	// a shape was locked and the next step must process it
+	uint64_t checksum;				// the rolling checksum (see TetrisEngine::getChecksum())
+};
+
+static_assert(std::is_trivially_copyable<GameState>::value, "GameState must be trivially copyable");
+
+#endif /* GAMESTATE_H */
@@ -1,7 +1,9 @@
 #include <iostream>
 #include <iomanip>
 #include <cassert>
+#include "Checksum.h"
 #include "Gameboard.h"
+#include "Zobrist.h"
 
 Gameboard::Gameboard()
 {
@@ -16,11 +18,9 @@ void Gameboard::empty()
 {
 	for (int i = 0; i < MAX_Y; i++)
 	{
-		for (int j = 0; j < MAX_X; j++)
-		{
-			grid[i][j] = -1;
-		}
+		fillRow(i, EMPTY_BLOCK);
 	}
+	updateColumnTops();
 }
 
 // print the grid contents to the console (for debugging purposes)
@@ -41,7 +41,7 @@ void Gameboard::printToConsole() const
 			}
 			else 
 			{
-				std::cout << std::setw(2) << grid[i][j];
+				std::cout << std::setw(2) << static_cast<int>(grid[i][j]);
 			}
 		}
 		std::cout << "\n";
@@ -74,7 +74,7 @@ void Gameboard::setContent(const Point &point, int val)
 {
 	if (isValidPoint(point))
 	{
-		grid[point.getY()][point.getX()] = val;
+		writeCell(point.getX(), point.getY(), val);
 	}
 	else
 	{
@@ -91,7 +91,7 @@ void Gameboard::setContent(int  x, int  y, int val)
 {
 	if (isValidPoint(x, y))
 	{
-		grid[y][x] = val;
+		writeCell(x, y, val);
 	}
 	else
 	{
@@ -109,7 +109,7 @@ void Gameboard::setContent(std::vector<Point>  &blocks, int val)
 	{
 		if (isValidPoint(block))
 		{
-			grid[block.getY()][block.getX()] = val;
+			writeCell(block.getX(), block.getY(), val);
 		}
 	}
 }
@@ -127,7 +127,7 @@ bool Gameboard::areAllLocsEmpty(std::vector<Point> &checks) const
 	{
 		if (isValidPoint(check))
 		{
-			if (getContent(check) != -1)
+			if (rowMasks[check.getY()] & (1 << check.getX()))
 			{
 				return false;
 			}
@@ -136,30 +136,279 @@ bool Gameboard::areAllLocsEmpty(std::vector<Point> &checks) const
 	return true;
 }
 
+// get the occupancy mask of a row (bit x set when column x holds content)
+//   Rows above the board (y < 0) read as empty and rows at or below the floor
+//   (y >= MAX_Y) read as full, so callers can test pieces that hang off the board.
+// - param 1: an int representing the row index
+// - return: a uint16_t occupancy mask for the row
+uint16_t Gameboard::getRowMask(int rowIndex) const
+{
+	if (rowIndex < 0)
+	{
+		return 0;
+	}
+	if (rowIndex >= MAX_Y)
+	{
+		return FULL_ROW_MASK;
+	}
+	return rowMasks[rowIndex];
+}
+
+// get the occupancy masks of every row at once (for code that scans the whole board)
+// - params: none
+// - return: a pointer to the MAX_Y row masks, top row first
+const uint16_t *Gameboard::getRowMasks() const
+{
+	return rowMasks;
+}
+
+// get the checksum of the board's content (see Checksum.h)
+//   two boards with the same content always have the same checksum
+// - params: none
+// - return: a uint64_t
+uint64_t Gameboard::getChecksum() const
+{
+	// (worked out here rather than kept by every write: TetrisEngine reads it once
+	//  per locked shape, while bot searches write and copy boards millions of times
+	//  a second)
+	uint64_t checksum = 0;
+	for (int y = 0; y < MAX_Y; y++)
+	{
+		if (rowMasks[y] == 0)
+		{
+			continue;
+		}
+		uint64_t rowKey = 0;
+		for (int x = 0; x < MAX_X; x++)
+		{
+			if (rowMasks[y] & (1 << x))
+			{
+				rowKey ^= Checksum::cellKey(x, grid[y][x]);
+			}
+		}
+		checksum += rowKey * Checksum::rowWeight(y);
+	}
+	return checksum;
+}
+
+// get the Zobrist key of the board's occupancy (see Zobrist.h)
+//   two boards with the same cells filled always have the same key, whatever the colors
+// - params: none
+// - return: a uint64_t, 0 for an empty board
+uint64_t Gameboard::getZobristKey() const
+{
+	return zobristKey;
+}
+
+// get the Zobrist key the board would have after lockBlocks(), without locking
+//   (lets a search look a placement up before paying for a copy of the board)
+// - param 1: a BlockList representing the block locations
+// - param 2: an int, set to the number of rows the blocks would complete
+// - return: a uint64_t, the key after the lock (before any completed rows are removed)
+uint64_t Gameboard::getZobristKeyAfterLock(const BlockList &blocks, int &rowsCompleted) const
+{
+	uint64_t key = zobristKey;
+	uint16_t added[MAX_Y]{};
+	uint32_t touched = 0;
+	for (auto &block : blocks)
+	{
+		if (isValidPoint(block))
+		{
+			uint16_t bit = static_cast<uint16_t>(1 << block.getX());
+			if (!((rowMasks[block.getY()] | added[block.getY()]) & bit))
+			{
+				key ^= Zobrist::KEYS.cells[block.getY()][block.getX()];
+			}
+			added[block.getY()] |= bit;
+			touched |= (1u << block.getY());
+		}
+	}
+
+	rowsCompleted = 0;
+	for (int y = 0; touched != 0; y++, touched >>= 1)
+	{
+		if ((touched & 1u) && (rowMasks[y] | added[y]) == FULL_ROW_MASK)
+		{
+			rowsCompleted++;
+		}
+	}
+	return key;
+}
+
+// Determine if a set of blocks could be placed at an offset.
+//   Each block moved by the offset must be inside the left, right and bottom
+//   borders and on an empty cell.  Blocks above the top of the board are allowed
+//   (shapes drop in from above).  The blocks themselves are not changed, so a
+//   move can be tested without building a moved copy of the shape.
+// - param 1: a BlockList representing block locations
+// - param 2: an int, the x offset to test at
+// - param 3: an int, the y offset to test at
+// - return: true if every offset block is inside the borders and empty
+bool Gameboard::canPlace(const BlockList &blocks, int xOffset, int yOffset) const
+{
+	for (auto &block : blocks)
+	{
+		int x = block.getX() + xOffset;
+		if (x < 0 || x >= MAX_X)
+		{
+			return false;
+		}
+		// getRowMask() treats rows below the floor as full
+		if (getRowMask(block.getY() + yOffset) & (1 << x))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Determine if a shape given as row masks could be placed on the board.
+//   The cheapest legality test: one shift and AND per row of the shape.
+//   Bit c of pieceRows[r] is a block at column (left + c), row (top + r).
+//   The same border rules as canPlace() apply (the top border is ignored).
+// - param 1: an array of uint16_t masks, one per row of the shape
+// - param 2: an int, the number of rows in the shape
+// - param 3: an int, the width of the shape (columns spanned by the masks)
+// - param 4: an int, the board column of bit 0 of the masks
+// - param 5: an int, the board row of pieceRows[0]
+// - return: true if the shape is inside the borders and on empty cells
+bool Gameboard::canPlaceRows(const uint16_t *pieceRows, int rowCount, int width, int left, int top) const
+{
+	if (left < 0 || left + width > MAX_X)
+	{
+		return false;
+	}
+	for (int r = 0; r < rowCount; r++)
+	{
+		if (getRowMask(top + r) & (pieceRows[r] << left))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// get the height of a column's stack (from the floor to its highest occupied cell)
+// - param 1: an int for X (column)
+// - return: an int, 0 for an empty column up to MAX_Y for a column filled to the top
+int Gameboard::getColumnHeight(int x) const
+{
+	assert((0 <= x && x < MAX_X) && "Column not on board");
+	return MAX_Y - columnTops[x];
+}
+
+// determine how far a set of blocks can fall before it lands on content or the floor.
+//   When every block is above the skyline of its column the distance comes straight
+//   from the column tops. Blocks tucked under an overhang fall back to stepping
+//   down the row masks.
+//   All points must have a valid x (column); y may be above the board.
+// - param 1: a BlockList representing block locations
+// - return: the number of rows the blocks can move down,
+//           or -1 if they already overlap content or the floor
+int Gameboard::getDropDistance(const BlockList &blocks) const
+{
+	int distance = MAX_Y;
+	bool aboveSkyline = true;
+	for (auto &block : blocks)
+	{
+		assert((0 <= block.getX() && block.getX() < MAX_X) && "Column not on board");
+		int top = columnTops[block.getX()];
+		if (block.getY() >= top)
+		{
+			aboveSkyline = false;
+			break;
+		}
+		if (top - 1 - block.getY() < distance)
+		{
+			distance = top - 1 - block.getY();
+		}
+	}
+	if (aboveSkyline)
+	{
+		return distance;
+	}
+
+	// at least one block is under an overhang - step down through the masks
+	if (!canPlace(blocks, 0, 0))
+	{
+		return -1;
+	}
+	distance = 0;
+	while (canPlace(blocks, 0, distance + 1))
+	{
+		distance++;
+	}
+	return distance;
+}
+
+// Lock a set of blocks onto the board and report which rows they completed.
+//   Sets the content of each (valid) block, then checks the fill count of
+//   only the rows those blocks touched - no other row can have become full.
+// - param 1: a BlockList representing the locked block locations
+// - param 2: an int representing the content we want to set.
+// - return: a RowClear holding the completed rows among the touched rows
+Gameboard::RowClear Gameboard::lockBlocks(const BlockList &blocks, int val)
+{
+	uint32_t touched = 0;
+	for (auto &block : blocks)
+	{
+		if (isValidPoint(block))
+		{
+			writeCell(block.getX(), block.getY(), val);
+			touched |= (1u << block.getY());
+		}
+	}
+
+	RowClear completed;
+	for (int y = 0; touched != 0; y++, touched >>= 1)
+	{
+		if ((touched & 1u) && rowFill[y] == MAX_X)
+		{
+			completed.rowIndices[completed.count++] = y;
+		}
+	}
+	return completed;
+}
+
 // Remove all completed rows from the board
-//   use getCompletedRowIndices() and removeRows() 
+//   use collapseCompletedRows() 
 // - params: none
 // - return: the count of completed rows removed
 int Gameboard::removeCompletedRows()
 {
-	std::vector<int> rmRows;
+	return collapseCompletedRows().count;
+}
+
+// Remove all completed rows from the board in a single pass.
+//   The completed rows are found from the row masks, then every surviving
+//   row is moved straight to its final position (see collapseRows()).
+// - params: none
+// - return: a RowClear holding the count and indices of the rows removed
+Gameboard::RowClear Gameboard::collapseCompletedRows()
+{
+	RowClear cleared;
+	uint32_t removeMask = 0;
 	for (int i = 0; i < MAX_Y; i++)
 	{
-		if (isRowCompleted(i))
+		if (rowMasks[i] == FULL_ROW_MASK)
 		{
-			rmRows.push_back(i);
+			cleared.rowIndices[cleared.count++] = i;
+			removeMask |= (1u << i);
 		}
 	}
-	removeRows(rmRows);
-	return rmRows.size();
+	if (removeMask != 0)
+	{
+		collapseRows(removeMask);
+	}
+	return cleared;
 }
 
 // A getter for the spawn location
 // - params: none
-// - returns: a Point, representing our private spawnLoc
+// - returns: a Point, representing SPAWN_X, SPAWN_Y
 Point Gameboard::getSpawnLoc() const
 {
-	return spawnLoc;
+	return Point(SPAWN_X, SPAWN_Y);
 }
 
 
@@ -168,14 +417,7 @@ Point Gameboard::getSpawnLoc() const
 // - return: true if the point is a valid grid location, false otherwise
 bool Gameboard::isValidPoint(Point const &point) const
 {
-	if ((0 <= point.getX() && point.getX() <= MAX_X) && (0 <= point.getY() && point.getY() <= MAX_Y))
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
+	return isValidPoint(point.getX(), point.getY());
 }
 
 // Determine if a given XY is a valid grid location
@@ -184,7 +426,7 @@ bool Gameboard::isValidPoint(Point const &point) const
 // - return: true if the x,y is a valid grid location, false otherwise
 bool Gameboard::isValidPoint(int x, int y) const
 {
-	if ((0 <= x  && x <= MAX_X) && (0 <= y && y <= MAX_Y))
+	if ((0 <= x  && x < MAX_X) && (0 <= y && y < MAX_Y))
 	{
 		return true;
 	}
@@ -194,22 +436,88 @@ bool Gameboard::isValidPoint(int x, int y) const
 	}
 }
 
-// return a bool indicating if a given row is full (no EMPTY_BLOCK in the row)
-// assert the row index is valid
-// - param 1: an int representing the row index we want to test
-// - return: bool representing if the row is completed
-bool Gameboard::isRowCompleted(int rowIndex) const
+// recompute the skyline (columnTops) for every column from the row masks.
+// - params: none
+// - return: nothing
+void Gameboard::updateColumnTops()
+{
+	for (int x = 0; x < MAX_X; x++)
+	{
+		columnTops[x] = MAX_Y;
+	}
+	// walk down from the top; a column's top is the first row that sets its bit
+	uint16_t seen = 0;
+	for (int y = 0; y < MAX_Y && seen != FULL_ROW_MASK; y++)
+	{
+		uint16_t fresh = rowMasks[y] & ~seen;
+		for (int x = 0; fresh != 0; x++, fresh >>= 1)
+		{
+			if (fresh & 1)
+			{
+				columnTops[x] = y;
+			}
+		}
+		seen |= rowMasks[y];
+	}
+}
+
+// rescan a single column for its highest occupied cell, starting at a given row.
+// - param 1: an int for X (column)
+// - param 2: an int for the first row to look at
+// - return: nothing
+void Gameboard::rescanColumnTop(int x, int fromRow)
 {
-	bool check{ true };
+	int y = fromRow;
+	while (y < MAX_Y && !(rowMasks[y] & (1 << x)))
+	{
+		y++;
+	}
+	columnTops[x] = y;
+}
 
-	for (int i = 0; i < MAX_X; i++)
+// write content into a single (valid) cell, updating both the color plane
+// and the occupancy mask of its row.
+// - param 1: an int for X (column)
+// - param 2: an int for Y (row)
+// - param 3: an int representing the content
+// - return: nothing
+void Gameboard::writeCell(int x, int y, int val)
+{
+	grid[y][x] = static_cast<int8_t>(val);
+	bool wasOccupied = (rowMasks[y] & (1 << x)) != 0;
+	if (val == EMPTY_BLOCK)
 	{
-		if (grid[rowIndex][i] == -1)
+		if (wasOccupied)
 		{
-			check = false;
+			zobristKey ^= Zobrist::KEYS.cells[y][x];
+			rowMasks[y] &= ~(1 << x);
+			rowFill[y]--;
+			if (columnTops[x] == y)
+			{
+				rescanColumnTop(x, y + 1);
+			}
+		}
+	}
+	else if (!wasOccupied)
+	{
+		zobristKey ^= Zobrist::KEYS.cells[y][x];
+		rowMasks[y] |= (1 << x);
+		rowFill[y]++;
+		if (y < columnTops[x])
+		{
+			columnTops[x] = y;
 		}
 	}
-	return check;
+}
+
+// return a bool indicating if a given row is full (no EMPTY_BLOCK in the row)
+// assert the row index is valid
+// - param 1: an int representing the row index we want to test
+// - return: bool representing if the row is completed
+bool Gameboard::isRowCompleted(int rowIndex) const
+{
+	assert((rowIndex < MAX_Y && 0 <= rowIndex) && "Row not on board");
+	return rowMasks[rowIndex] == FULL_ROW_MASK;
 }
 
 // fill a given grid row with specified content
@@ -220,7 +528,24 @@ void Gameboard::fillRow(int rowIndex, int content)
 {
 	for (int i = 0; i < MAX_X; i++)
 	{
-		grid[rowIndex][i] = content;
+		grid[rowIndex][i] = static_cast<int8_t>(content);
+	}
+	uint16_t oldMask = rowMasks[rowIndex];
+	rowMasks[rowIndex] = (content == EMPTY_BLOCK) ? 0 : FULL_ROW_MASK;
+	flipZobristKey(rowIndex, oldMask ^ rowMasks[rowIndex]);
+	rowFill[rowIndex] = (content == EMPTY_BLOCK) ? 0 : MAX_X;
+
+	// keep the skyline in step
+	for (int x = 0; x < MAX_X; x++)
+	{
+		if (content != EMPTY_BLOCK && rowIndex < columnTops[x])
+		{
+			columnTops[x] = rowIndex;
+		}
+		else if (content == EMPTY_BLOCK && (oldMask & (1 << x)) && columnTops[x] == rowIndex)
+		{
+			rescanColumnTop(x, rowIndex + 1);
+		}
 	}
 }
 
@@ -233,11 +558,10 @@ std::vector<int> Gameboard::getCompletedRowIndices() const
 	std::vector<int> completed{};
 	for (int i = 0; i < MAX_Y; i++)
 	{
-		if (isRowCompleted(i))
+		if (rowMasks[i] == FULL_ROW_MASK)
 		{
 			completed.push_back(i);
 		}
-		
 	}
 	return completed;
 }
@@ -248,16 +572,39 @@ std::vector<int> Gameboard::getCompletedRowIndices() const
 // - return: nothing
 void Gameboard::copyRowIntoRow(int source, int target)
 {
-	//Point sPoint{ MAX_X, source };
-	//Point tPoint{ MAX_X, target };
-	//if (isValidPoint(sPoint) && isValidPoint(tPoint))
-	//{
-		int rowCopy[1][MAX_X]{ 0 };
-		for (int j = 0; j < MAX_X; j++)
+	copyRowContent(source, target);
+	updateColumnTops();
+}
+
+// copy a source row's content, mask and fill count into a target row
+// without touching the skyline (callers must update it afterwards).
+// - param 1: an int representing the source row index
+// - param 2: an int representing the target row index
+// - return: nothing
+void Gameboard::copyRowContent(int source, int target)
+{
+	for (int j = 0; j < MAX_X; j++)
+	{
+		grid[target][j] = grid[source][j];
+	}
+	flipZobristKey(target, rowMasks[target] ^ rowMasks[source]);
+	rowMasks[target] = rowMasks[source];
+	rowFill[target] = rowFill[source];
+}
+
+// update the Zobrist key for cells of a row that were filled or emptied
+// - param 1: an int representing the row index
+// - param 2: a uint16_t, a mask of the columns that changed
+// - return: nothing
+void Gameboard::flipZobristKey(int rowIndex, uint16_t changed)
+{
+	for (int x = 0; changed != 0; x++, changed >>= 1)
+	{
+		if (changed & 1)
 		{
-			grid[target][j] = grid[source][j];
+			zobristKey ^= Zobrist::KEYS.cells[rowIndex][x];
 		}
-	//}
+	}
 }
 
 // In gameplay, when a full row is completed (filled with content)
@@ -265,33 +612,79 @@ void Gameboard::copyRowIntoRow(int source, int target)
 // but the content from the row above it is copied into it.
 // This continues all the way up the grid until the first row is copied
 // into the second row.  Finally, the first row is filled with EMPTY_BLOCK
-// Given a row index:
 //   1) Assert the row index is valid
-//   2) Starting at rowIndex, copy each row above the removed
-//     row "one-row-downwards" in the grid.
-//     (loop from y=rowIndex-1 down to 0, and copyRowIntoRow(y, y+1)).
-//   3) call fillRow() on the first row (and place EMPTY_BLOCKs in it).
+//   2) collapseRows() with just this row marked for removal.
 // - param 1: an int representing a row index
 // - return: nothing
 void Gameboard::removeRow(int rowIndex)
 {
-	assert((rowIndex <= MAX_Y && 0 <= rowIndex) && "Row not on board");
-	for (int i = rowIndex-1; i >= 0; i--)
-	{
-		copyRowIntoRow(i, i + 1);
-	}
-	fillRow(0, -1);
-	
+	assert((rowIndex < MAX_Y && 0 <= rowIndex) && "Row not on board");
+	collapseRows(1u << rowIndex);
 }
 
 // given a vector of row indices, remove them. 
-//   Iterate through the vector, call removeRow() on each row index. 
+//   The indices refer to the board as it is before any row is removed.
+//   Mark each row in a removal mask and collapseRows() once.
 // - param 1: a vector of integers representing row indices we want to remove
 // - return: nothing
 void Gameboard::removeRows(std::vector<int> &rowIndices)
 {
+	uint32_t removeMask = 0;
 	for (auto &row : rowIndices)
 	{
-		removeRow(row);
+		assert((row < MAX_Y && 0 <= row) && "Row not on board");
+		removeMask |= (1u << row);
+	}
+	if (removeMask != 0)
+	{
+		collapseRows(removeMask);
 	}
-}
\ No newline at end of file
+}
+
+// remove the rows reported by lockBlocks() (or collapseCompletedRows()).
+//   Mark each row in a removal mask and collapseRows() once.
+// - param 1: a RowClear of row indices we want to remove
+// - return: nothing
+void Gameboard::removeRows(const RowClear &rowClear)
+{
+	uint32_t removeMask = 0;
+	for (int i = 0; i < rowClear.count; i++)
+	{
+		removeMask |= (1u << rowClear.rowIndices[i]);
+	}
+	if (removeMask != 0)
+	{
+		collapseRows(removeMask);
+	}
+}
+
+// remove a set of rows in a single compaction pass.
+//   Walk the board from the lowest removed row to the top, copying each
+//   surviving row directly into its final position, then fill the rows
+//   left vacated at the top with EMPTY_BLOCK.
+//   Each surviving row is copied at most once, however many rows are removed.
+// - param 1: a mask with bit y set for every row index y to remove
+// - return: nothing
+void Gameboard::collapseRows(uint32_t removeMask)
+{
+	// rows below the lowest removed row don't move, so start there
+	int target = MAX_Y - 1;
+	while (target >= 0 && !(removeMask & (1u << target)))
+	{
+		target--;
+	}
+	for (int source = target; source >= 0; source--)
+	{
+		if (!(removeMask & (1u << source)))
+		{
+			copyRowContent(source, target);
+			target--;
+		}
+	}
+	for (int i = target; i >= 0; i--)
+	{
+		fillRow(i, EMPTY_BLOCK);
+	}
+	// the skyline moved with the rows, so rebuild it once from the masks
+	updateColumnTops();
+}
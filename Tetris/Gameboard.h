@@ -43,6 +43,19 @@
 //		We are using abstraction to hide the details of implementation inside the class.
 //      If we call member functions that are public (eg : setContent(x, y, content))
 //      we can treat X and Y as we normally would,
+// - Alongside the grid (which holds colors) the board keeps an occupancy bitboard:
+//      one 16-bit mask per row where bit x is set when column x holds content.
+//      Collision and row-completion tests only look at the masks, so they become
+//      a handful of ANDs and compares instead of cell-by-cell scans.
+// - The board also keeps a skyline: the row of the highest occupied cell in each
+//      column. It lets a drop distance be read off directly whenever a piece is
+//      above the stack, instead of stepping the piece down one row at a time.
+// - And it gives a checksum of the content (occupancy and colors) for spotting
+//      games that drift apart: the weighted sum of a key per row, worked out from
+//      the masks and the grid when it is asked for (see Checksum.h).
+// - And a Zobrist key of the occupancy, for bot searches to recognise a board they
+//      have seen before: the XOR of the keys of the filled cells, updated by every
+//      write that fills or empties a cell (see Zobrist.h).
 //
 //  [expected .cpp size: ~ 225 lines (including method comments)]
 
@@ -51,26 +64,50 @@
 #define GAMEBOARD_H
 
 #include <vector>
+#include <cstdint>
 #include "Point.h"
+#include "BlockList.h"
 
 class Gameboard
 {
-	friend int main();
 	friend class TestSuite;
 public:
 	// CONSTANTS
 	static const int MAX_X = 10;		// gameboard x dimension
 	static const int MAX_Y = 19;		// gameboard y dimension
 	static const int EMPTY_BLOCK = -1;	// contents of an empty block
+	static const uint16_t FULL_ROW_MASK = (1 << MAX_X) - 1;	// row mask with every column occupied
+	static const int SPAWN_X = MAX_X / 2;	// the gameboard offset to spawn a new tetromino at
+	static const int SPAWN_Y = 0;
+
+	// the result of collapsing completed rows:
+	//   the number of rows removed, and their indices (top to bottom) as they
+	//   were on the board before the collapse.
+	struct RowClear
+	{
+		int8_t count{ 0 };
+		int8_t rowIndices[MAX_Y];
+	};
 
 private:
 	// MEMBER VARIABLES -------------------------------------------------
 
-	// the gameboard - a grid of X and Y offsets.  
+	// the gameboard - a grid of X and Y offsets holding the content (color plane).
 	//  ([0][0] is top left, [MAX_Y-1][MAX_X-1] is bottom right) 
-	int grid[MAX_Y][MAX_X];
-	// the gameboard offset to spawn a new tetromino at.
-	const Point spawnLoc{ MAX_X / 2, 0 };
+	int8_t grid[MAX_Y][MAX_X]{};
+	// the occupancy bitboard - bit x of rowMasks[y] is set when grid[y][x] != EMPTY_BLOCK.
+	//  every write to grid must keep this in step (see writeCell()).
+	uint16_t rowMasks[MAX_Y]{};
+	// the number of occupied cells in each row, maintained incrementally alongside rowMasks.
+	int8_t rowFill[MAX_Y]{};
+	// the skyline - the row index of the highest occupied cell in each column
+	//  (MAX_Y when the column is empty).
+	int8_t columnTops[MAX_X]{};
+	// the Zobrist key - the XOR of Zobrist::KEYS.cells over the occupied cells,
+	//  maintained incrementally alongside rowMasks.
+	uint64_t zobristKey{ 0 };
+	// (every member is a plain array, so a Gameboard can be copied and assigned
+	//  with a memcpy - see GameState.h)
 	
 public:	
 	// METHODS -------------------------------------------------
@@ -133,15 +170,105 @@ public:
 	// - return: true if the content at ALL VALID points is EMPTY_BLOCK, false otherwise
 	bool areAllLocsEmpty(std::vector<Point> &checks) const; 
 
+	// get the occupancy mask of a row (bit x set when column x holds content)
+	//   Rows above the board (y < 0) read as empty and rows at or below the floor
+	//   (y >= MAX_Y) read as full, so callers can test pieces that hang off the board.
+	// - param 1: an int representing the row index
+	// - return: a uint16_t occupancy mask for the row
+	uint16_t getRowMask(int rowIndex) const;
+
+	// get the occupancy masks of every row at once (for code that scans the whole board)
+	// - params: none
+	// - return: a pointer to the MAX_Y row masks, top row first
+	const uint16_t *getRowMasks() const;
+
+	// get the checksum of the board's content (see Checksum.h)
+	//   two boards with the same content always have the same checksum
+	// - params: none
+	// - return: a uint64_t
+	uint64_t getChecksum() const;
+
+	// get the Zobrist key of the board's occupancy (see Zobrist.h)
+	//   two boards with the same cells filled always have the same key, whatever the colors
+	// - params: none
+	// - return: a uint64_t, 0 for an empty board
+	uint64_t getZobristKey() const;
+
+	// get the Zobrist key the board would have after lockBlocks(), without locking
+	//   (lets a search look a placement up before paying for a copy of the board)
+	// - param 1: a BlockList representing the block locations
+	// - param 2: an int, set to the number of rows the blocks would complete
+	// - return: a uint64_t, the key after the lock (before any completed rows are removed)
+	uint64_t getZobristKeyAfterLock(const BlockList &blocks, int &rowsCompleted) const;
+
+	// Determine if a set of blocks could be placed at an offset.
+	//   Each block moved by the offset must be inside the left, right and bottom
+	//   borders and on an empty cell.  Blocks above the top of the board are allowed
+	//   (shapes drop in from above).  The blocks themselves are not changed, so a
+	//   move can be tested without building a moved copy of the shape.
+	// - param 1: a BlockList representing block locations
+	// - param 2: an int, the x offset to test at
+	// - param 3: an int, the y offset to test at
+	// - return: true if every offset block is inside the borders and empty
+	bool canPlace(const BlockList &blocks, int xOffset, int yOffset) const;
+
+	// Determine if a shape given as row masks could be placed on the board.
+	//   The cheapest legality test: one shift and AND per row of the shape.
+	//   Bit c of pieceRows[r] is a block at column (left + c), row (top + r).
+	//   The same border rules as canPlace() apply (the top border is ignored).
+	// - param 1: an array of uint16_t masks, one per row of the shape
+	// - param 2: an int, the number of rows in the shape
+	// - param 3: an int, the width of the shape (columns spanned by the masks)
+	// - param 4: an int, the board column of bit 0 of the masks
+	// - param 5: an int, the board row of pieceRows[0]
+	// - return: true if the shape is inside the borders and on empty cells
+	bool canPlaceRows(const uint16_t *pieceRows, int rowCount, int width, int left, int top) const;
+
+	// get the height of a column's stack (from the floor to its highest occupied cell)
+	// - param 1: an int for X (column)
+	// - return: an int, 0 for an empty column up to MAX_Y for a column filled to the top
+	int getColumnHeight(int x) const;
+
+	// determine how far a set of blocks can fall before it lands on content or the floor.
+	//   When every block is above the skyline of its column the distance comes straight
+	//   from the column tops. Blocks tucked under an overhang fall back to stepping
+	//   down the row masks.
+	//   All points must have a valid x (column); y may be above the board.
+	// - param 1: a BlockList representing block locations
+	// - return: the number of rows the blocks can move down,
+	//           or -1 if they already overlap content or the floor
+	int getDropDistance(const BlockList &blocks) const;
+
+	// Lock a set of blocks onto the board and report which rows they completed.
+	//   Sets the content of each (valid) block, then checks the fill count of
+	//   only the rows those blocks touched - no other row can have become full.
+	// - param 1: a BlockList representing the locked block locations
+	// - param 2: an int representing the content we want to set.
+	// - return: a RowClear holding the completed rows among the touched rows
+	RowClear lockBlocks(const BlockList &blocks, int val);
+
+	// remove the rows reported by lockBlocks() (or collapseCompletedRows()).
+	//   Mark each row in a removal mask and collapseRows() once.
+	// - param 1: a RowClear of row indices we want to remove
+	// - return: nothing
+	void removeRows(const RowClear &rowClear);
+
 	// Remove all completed rows from the board
-	//   use getCompletedRowIndices() and removeRows() 
+	//   use collapseCompletedRows() 
 	// - params: none
 	// - return: the count of completed rows removed
 	int removeCompletedRows();
 
+	// Remove all completed rows from the board in a single pass.
+	//   The completed rows are found from the row masks, then every surviving
+	//   row is moved straight to its final position (see collapseRows()).
+	// - params: none
+	// - return: a RowClear holding the count and indices of the rows removed
+	RowClear collapseCompletedRows();
+
 	// A getter for the spawn location
 	// - params: none
-	// - returns: a Point, representing our private spawnLoc
+	// - returns: a Point, representing SPAWN_X, SPAWN_Y
 	Point getSpawnLoc() const;
 
 private:  // This is commented out to allow us to test. 
@@ -157,6 +284,38 @@ private:  // This is commented out to allow us to test.
 	// - return: true if the x,y is a valid grid location, false otherwise
 	bool isValidPoint(int x, int y) const;
 
+	// recompute the skyline (columnTops) for every column from the row masks.
+	// - params: none
+	// - return: nothing
+	void updateColumnTops();
+
+	// rescan a single column for its highest occupied cell, starting at a given row.
+	// - param 1: an int for X (column)
+	// - param 2: an int for the first row to look at
+	// - return: nothing
+	void rescanColumnTop(int x, int fromRow);
+
+	// copy a source row's content, mask and fill count into a target row
+	// without touching the skyline (callers must update it afterwards).
+	// - param 1: an int representing the source row index
+	// - param 2: an int representing the target row index
+	// - return: nothing
+	void copyRowContent(int source, int target);
+
+	// update the Zobrist key for cells of a row that were filled or emptied
+	// - param 1: an int representing the row index
+	// - param 2: a uint16_t, a mask of the columns that changed
+	// - return: nothing
+	void flipZobristKey(int rowIndex, uint16_t changed);
+
+	// write content into a single (valid) cell, updating both the color plane
+	// and the occupancy mask of its row.
+	// - param 1: an int for X (column)
+	// - param 2: an int for Y (row)
+	// - param 3: an int representing the content
+	// - return: nothing
+	void writeCell(int x, int y, int val);
+
 	// return a bool indicating if a given row is full (no EMPTY_BLOCK in the row)
 	// assert the row index is valid
 	// - param 1: an int representing the row index we want to test
@@ -186,21 +345,27 @@ private:  // This is commented out to allow us to test.
 	// but the content from the row above it is copied into it.
 	// This continues all the way up the grid until the first row is copied
 	// into the second row.  Finally, the first row is filled with EMPTY_BLOCK
-	// Given a row index:
 	//   1) Assert the row index is valid
-	//   2) Starting at rowIndex, copy each row above the removed
-	//     row "one-row-downwards" in the grid.
-	//     (loop from y=rowIndex-1 down to 0, and copyRowIntoRow(y, y+1)).
-	//   3) call fillRow() on the first row (and place EMPTY_BLOCKs in it).
+	//   2) collapseRows() with just this row marked for removal.
 	// - param 1: an int representing a row index
 	// - return: nothing
 	void removeRow(int rowIndex);
 
 	// given a vector of row indices, remove them. 
-	//   Iterate through the vector, call removeRow() on each row index. 
+	//   The indices refer to the board as it is before any row is removed.
+	//   Mark each row in a removal mask and collapseRows() once.
 	// - param 1: a vector of integers representing row indices we want to remove
 	// - return: nothing
 	void removeRows(std::vector<int> &rowIndices);
+
+	// remove a set of rows in a single compaction pass.
+	//   Walk the board from the lowest removed row to the top, copying each
+	//   surviving row directly into its final position, then fill the rows
+	//   left vacated at the top with EMPTY_BLOCK.
+	//   Each surviving row is copied at most once, however many rows are removed.
+	// - param 1: a mask with bit y set for every row index y to remove
+	// - return: nothing
+	void collapseRows(uint32_t removeMask);
 };
 
 #endif /* GAMEBOARD_H */
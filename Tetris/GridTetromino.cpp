@@ -43,17 +43,16 @@ void GridTetromino::move(int xOffset, int yOffset)
 	gridLoc.setXY(gridLoc.getX() + xOffset, gridLoc.getY() + yOffset);
 }
 
-// Build and return a vector of Points to represent our inherited
-// blockLocs vector mapped to the gridLoc of this object instance.
-// You will need to provide this class access to blockLocs (from the Tetromino class).
-// eg: if we have a Point [x,y] in our vector,
+// Build and return a list of Points to represent our inherited
+// block locations (getBlockLocs()) mapped to the gridLoc of this object instance.
+// eg: if we have a Point [x,y] in our list,
 // and our gridLoc is [5,6] the mapped Point would be [5+x,6+y].
 // params: none:
-// return: a vector of Point objects.
-std::vector<Point> GridTetromino::getBlockLocsMappedToGrid() const
+// return: a BlockList of Point objects (inline storage, no heap allocation).
+BlockList GridTetromino::getBlockLocsMappedToGrid() const
 {
-	std::vector<Point> new_points{};
-	for (auto& bloc : blockLocs)
+	BlockList new_points{};
+	for (auto& bloc : getBlockLocs())
 	{
 		new_points.push_back({ bloc.getX() + gridLoc.getX(), bloc.getY() + gridLoc.getY() });
 	};
@@ -51,14 +51,13 @@ public:
 	// - return: nothing
 	void move(int xOffset, int yOffset);	
 
-	// Build and return a vector of Points to represent our inherited
-	// blockLocs vector mapped to the gridLoc of this object instance.
-	// You will need to provide this class access to blockLocs (from the Tetromino class).
-	// eg: if we have a Point [x,y] in our vector,
+	// Build and return a list of Points to represent our inherited
+	// block locations (getBlockLocs()) mapped to the gridLoc of this object instance.
+	// eg: if we have a Point [x,y] in our list,
 	// and our gridLoc is [5,6] the mapped Point would be [5+x,6+y].
 	// params: none:
-	// return: a vector of Point objects.
-	std::vector<Point> getBlockLocsMappedToGrid() const;
+	// return: a BlockList of Point objects (inline storage, no heap allocation).
+	BlockList getBlockLocsMappedToGrid() const;
 
 };
 
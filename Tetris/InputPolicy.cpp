@@ -0,0 +1,172 @@
+#include <cassert>
+#include "InputPolicy.h"
+#include "TetrominoTables.h"
+#include "WallKicks.h"
+
+static const int RANDOM_ROLLS = 16;		// RandomPolicy gives each input 1 chance in this many per frame
+static const uint64_t RANDOM_SALT = 0x9E3779B97F4A7C15ull;	// keeps RandomPolicy's choices apart from the game's shapes
+
+// constructor
+//   the letters are L (move left), R (move right), D (soft drop), U (rotate),
+//   H (hard drop) and . (no input), as on the keyboard
+// assert the script is not empty and every letter is one of those
+// - param 1: a string, the script
+ScriptedPolicy::ScriptedPolicy(const std::string &script)
+	:script(script)
+{
+	assert(!script.empty() && script.find_first_not_of("LRDUH.") == std::string::npos &&
+		"ScriptedPolicy - a script is made of the letters LRDUH.");
+}
+
+void ScriptedPolicy::newGame(uint64_t seed)
+{
+	position = 0;
+}
+
+int ScriptedPolicy::chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs)
+{
+	char letter = script[position];
+	position = (position + 1) % script.size();
+	switch (letter)
+	{
+	case 'L':
+		inputs[0] = TetrisEngine::MOVE_LEFT;
+		return 1;
+	case 'R':
+		inputs[0] = TetrisEngine::MOVE_RIGHT;
+		return 1;
+	case 'D':
+		inputs[0] = TetrisEngine::SOFT_DROP;
+		return 1;
+	case 'U':
+		inputs[0] = TetrisEngine::ROTATE;
+		return 1;
+	case 'H':
+		inputs[0] = TetrisEngine::HARD_DROP;
+		return 1;
+	}
+	return 0;
+}
+
+// constructor
+RandomPolicy::RandomPolicy()
+	:random(0, Randomizer::UNIFORM)
+{
+}
+
+void RandomPolicy::newGame(uint64_t seed)
+{
+	random.reset(seed ^ RANDOM_SALT);
+}
+
+int RandomPolicy::chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs)
+{
+	int roll = random.nextBelow(RANDOM_ROLLS);
+	if (roll > TetrisEngine::HARD_DROP)
+	{
+		return 0;
+	}
+	inputs[0] = static_cast<TetrisEngine::Input>(roll);
+	return 1;
+}
+
+// constructor - play with the default Weights
+BotPolicy::BotPolicy()
+{
+}
+
+// constructor
+// - param 1: the Weights to play with (eg. a bot version being evaluated)
+BotPolicy::BotPolicy(const Weights &weights)
+	:weights(weights)
+{
+}
+
+// choose a rotation and column for the current shape, and give every input to
+// get it there at once: the rotations, the moves and a hard drop
+//   Each rotation is tried the way the engine would rotate (with wall kicks),
+//   then each column the rotated shape can slide to, and the shape is dropped
+//   and locked on a copy of the board to score it.
+int BotPolicy::chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs)
+{
+	if (engine.getGameOver())
+	{
+		return 0;
+	}
+	const Gameboard &board = engine.getBoard();
+	GridTetromino turned = engine.getCurrentShape();
+
+	bool found = false;
+	double bestScore = 0.0;
+	int bestRotations = 0;
+	int bestMoves = 0;
+	for (int rotations = 0; rotations < TetrominoTables::ROTATION_COUNT; rotations++)
+	{
+		if (rotations > 0)
+		{
+			Point kick;
+			if (!WallKicks::resolveClockwise(board, turned.getShape(), turned.getRotation(),
+				turned.getGridLoc().getX(), turned.getGridLoc().getY(), kick))
+			{
+				break;	// blocked: later turns would be blocked too
+			}
+			turned.rotateClockwise();
+			turned.move(kick.getX(), kick.getY());
+		}
+
+		// slide left from where it is (moves < 0), then right (moves > 0)
+		for (int direction = -1; direction <= 1; direction += 2)
+		{
+			for (int moves = (direction < 0) ? 0 : 1;
+				board.canPlace(turned.getBlockLocs(), turned.getGridLoc().getX() + moves * direction, turned.getGridLoc().getY());
+				moves++)
+			{
+				GridTetromino placed = turned;
+				placed.move(moves * direction, 0);
+				placed.move(0, board.getDropDistance(placed.getBlockLocsMappedToGrid()));
+
+				Gameboard after = board;
+				Gameboard::RowClear rowClear = after.lockBlocks(placed.getBlockLocsMappedToGrid(), placed.getColor());
+				after.removeRows(rowClear);
+				double score = weights.evaluate(after, rowClear.count);
+				if (!found || score > bestScore)
+				{
+					found = true;
+					bestScore = score;
+					bestRotations = rotations;
+					bestMoves = moves * direction;
+				}
+			}
+		}
+	}
+
+	int count = 0;
+	for (int turn = 0; turn < bestRotations; turn++)
+	{
+		inputs[count++] = TetrisEngine::ROTATE;
+	}
+	for (int move = 0; move < ((bestMoves < 0) ? -bestMoves : bestMoves); move++)
+	{
+		inputs[count++] = (bestMoves < 0) ? TetrisEngine::MOVE_LEFT : TetrisEngine::MOVE_RIGHT;
+	}
+	inputs[count++] = TetrisEngine::HARD_DROP;
+	assert(count <= MAX_INPUTS && "BotPolicy - too many inputs for one frame");
+	return count;
+}
+
+// score a board the way the weights say
+// - param 1: the Gameboard after a placement (and its rows removed)
+// - param 2: an int, the rows the placement cleared
+// - return: a double, higher is better
+double BotPolicy::Weights::evaluate(const Gameboard &board, int rowsCleared) const
+{
+	BoardFeatures::Features features;
+	BoardFeatures::extract(board, features);
+	return aggregateHeight * features.aggregateHeight +
+		this->rowsCleared * rowsCleared +
+		holes * features.holes +
+		bumpiness * features.bumpiness +
+		wellSum * features.wellSum +
+		rowTransitions * features.rowTransitions +
+		columnTransitions * features.columnTransitions;
+}
@@ -0,0 +1,117 @@
+// An InputPolicy plays a TetrisEngine game without a person at the keyboard.
+//
+// Once per frame, before the game is stepped, the policy looks at the game and
+// chooses the inputs to apply on that frame (none, one, or several in a row).
+// GameFarm uses policies to play games headless; anything else that drives an
+// engine (a replay checker, a test) can use them too.
+//
+// A policy may keep state between frames, but it is started again by newGame()
+// with the game's seed, so a game plays the same however many games the policy
+// played before it.  Policies are not shared between threads: each GameFarm
+// worker makes its own.
+//
+// The policies here:
+//   - ScriptedPolicy: plays a fixed string of inputs, one per frame, over and over
+//   - RandomPolicy:   mashes random inputs, from a Randomizer seeded per game
+//   - BotPolicy:      places each shape where a weighted sum of board features
+//                     (see BoardFeatures.h) is best, one shape at a time
+// (and BeamPolicy, in BeamSearch.h, which looks further ahead, and ExpectimaxPolicy,
+// in ExpectimaxSearch.h, which looks past the shapes it can see)
+
+#ifndef INPUTPOLICY_H
+#define INPUTPOLICY_H
+
+#include <cstdint>
+#include <string>
+#include "BoardFeatures.h"
+#include "Randomizer.h"
+#include "TetrisEngine.h"
+
+class InputPolicy
+{
+public:
+	static const int MAX_INPUTS = 64;	// the most inputs a policy can choose for one frame (a bot's tuck can take dozens)
+
+	virtual ~InputPolicy() {}
+
+	// get ready to play a new game
+	// - param 1: a uint64_t, the game's seed (for policies that need randomness)
+	// - return: nothing
+	virtual void newGame(uint64_t seed) {}
+
+	// choose the inputs to apply on the coming frame
+	// - param 1: the TetrisEngine being played (not yet stepped for the frame)
+	// - param 2: an array of MAX_INPUTS Inputs, filled in with the inputs in order
+	// - return: an int, the number of inputs (0 for none)
+	virtual int chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs) = 0;
+};
+
+class ScriptedPolicy : public InputPolicy
+{
+private:
+	std::string script;		// one letter per frame (see the constructor)
+	size_t position{ 0 };	// the letter for the coming frame
+
+public:
+	// constructor
+	//   the letters are L (move left), R (move right), D (soft drop), U (rotate),
+	//   H (hard drop) and . (no input), as on the keyboard
+	// assert the script is not empty and every letter is one of those
+	// - param 1: a string, the script
+	ScriptedPolicy(const std::string &script);
+
+	void newGame(uint64_t seed) override;
+	int chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs) override;
+};
+
+class RandomPolicy : public InputPolicy
+{
+private:
+	Randomizer random;		// the choices, restarted from each game's seed
+
+public:
+	// constructor
+	RandomPolicy();
+
+	void newGame(uint64_t seed) override;
+	int chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs) override;
+};
+
+class BotPolicy : public InputPolicy
+{
+public:
+	// what each board feature (and each row cleared) is worth to the bot
+	struct Weights
+	{
+		double aggregateHeight{ -0.510066 };
+		double rowsCleared{ 0.760666 };
+		double holes{ -0.35663 };
+		double bumpiness{ -0.184483 };
+		double wellSum{ 0.0 };
+		double rowTransitions{ 0.0 };
+		double columnTransitions{ 0.0 };
+
+		// score a board the way the weights say
+		// - param 1: the Gameboard after a placement (and its rows removed)
+		// - param 2: an int, the rows the placement cleared
+		// - return: a double, higher is better
+		double evaluate(const Gameboard &board, int rowsCleared) const;
+	};
+
+private:
+	Weights weights;
+
+public:
+	// constructor - play with the default Weights
+	BotPolicy();
+
+	// constructor
+	// - param 1: the Weights to play with (eg. a bot version being evaluated)
+	BotPolicy(const Weights &weights);
+
+	// choose a rotation and column for the current shape, and give every input to
+	// get it there at once: the rotations, the moves and a hard drop
+	int chooseInputs(const TetrisEngine &engine, TetrisEngine::Input *inputs) override;
+};
+
+#endif /* INPUTPOLICY_H */
@@ -1,14 +1,14 @@
 #include <SFML/Graphics.hpp>
 #include <iostream>
+#include <ctime>
+#include "BeamSearch.h"
+#include "ExpectimaxSearch.h"
 #include "TetrisGame.h"
 #include "TestSuite.h"
 
 
 int main()
 {	
-	// seed rand()
-	srand(time(0));
-
 	// run some sanity tests on our classes to ensure they're working as expected.
 	TestSuite::runTestSuite();
 
@@ -32,10 +32,15 @@ int main()
 	const Point gameboardOffset{ 54, 125 };		// the pixel offset of the top left of the gameboard 
 	const Point nextShapeOffset{ 490, 210 };	// the pixel offset of the next shape Tetromino
 
-	// set up a tetris game
-	TetrisGame game(window, blockSprite, gameboardOffset, nextShapeOffset);
+	// set up a tetris game (its piece sequence is seeded from the clock)
+	TetrisGame game(window, blockSprite, gameboardOffset, nextShapeOffset, static_cast<uint64_t>(time(0)));
+
+	// the built-in bots: press B (the beam search) or E (the expectimax search,
+	// for the best score) to let one play, and again to take over
+	BeamPolicy bot;
+	ExpectimaxPolicy expectimaxBot;
 
-	// set up a clock so we can determine seconds per game loop
+	// set up a clock so we can measure the time of each game loop
 	sf::Clock clock;		
 
 	// create an event for handling userInput from the GUI (graphical user interface)
@@ -44,9 +49,8 @@ int main()
 	// the main game loop
 	while (window.isOpen())
 	{
-		// how long since the last loop (fraction of a second)		
-		float elapsedTime = clock.getElapsedTime().asSeconds();
-		clock.restart();		
+		// how long since the last loop (restart() returns it and starts timing the next loop)
+		sf::Time elapsedTime = clock.restart();
 
 		// handle any window or keyboard events that have occured since the last game loop
 		sf::Event event;
@@ -56,6 +60,14 @@ int main()
 			{
 				window.close();
 			}
+			else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::B)
+			{
+				game.setAutoPlayer(game.getAutoPlayer() ? nullptr : &bot);	// toggle the bot
+			}
+			else if (event.type == sf::Event::KeyPressed && event.key.code == sf::Keyboard::E)
+			{
+				game.setAutoPlayer(game.getAutoPlayer() ? nullptr : &expectimaxBot);
+			}
 			else if (event.type == sf::Event::KeyPressed)
 			{
 				game.onKeyPressed(event);	// handle key press
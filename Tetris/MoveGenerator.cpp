@@ -0,0 +1,304 @@
+#include "MoveGenerator.h"
+#include "WallKicks.h"
+
+using TetrominoTables::Orientation;
+using TetrominoTables::ROTATION_COUNT;
+using TetrominoTables::BLOCK_COUNT;
+
+// shift a mask of columns left (positive shift) or right (negative shift)
+static uint32_t shiftColumns(uint32_t columns, int shift)
+{
+	return (shift >= 0) ? (columns << shift) : (columns >> -shift);
+}
+
+// the columns the left edge of an orientation can be in without crossing a wall
+static uint32_t validLefts(const Orientation &o)
+{
+	int width = o.maxX - o.minX + 1;
+	return (1u << (Gameboard::MAX_X - width + 1)) - 1;
+}
+
+// the columns (left edges) where an orientation fits with its gridLoc on row y.
+//   For each block in a shape row, shifting the board row right by the block's
+//   column marks every left edge that would put that block on a filled cell.
+static uint32_t fitRow(const Gameboard &board, const Orientation &o, int y)
+{
+	uint32_t blocked = 0;
+	int top = y + o.minY;
+	for (int row = 0; row <= o.maxY - o.minY; row++)
+	{
+		uint32_t boardRow = board.getRowMask(top + row);
+		uint32_t shapeRow = o.rowMasks[row];
+		for (int bit = 0; shapeRow != 0; bit++, shapeRow >>= 1)
+		{
+			if (shapeRow & 1)
+			{
+				blocked |= boardRow >> bit;
+			}
+		}
+	}
+	return ~blocked & validLefts(o);
+}
+
+// check whether two orientations fill the same cells (relative to their top left)
+static bool sameCells(const Orientation &a, const Orientation &b)
+{
+	if (a.maxY - a.minY != b.maxY - b.minY)
+	{
+		return false;
+	}
+	for (int row = 0; row < BLOCK_COUNT; row++)
+	{
+		if (a.rowMasks[row] != b.rowMasks[row])
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+// Find every distinct position where a shape can lock.
+//   Flood fill from the shape's position and rotation through every move
+//   the game allows, and list each reachable position where the shape
+//   cannot move down (leaving out ones that fill the same cells as one
+//   already listed).  If the shape does not fit where it is, nothing is found.
+// - param 1: the Gameboard to search
+// - param 2: a GridTetromino, the shape and where it starts
+// - param 3: a PlacementList, filled in with the placements found
+// - return: an int, the number of placements found
+int MoveGenerator::generatePlacements(const Gameboard &board, const GridTetromino &shape, PlacementList &list)
+{
+	list.count = 0;
+	TetShape type = shape.getShape();
+	const Orientation *orientations = TetrominoTables::SHAPES.orientations[type];
+
+	// fit and reach masks for each rotation and row (row index = y + ABOVE_BOARD).
+	// fit has an extra row below the floor, where nothing fits.
+	uint32_t fit[ROTATION_COUNT][ROWS + 1];
+	uint32_t reach[ROTATION_COUNT][ROWS]{};
+	for (int rotation = 0; rotation < ROTATION_COUNT; rotation++)
+	{
+		for (int row = 0; row < ROWS; row++)
+		{
+			fit[rotation][row] = fitRow(board, orientations[rotation], row - ABOVE_BOARD);
+		}
+		fit[rotation][ROWS] = 0;
+	}
+
+	// start where the shape is
+	int startRotation = shape.getRotation();
+	int startRow = shape.getGridLoc().getY() + ABOVE_BOARD;
+	int startLeft = shape.getGridLoc().getX() + orientations[startRotation].minX;
+	if (startRow < 0 || startRow >= ROWS || startLeft < 0 || startLeft >= Gameboard::MAX_X ||
+		(fit[startRotation][startRow] & (1u << startLeft)) == 0)
+	{
+		return 0;
+	}
+	reach[startRotation][startRow] = 1u << startLeft;
+
+	// O never kicks, I has its own table
+	int candidates = (type == TetShape::O) ? 1 : WallKicks::KICK_COUNT;
+
+	// flood fill until a pass reaches nothing new
+	bool changed = true;
+	while (changed)
+	{
+		changed = false;
+		for (int rotation = 0; rotation < ROTATION_COUNT; rotation++)
+		{
+			int next = (rotation + 1) % ROTATION_COUNT;
+			const WallKicks::Kick *kicks = WallKicks::getKicks(type, rotation);
+			for (int row = 0; row < ROWS; row++)
+			{
+				uint32_t reached = reach[rotation][row];
+				if (reached == 0)
+				{
+					continue;
+				}
+
+				// slide left and right as far as the row allows
+				uint32_t spread = (reached | (reached << 1) | (reached >> 1)) & fit[rotation][row];
+				while (spread != reached)
+				{
+					reached = spread;
+					spread = (reached | (reached << 1) | (reached >> 1)) & fit[rotation][row];
+				}
+				reach[rotation][row] = reached;
+
+				// soft drop (the row below is visited next in this pass)
+				if (row + 1 < ROWS)
+				{
+					reach[rotation][row + 1] |= reached & fit[rotation][row + 1];
+				}
+
+				// rotate: each position takes the first kick candidate that fits
+				uint32_t remaining = reached;
+				for (int k = 0; k < candidates && remaining != 0; k++)
+				{
+					int targetRow = row + kicks[k].y;
+					int shift = orientations[next].minX - orientations[rotation].minX + kicks[k].x;
+					uint32_t moved = shiftColumns(remaining, shift);
+					uint32_t fits;
+					if (targetRow < 0)
+					{
+						fits = moved & validLefts(orientations[next]);	// above the explored rows (empty), not followed
+					}
+					else
+					{
+						fits = (targetRow < ROWS) ? (moved & fit[next][targetRow]) : 0;
+					}
+					remaining &= ~shiftColumns(fits, -shift);
+
+					if (targetRow >= 0 && targetRow < ROWS && (fits & ~reach[next][targetRow]) != 0)
+					{
+						reach[next][targetRow] |= fits;
+						changed = true;
+					}
+				}
+			}
+		}
+	}
+
+	// rotations that fill the same cells share a class (the first such rotation)
+	int cellClass[ROTATION_COUNT];
+	for (int rotation = 0; rotation < ROTATION_COUNT; rotation++)
+	{
+		cellClass[rotation] = rotation;
+		for (int earlier = 0; earlier < rotation; earlier++)
+		{
+			if (sameCells(orientations[earlier], orientations[rotation]))
+			{
+				cellClass[rotation] = cellClass[earlier];
+				break;
+			}
+		}
+	}
+
+	// list the positions that cannot move down, once per set of cells
+	//   (listed is indexed by the top row of the shape's cells + BLOCK_COUNT)
+	uint32_t listed[ROTATION_COUNT][ROWS + BLOCK_COUNT]{};
+	for (int rotation = 0; rotation < ROTATION_COUNT; rotation++)
+	{
+		const Orientation &o = orientations[rotation];
+		for (int row = 0; row < ROWS; row++)
+		{
+			uint32_t locks = reach[rotation][row] & ~fit[rotation][row + 1];
+			uint32_t &seen = listed[cellClass[rotation]][row + o.minY + BLOCK_COUNT];
+			locks &= ~seen;
+			seen |= locks;
+			for (int left = 0; locks != 0; left++, locks >>= 1)
+			{
+				if (locks & 1)
+				{
+					Placement &placement = list.placements[list.count++];
+					placement.x = static_cast<int8_t>(left - o.minX);
+					placement.y = static_cast<int8_t>(row - ABOVE_BOARD);
+					placement.rotation = static_cast<int8_t>(rotation);
+				}
+			}
+		}
+	}
+	return list.count;
+}
+
+// Find the inputs that take a shape from where it is to a placement, and lock it there.
+//   A breadth first search over the moves the game allows (left, right, soft
+//   drop and clockwise rotation with wall kicks), so the path is as short as it
+//   can be; it ends with a hard drop, which locks the shape where it rests.
+// - param 1: the Gameboard to search
+// - param 2: a GridTetromino, the shape and where it starts
+// - param 3: a Placement for the shape (see generatePlacements())
+// - param 4: an array of Inputs, filled in with the path
+// - param 5: an int, the most inputs the array holds
+// - return: an int, the number of inputs (0 if the placement can't be reached in that many)
+int MoveGenerator::findInputs(const Gameboard &board, const GridTetromino &shape, const Placement &target,
+	TetrisEngine::Input *inputs, int maxInputs)
+{
+	// a position is (rotation, x, y), with x kept MARGIN columns either side of the board
+	const int MARGIN = 4;
+	const int COLUMNS = Gameboard::MAX_X + 2 * MARGIN;
+	const int POSITIONS = ROTATION_COUNT * COLUMNS * ROWS;
+	auto positionOf = [](int rotation, int x, int y) { return (rotation * COLUMNS + x + MARGIN) * ROWS + y + ABOVE_BOARD; };
+	auto inRange = [](int x, int y) { return x >= -MARGIN && x < Gameboard::MAX_X + MARGIN && y >= -ABOVE_BOARD && y < Gameboard::MAX_Y; };
+
+	int16_t from[POSITIONS];					// the position each was reached from (-1 for the start, -2 for not reached)
+	int8_t move[POSITIONS];						// the input that reached it
+	int16_t queue[POSITIONS];
+	for (int i = 0; i < POSITIONS; i++)
+	{
+		from[i] = -2;
+	}
+
+	GridTetromino t = shape;
+	int startX = shape.getGridLoc().getX();
+	int startY = shape.getGridLoc().getY();
+	if (!inRange(startX, startY) || !inRange(target.x, target.y) || !board.canPlace(t.getBlockLocs(), startX, startY))
+	{
+		return 0;
+	}
+	int goal = positionOf(target.rotation, target.x, target.y);
+	int start = positionOf(shape.getRotation(), startX, startY);
+	from[start] = -1;
+	queue[0] = static_cast<int16_t>(start);
+	int queued = 1;
+
+	for (int head = 0; head < queued && from[goal] == -2; head++)
+	{
+		int position = queue[head];
+		int y = position % ROWS - ABOVE_BOARD;
+		int x = (position / ROWS) % COLUMNS - MARGIN;
+		int rotation = position / (ROWS * COLUMNS);
+		t.setRotation(rotation);
+
+		// left, right and soft drop, then rotate
+		const int dx[3] = { -1, 1, 0 };
+		const int dy[3] = { 0, 0, 1 };
+		const TetrisEngine::Input moves[3] = { TetrisEngine::MOVE_LEFT, TetrisEngine::MOVE_RIGHT, TetrisEngine::SOFT_DROP };
+		int next[4];
+		for (int m = 0; m < 3; m++)
+		{
+			int nx = x + dx[m];
+			int ny = y + dy[m];
+			next[m] = (inRange(nx, ny) && board.canPlace(t.getBlockLocs(), nx, ny)) ? positionOf(rotation, nx, ny) : -1;
+		}
+		Point kick;
+		next[3] = -1;
+		if (WallKicks::resolveClockwise(board, shape.getShape(), rotation, x, y, kick) &&
+			inRange(x + kick.getX(), y + kick.getY()))
+		{
+			next[3] = positionOf((rotation + 1) % ROTATION_COUNT, x + kick.getX(), y + kick.getY());
+		}
+
+		for (int m = 0; m < 4; m++)
+		{
+			if (next[m] >= 0 && from[next[m]] == -2)
+			{
+				from[next[m]] = static_cast<int16_t>(position);
+				move[next[m]] = static_cast<int8_t>((m < 3) ? moves[m] : TetrisEngine::ROTATE);
+				queue[queued++] = static_cast<int16_t>(next[m]);
+			}
+		}
+	}
+	if (from[goal] == -2)
+	{
+		return 0;
+	}
+
+	// walk back from the goal to count the path, then write it out in order
+	int length = 0;
+	for (int position = goal; from[position] != -1; position = from[position])
+	{
+		length++;
+	}
+	if (length + 1 > maxInputs)
+	{
+		return 0;
+	}
+	int i = length;
+	for (int position = goal; from[position] != -1; position = from[position])
+	{
+		inputs[--i] = static_cast<TetrisEngine::Input>(move[position]);
+	}
+	inputs[length] = TetrisEngine::HARD_DROP;
+	return length + 1;
+}
@@ -0,0 +1,86 @@
+// The move generator finds every place a tetromino can lock on a board.
+//
+// Starting from a shape's current position, it explores every position the player
+// could reach with the game's own moves - left, right, soft drop and clockwise
+// rotation (with SRS wall kicks, see WallKicks.h) - and reports each reachable
+// position where the shape would lock (it cannot move down any further).  That
+// includes tucks and slides under overhangs, not just straight drops.
+//
+// The search is a bit-parallel flood fill.  For every rotation and row, one
+// bitmask holds the columns where the shape fits ("fit", worked out from the
+// board's row masks and the shape's precomputed row masks - see TetrominoTables.h)
+// and another the columns reached so far ("reach").  Each move is a shift and
+// an AND on a whole row of positions at once:
+//   - left/right: spread reach sideways through fit
+//   - soft drop:  reach of the row below |= reach & fit of the row below
+//   - rotate:     try the kick candidates in order; the positions whose first
+//                 fitting candidate is k move by kick k (the same rule as the game)
+// until nothing new is reached.
+//
+// Placements that leave exactly the same cells filled (e.g. an O in any rotation,
+// or an I standing on either end) are reported once: the first rotation found wins.
+//
+// Positions above the board are explored up to ABOVE_BOARD rows above row 0;
+// kicks that would lift the shape higher than that are not followed.
+// Nothing is allocated: the results go into a fixed size PlacementList.
+//
+// findInputs() turns a placement back into the inputs that get a shape there,
+// for a bot that has chosen one: a breadth first search over the same moves,
+// one position at a time, so the path is as short as the game allows.
+
+#ifndef MOVEGENERATOR_H
+#define MOVEGENERATOR_H
+
+#include <cstdint>
+#include "Gameboard.h"
+#include "GridTetromino.h"
+#include "TetrisEngine.h"
+#include "TetrominoTables.h"
+
+namespace MoveGenerator
+{
+	static const int ABOVE_BOARD = 4;							// rows above the board that are explored
+	static const int ROWS = Gameboard::MAX_Y + ABOVE_BOARD;		// gridLoc rows explored (-ABOVE_BOARD to MAX_Y-1)
+	static const int MAX_PLACEMENTS = TetrominoTables::ROTATION_COUNT * Gameboard::MAX_X * ROWS;
+
+	// a position where a shape locks: its gridLoc and rotation
+	struct Placement
+	{
+		int8_t x;
+		int8_t y;
+		int8_t rotation;
+	};
+
+	// the placements found by generatePlacements()
+	struct PlacementList
+	{
+		int count{ 0 };
+		Placement placements[MAX_PLACEMENTS];
+	};
+
+	// Find every distinct position where a shape can lock.
+	//   Flood fill from the shape's position and rotation through every move
+	//   the game allows, and list each reachable position where the shape
+	//   cannot move down (leaving out ones that fill the same cells as one
+	//   already listed).  If the shape does not fit where it is, nothing is found.
+	// - param 1: the Gameboard to search
+	// - param 2: a GridTetromino, the shape and where it starts
+	// - param 3: a PlacementList, filled in with the placements found
+	// - return: an int, the number of placements found
+	int generatePlacements(const Gameboard &board, const GridTetromino &shape, PlacementList &list);
+
+	// Find the inputs that take a shape from where it is to a placement, and lock it there.
+	//   A breadth first search over the moves the game allows (left, right, soft
+	//   drop and clockwise rotation with wall kicks), so the path is as short as it
+	//   can be; it ends with a hard drop, which locks the shape where it rests.
+	// - param 1: the Gameboard to search
+	// - param 2: a GridTetromino, the shape and where it starts
+	// - param 3: a Placement for the shape (see generatePlacements())
+	// - param 4: an array of Inputs, filled in with the path
+	// - param 5: an int, the most inputs the array holds
+	// - return: an int, the number of inputs (0 if the placement can't be reached in that many)
+	int findInputs(const Gameboard &board, const GridTetromino &shape, const Placement &target,
+		TetrisEngine::Input *inputs, int maxInputs);
+}
+
+#endif /* MOVEGENERATOR_H */
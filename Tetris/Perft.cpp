@@ -0,0 +1,46 @@
+#include <cassert>
+#include "Perft.h"
+#include "MoveGenerator.h"
+
+// Count the placement sequences of the given depth.
+//   Each shape spawns at the board's spawn location in rotation 0.
+// assert depth is not more than the sequence length
+// - param 1: the Gameboard to start from
+// - param 2: the shapes to place, in order
+// - param 3: an int, the number of shapes in the sequence
+// - param 4: an int, how many shapes deep to count (0 counts the start as 1)
+// - return: a uint64_t, the number of distinct placement sequences
+uint64_t Perft::count(const Gameboard &board, const TetShape *sequence, int length, int depth)
+{
+	assert(depth <= length && "Perft depth is longer than the shape sequence");
+	if (depth == 0)
+	{
+		return 1;
+	}
+
+	GridTetromino shape;
+	shape.setShape(sequence[0]);
+	shape.setGridLoc(board.getSpawnLoc());
+	MoveGenerator::PlacementList list;
+	int placements = MoveGenerator::generatePlacements(board, shape, list);
+	if (depth == 1)
+	{
+		return placements;	// the leaves don't need to be played out
+	}
+
+	uint64_t total = 0;
+	for (int i = 0; i < placements; i++)
+	{
+		const MoveGenerator::Placement &placement = list.placements[i];
+		shape.setRotation(placement.rotation);
+		shape.setGridLoc(placement.x, placement.y);
+
+		// lock and clear rows the same way the game does
+		Gameboard next = board;
+		Gameboard::RowClear cleared = next.lockBlocks(shape.getBlockLocsMappedToGrid(), shape.getColor());
+		next.removeRows(cleared);
+
+		total += count(next, sequence + 1, length - 1, depth - 1);
+	}
+	return total;
+}
@@ -0,0 +1,36 @@
+// Perft ("performance test") counts every sequence of placements a game can play.
+//
+// Borrowed from chess engines: starting from a board and a sequence of shapes,
+// each shape in turn is placed in every position the move generator finds (see
+// MoveGenerator.h), locked with the board's own lock and row clear logic, and the
+// next shape is tried on each resulting board, down to the given depth.  The
+// number of leaf positions is the perft count.
+//
+// Known counts check that move generation, rotation, collision, locking and
+// row clearing all still agree with each other after a change, and the time it
+// takes to count them is a throughput benchmark (see the Perft project).
+//
+// Like the game, a shape that cannot spawn (the board has topped out) ends the
+// sequence: that branch counts 0 at any deeper depth.
+
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <cstdint>
+#include "Gameboard.h"
+#include "Tetromino.h"
+
+namespace Perft
+{
+	// Count the placement sequences of the given depth.
+	//   Each shape spawns at the board's spawn location in rotation 0.
+	// assert depth is not more than the sequence length
+	// - param 1: the Gameboard to start from
+	// - param 2: the shapes to place, in order
+	// - param 3: an int, the number of shapes in the sequence
+	// - param 4: an int, how many shapes deep to count (0 counts the start as 1)
+	// - return: a uint64_t, the number of distinct placement sequences
+	uint64_t count(const Gameboard &board, const TetShape *sequence, int length, int depth);
+}
+
+#endif /* PERFT_H */
@@ -1,14 +1,6 @@
 #include "Point.h"
 #include <sstream>
 
-Point::Point() {}
-
-Point::Point(int x, int y)
-{
-	this->x = x;
-	this->y = y;
-}
-
 int Point::getX() const
 {
 	return x;
@@ -9,10 +9,11 @@ class Point {
         int y{0};
     public:
         // the default constructor for the point class
-        Point();
+        // (constexpr, so the orientation tables can hold points)
+        constexpr Point() {}
 
         // Constructor for Point class that is given an x and y value
-        Point(int x, int y);
+        constexpr Point(int x, int y) : x(x), y(y) {}
 
         // getter for the x value of the Point class
         // returns the current x value 
@@ -0,0 +1,362 @@
+#include <cassert>
+#include "Checksum.h"
+#include "Randomizer.h"
+
+// rotate a 32 bit value left
+static uint32_t rotateLeft(uint32_t value, int bits)
+{
+	return (value << bits) | (value >> (32 - bits));
+}
+
+// step a splitmix64 state and return its next output (used only for seeding)
+static uint64_t splitMix64(uint64_t &seed)
+{
+	uint64_t z = (seed += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+// constructor - seed the generator and fill the preview queue
+// assert previewCount is between 1 and MAX_PREVIEW
+// - param 1: a uint64_t, the seed for the piece sequence
+// - param 2: a Policy, how shapes are chosen
+// - param 3: an int, the number of shapes to keep in the preview queue
+Randomizer::Randomizer(uint64_t seed, Policy policy, int previewCount)
+	:policy(policy), previewCount(previewCount)
+{
+	assert((1 <= previewCount && previewCount <= MAX_PREVIEW) && "Randomizer preview count out of range");
+	reset(seed);
+}
+
+// restart the piece sequence from a seed (keeping the policy and preview length)
+//   the bag and history are emptied and the preview queue is refilled
+// - param 1: a uint64_t, the seed for the piece sequence
+// - return: nothing
+void Randomizer::reset(uint64_t seed)
+{
+	uint64_t a = splitMix64(seed);
+	uint64_t b = splitMix64(seed);
+	state[0] = static_cast<uint32_t>(a);
+	state[1] = static_cast<uint32_t>(a >> 32);
+	state[2] = static_cast<uint32_t>(b);
+	state[3] = static_cast<uint32_t>(b >> 32);
+
+	bagIndex = TetShape::COUNT;
+	for (int i = 0; i < HISTORY_SIZE; i++)
+	{
+		history[i] = TetShape::COUNT;
+	}
+	historyIndex = 0;
+
+	previewHead = 0;
+	for (int i = 0; i < previewCount; i++)
+	{
+		preview[i] = generate();
+	}
+}
+
+// take the shape at the front of the preview queue, and generate
+// a new shape at the back of it
+// - params: none
+// - return: a TetShape, the next shape in the sequence
+TetShape Randomizer::next()
+{
+	TetShape shape = preview[previewHead];
+	preview[previewHead] = generate();	// the old front slot becomes the back of the queue
+	previewHead = (previewHead + 1) % previewCount;
+	return shape;
+}
+
+// look at an upcoming shape without taking it
+// assert the index is within the preview queue
+// - param 1: an int, how far into the queue to look (0 = the shape next() will return)
+// - return: a TetShape, the upcoming shape
+TetShape Randomizer::peek(int index) const
+{
+	assert((0 <= index && index < previewCount) && "Randomizer preview index out of range");
+	return preview[(previewHead + index) % previewCount];
+}
+
+// get the number of shapes kept in the preview queue
+// - params: none
+// - return: an int, the preview length
+int Randomizer::getPreviewCount() const
+{
+	return previewCount;
+}
+
+// get the policy used to choose shapes
+// - params: none
+// - return: a Policy
+Randomizer::Policy Randomizer::getPolicy() const
+{
+	return policy;
+}
+
+// get the shapes a shape in the preview queue could be, as far as a player who
+// has been shown every shape before it can tell (for bots that weigh up the
+// shapes they can't see yet)
+//   SEVEN_BAG: the shapes its bag has not dealt before it; UNIFORM and HISTORY:
+//   every shape (HISTORY makes repeats rarer, but never rules one out)
+// assert the index is within the preview queue
+// - param 1: an int, how far into the queue the shape is (0 = the shape next() will return)
+// - return: a uint8_t, a bit per TetShape (1 << shape) that it could be
+uint8_t Randomizer::getPossibleShapes(int index) const
+{
+	assert((0 <= index && index < previewCount) && "Randomizer preview index out of range");
+	uint8_t possible = 0;
+	if (policy != SEVEN_BAG)
+	{
+		return (1 << TetShape::COUNT) - 1;
+	}
+
+	// the queue holds the last previewCount shapes dealt, so the shape was dealt
+	// from slot first of the current bag - or, if first is negative, from the bag
+	// before it, whose last shapes are the front of the queue
+	int first = bagIndex - previewCount + index;
+	if (first >= 0)
+	{
+		for (int i = first; i < TetShape::COUNT; i++)
+		{
+			possible |= 1 << bag[i];
+		}
+	}
+	else
+	{
+		for (int i = index; i < previewCount - bagIndex; i++)
+		{
+			possible |= 1 << peek(i);
+		}
+	}
+	return possible;
+}
+
+// get a checksum of the whole sequence state (generator, bag, history and
+// preview queue), for the game state checksum (see Checksum.h)
+// - params: none
+// - return: a uint64_t, the same for two randomizers that will deal the same shapes
+uint64_t Randomizer::getChecksum() const
+{
+	uint64_t sum = Checksum::mix((static_cast<uint64_t>(state[0]) << 32 | state[1]) ^ policy);
+	sum = Checksum::mix(sum ^ (static_cast<uint64_t>(state[2]) << 32 | state[3]));
+	// the bag, history and preview queue each fit a byte per shape
+	uint64_t shapes = static_cast<uint64_t>(bagIndex) << 8 | static_cast<uint64_t>(historyIndex);
+	for (int i = bagIndex; i < TetShape::COUNT; i++)
+	{
+		shapes = shapes << 4 | bag[i];
+	}
+	sum = Checksum::mix(sum ^ shapes);
+	shapes = static_cast<uint64_t>(previewCount);
+	for (int i = 0; i < previewCount; i++)
+	{
+		shapes = shapes << 4 | preview[(previewHead + i) % previewCount];
+	}
+	for (int i = 0; i < HISTORY_SIZE; i++)
+	{
+		shapes = shapes << 4 | history[(historyIndex + i) % HISTORY_SIZE];
+	}
+	return Checksum::mix(sum ^ shapes);
+}
+
+// write the whole sequence state (generator, bag, history and preview queue)
+// field by field, for replay keyframes: the bytes are the same whatever the
+// compiler lays the object out as, and slots not in use are written as 0
+// - param 1: a pointer to PACKED_SIZE bytes, filled in
+// - return: nothing
+void Randomizer::pack(uint8_t *bytes) const
+{
+	uint8_t *next = bytes;
+	for (uint32_t word : state)
+	{
+		for (int i = 0; i < 4; i++)
+		{
+			*next++ = static_cast<uint8_t>(word >> (8 * i));
+		}
+	}
+	*next++ = static_cast<uint8_t>(policy);
+	for (int i = 0; i < TetShape::COUNT; i++)
+	{
+		*next++ = static_cast<uint8_t>((i >= bagIndex) ? bag[i] : 0);	// (the dealt slots are never read again)
+	}
+	*next++ = static_cast<uint8_t>(bagIndex);
+	for (TetShape shape : history)
+	{
+		*next++ = static_cast<uint8_t>(shape);
+	}
+	*next++ = static_cast<uint8_t>(historyIndex);
+	for (int i = 0; i < MAX_PREVIEW; i++)
+	{
+		*next++ = static_cast<uint8_t>((i < previewCount) ? preview[i] : 0);
+	}
+	*next++ = static_cast<uint8_t>(previewHead);
+	*next++ = static_cast<uint8_t>(previewCount);
+	assert(next - bytes == PACKED_SIZE && "Randomizer.pack() - PACKED_SIZE is out of date");
+}
+
+// read a sequence state written by pack(), checking every field (the policy,
+// the indexes and every shape in use), so bytes from a damaged file are turned
+// away instead of loaded
+// - param 1: a pointer to PACKED_SIZE bytes
+// - return: bool, false (and the randomizer left as it was) if they don't hold a state
+bool Randomizer::unpack(const uint8_t *bytes)
+{
+	// the offsets pack() writes each field at
+	const int POLICY_AT = 16;
+	const int BAG_AT = POLICY_AT + 1;
+	const int BAG_INDEX_AT = BAG_AT + TetShape::COUNT;
+	const int HISTORY_AT = BAG_INDEX_AT + 1;
+	const int HISTORY_INDEX_AT = HISTORY_AT + HISTORY_SIZE;
+	const int PREVIEW_AT = HISTORY_INDEX_AT + 1;
+	const int PREVIEW_HEAD_AT = PREVIEW_AT + MAX_PREVIEW;
+	const int PREVIEW_COUNT_AT = PREVIEW_HEAD_AT + 1;
+	static_assert(PREVIEW_COUNT_AT + 1 == PACKED_SIZE, "Randomizer::unpack() - PACKED_SIZE is out of date");
+
+	int count = bytes[PREVIEW_COUNT_AT];
+	if (bytes[POLICY_AT] > HISTORY || bytes[BAG_INDEX_AT] > TetShape::COUNT || bytes[HISTORY_INDEX_AT] >= HISTORY_SIZE ||
+		count < 1 || count > MAX_PREVIEW || bytes[PREVIEW_HEAD_AT] >= count)
+	{
+		return false;
+	}
+	for (int i = bytes[BAG_INDEX_AT]; i < TetShape::COUNT; i++)
+	{
+		if (bytes[BAG_AT + i] >= TetShape::COUNT) { return false; }
+	}
+	for (int i = 0; i < HISTORY_SIZE; i++)
+	{
+		if (bytes[HISTORY_AT + i] > TetShape::COUNT) { return false; }	// (COUNT = no shape yet)
+	}
+	for (int i = 0; i < count; i++)
+	{
+		if (bytes[PREVIEW_AT + i] >= TetShape::COUNT) { return false; }
+	}
+
+	for (int word = 0; word < 4; word++)
+	{
+		state[word] = 0;
+		for (int i = 0; i < 4; i++)
+		{
+			state[word] |= static_cast<uint32_t>(bytes[word * 4 + i]) << (8 * i);
+		}
+	}
+	policy = static_cast<Policy>(bytes[POLICY_AT]);
+	for (int i = 0; i < TetShape::COUNT; i++)
+	{
+		bag[i] = static_cast<TetShape>(bytes[BAG_AT + i]);
+	}
+	bagIndex = bytes[BAG_INDEX_AT];
+	for (int i = 0; i < HISTORY_SIZE; i++)
+	{
+		history[i] = static_cast<TetShape>(bytes[HISTORY_AT + i]);
+	}
+	historyIndex = bytes[HISTORY_INDEX_AT];
+	for (int i = 0; i < MAX_PREVIEW; i++)
+	{
+		preview[i] = static_cast<TetShape>(bytes[PREVIEW_AT + i]);
+	}
+	previewHead = bytes[PREVIEW_HEAD_AT];
+	previewCount = count;
+	return true;
+}
+
+// get the next raw number from the generator
+//   (also used to derive seeds for later games)
+// - params: none
+// - return: a uint32_t, uniformly distributed over its whole range
+uint32_t Randomizer::nextRandom()
+{
+	uint32_t result = rotateLeft(state[1] * 5, 7) * 9;
+	uint32_t t = state[1] << 9;
+
+	state[2] ^= state[0];
+	state[3] ^= state[1];
+	state[1] ^= state[2];
+	state[0] ^= state[3];
+	state[2] ^= t;
+	state[3] = rotateLeft(state[3], 11);
+
+	return result;
+}
+
+// get a random number in [0, bound)
+//   uses a multiply and shift rather than % (Lemire's method)
+// assert bound is positive
+// - param 1: an int, the (exclusive) upper bound
+// - return: an int, in [0, bound)
+int Randomizer::nextBelow(int bound)
+{
+	assert(bound > 0 && "Randomizer bound must be positive");
+	return static_cast<int>((static_cast<uint64_t>(nextRandom()) * static_cast<uint32_t>(bound)) >> 32);
+}
+
+// choose a shape using the current policy
+// - params: none
+// - return: a TetShape
+TetShape Randomizer::generate()
+{
+	switch (policy)
+	{
+	case SEVEN_BAG:
+		return generateFromBag();
+	case HISTORY:
+		return generateFromHistory();
+	case UNIFORM:
+	default:
+		return static_cast<TetShape>(nextBelow(TetShape::COUNT));
+	}
+}
+
+// deal the next shape from the bag, shuffling a new bag when it is empty
+// - params: none
+// - return: a TetShape
+TetShape Randomizer::generateFromBag()
+{
+	if (bagIndex >= TetShape::COUNT)
+	{
+		// refill and Fisher-Yates shuffle the bag
+		for (int i = 0; i < TetShape::COUNT; i++)
+		{
+			bag[i] = static_cast<TetShape>(i);
+		}
+		for (int i = TetShape::COUNT - 1; i > 0; i--)
+		{
+			int j = nextBelow(i + 1);
+			TetShape swap = bag[i];
+			bag[i] = bag[j];
+			bag[j] = swap;
+		}
+		bagIndex = 0;
+	}
+	return bag[bagIndex++];
+}
+
+// roll shapes until one is not in the history (or the rolls run out),
+// then add it to the history
+// - params: none
+// - return: a TetShape
+TetShape Randomizer::generateFromHistory()
+{
+	TetShape shape = static_cast<TetShape>(nextBelow(TetShape::COUNT));
+	for (int roll = 1; roll < HISTORY_ROLLS && isInHistory(shape); roll++)
+	{
+		shape = static_cast<TetShape>(nextBelow(TetShape::COUNT));
+	}
+	history[historyIndex] = shape;
+	historyIndex = (historyIndex + 1) % HISTORY_SIZE;
+	return shape;
+}
+
+// check whether a shape is in the history
+// - param 1: a TetShape
+// - return: bool, true if the shape is one of the last HISTORY_SIZE shapes
+bool Randomizer::isInHistory(TetShape shape) const
+{
+	for (int i = 0; i < HISTORY_SIZE; i++)
+	{
+		if (history[i] == shape)
+		{
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,166 @@
+// The Randomizer class decides which TetShape comes next.
+//
+// Each TetrisGame owns its own Randomizer, so games do not share the global rand()
+// state: a game's piece sequence depends only on its seed, and any number of games
+// can run side by side (or on different threads) with independent sequences.
+//
+// Random numbers come from xoshiro128** (a small, fast generator with 128 bits of
+// state), seeded through splitmix64 so that any 64 bit seed - even 0 - gives a
+// well mixed starting state.
+//
+// The shapes are chosen by one of these policies:
+//   - UNIFORM:   every shape is equally likely every time (like rand() % 7)
+//   - SEVEN_BAG: the 7 shapes are dealt in a shuffled "bag", then the bag is refilled,
+//                so no shape is ever more than 12 pieces away
+//   - HISTORY:   remember the last HISTORY_SIZE shapes and re-roll (up to HISTORY_ROLLS
+//                times) any shape that is in that history, so repeats are rare
+//
+// Upcoming shapes wait in a preview queue (a ring buffer of up to MAX_PREVIEW shapes),
+// so a game can show the player what is coming.  next() takes the shape at the front
+// of the queue and generates a new one at the back.
+//
+// The object holds only plain values (no pointers or heap memory), so copying it
+// copies the whole sequence state.
+
+#ifndef RANDOMIZER_H
+#define RANDOMIZER_H
+
+#include <cstdint>
+#include "Tetromino.h"
+
+class Randomizer
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+public:
+	// the ways a Randomizer can choose shapes
+	enum Policy
+	{
+		UNIFORM,
+		SEVEN_BAG,
+		HISTORY
+	};
+
+	// CONSTANTS
+	static const int MAX_PREVIEW = 6;	// the most shapes the preview queue can hold
+	static const int HISTORY_SIZE = 4;	// shapes remembered by the HISTORY policy
+	static const int HISTORY_ROLLS = 6;	// rolls the HISTORY policy makes before accepting a repeat
+	static const int PACKED_SIZE = 38;	// the bytes pack() writes
+
+private:
+	// MEMBER VARIABLES
+	uint32_t state[4];					// the xoshiro128** generator state
+	Policy policy;						// how shapes are chosen
+
+	TetShape bag[TetShape::COUNT];		// the current bag (SEVEN_BAG)
+	int bagIndex;						// the next shape to deal from the bag (COUNT = bag is empty)
+
+	TetShape history[HISTORY_SIZE];		// the most recent shapes (HISTORY), COUNT = no shape yet
+	int historyIndex;					// the oldest entry in history (overwritten next)
+
+	TetShape preview[MAX_PREVIEW];		// the preview queue (a ring buffer)
+	int previewHead;					// the index of the front of the preview queue
+	int previewCount;					// the number of shapes kept in the preview queue
+
+public:
+	// constructor - seed the generator and fill the preview queue
+	// assert previewCount is between 1 and MAX_PREVIEW
+	// - param 1: a uint64_t, the seed for the piece sequence
+	// - param 2: a Policy, how shapes are chosen
+	// - param 3: an int, the number of shapes to keep in the preview queue
+	Randomizer(uint64_t seed = 0, Policy policy = SEVEN_BAG, int previewCount = 1);
+
+	// restart the piece sequence from a seed (keeping the policy and preview length)
+	//   the bag and history are emptied and the preview queue is refilled
+	// - param 1: a uint64_t, the seed for the piece sequence
+	// - return: nothing
+	void reset(uint64_t seed);
+
+	// take the shape at the front of the preview queue, and generate
+	// a new shape at the back of it
+	// - params: none
+	// - return: a TetShape, the next shape in the sequence
+	TetShape next();
+
+	// look at an upcoming shape without taking it
+	// assert the index is within the preview queue
+	// - param 1: an int, how far into the queue to look (0 = the shape next() will return)
+	// - return: a TetShape, the upcoming shape
+	TetShape peek(int index) const;
+
+	// get the number of shapes kept in the preview queue
+	// - params: none
+	// - return: an int, the preview length
+	int getPreviewCount() const;
+
+	// get the policy used to choose shapes
+	// - params: none
+	// - return: a Policy
+	Policy getPolicy() const;
+
+	// get the shapes a shape in the preview queue could be, as far as a player who
+	// has been shown every shape before it can tell (for bots that weigh up the
+	// shapes they can't see yet)
+	//   SEVEN_BAG: the shapes its bag has not dealt before it; UNIFORM and HISTORY:
+	//   every shape (HISTORY makes repeats rarer, but never rules one out)
+	// assert the index is within the preview queue
+	// - param 1: an int, how far into the queue the shape is (0 = the shape next() will return)
+	// - return: a uint8_t, a bit per TetShape (1 << shape) that it could be
+	uint8_t getPossibleShapes(int index) const;
+
+	// get a checksum of the whole sequence state (generator, bag, history and
+	// preview queue), for the game state checksum (see Checksum.h)
+	// - params: none
+	// - return: a uint64_t, the same for two randomizers that will deal the same shapes
+	uint64_t getChecksum() const;
+
+	// write the whole sequence state (generator, bag, history and preview queue)
+	// field by field, for replay keyframes: the bytes are the same whatever the
+	// compiler lays the object out as, and slots not in use are written as 0
+	// - param 1: a pointer to PACKED_SIZE bytes, filled in
+	// - return: nothing
+	void pack(uint8_t *bytes) const;
+
+	// read a sequence state written by pack(), checking every field (the policy,
+	// the indexes and every shape in use), so bytes from a damaged file are turned
+	// away instead of loaded
+	// - param 1: a pointer to PACKED_SIZE bytes
+	// - return: bool, false (and the randomizer left as it was) if they don't hold a state
+	bool unpack(const uint8_t *bytes);
+
+	// get the next raw number from the generator
+	//   (also used to derive seeds for later games)
+	// - params: none
+	// - return: a uint32_t, uniformly distributed over its whole range
+	uint32_t nextRandom();
+
+	// get a random number in [0, bound)
+	//   uses a multiply and shift rather than % (Lemire's method)
+	// assert bound is positive
+	// - param 1: an int, the (exclusive) upper bound
+	// - return: an int, in [0, bound)
+	int nextBelow(int bound);
+
+private:
+	// choose a shape using the current policy
+	// - params: none
+	// - return: a TetShape
+	TetShape generate();
+
+	// deal the next shape from the bag, shuffling a new bag when it is empty
+	// - params: none
+	// - return: a TetShape
+	TetShape generateFromBag();
+
+	// roll shapes until one is not in the history (or the rolls run out),
+	// then add it to the history
+	// - params: none
+	// - return: a TetShape
+	TetShape generateFromHistory();
+
+	// check whether a shape is in the history
+	// - param 1: a TetShape
+	// - return: bool, true if the shape is one of the last HISTORY_SIZE shapes
+	bool isInHistory(TetShape shape) const;
+};
+
+#endif /* RANDOMIZER_H */
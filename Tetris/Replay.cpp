@@ -0,0 +1,876 @@
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include "GameState.h"
+#include "Replay.h"
+#include "TetrisListener.h"
+#include "TetrominoTables.h"
+
+static const char MAGIC[4] = { 'T', 'R', 'P', 'L' };	// the first bytes of an encoded replay
+static const int INPUT_BITS = 3;						// bits of an event varint that hold the input
+
+static const int FOOTER_SIZE = 4;						// bytes of the footer (the index's offset)
+
+static_assert(TetrisEngine::HARD_DROP < (1 << INPUT_BITS), "an input must fit in INPUT_BITS");
+
+// counts the shapes a game locks (to find the shape boundaries to keyframe and seek to)
+class LockCounter : public TetrisListener
+{
+public:
+	uint32_t shapes{ 0 };
+
+	void onShapeLocked() override { shapes++; }
+};
+
+// append an unsigned LEB128 varint: 7 bits a byte, low bits first, the top bit set on every byte but the last
+// - param 1: a vector of bytes, appended to
+// - param 2: a uint64_t, the value
+// - return: nothing
+static void putVarint(std::vector<uint8_t> &bytes, uint64_t value)
+{
+	while (value >= 0x80)
+	{
+		bytes.push_back(static_cast<uint8_t>(value | 0x80));
+		value >>= 7;
+	}
+	bytes.push_back(static_cast<uint8_t>(value));
+}
+
+// read an unsigned LEB128 varint
+// - param 1: a pointer to the next byte, moved past the varint
+// - param 2: a pointer just past the last byte
+// - param 3: a uint64_t, set to the value
+// - return: bool, false if the bytes run out (or the varint is too long for 64 bits)
+static bool getVarint(const uint8_t *&next, const uint8_t *end, uint64_t &value)
+{
+	value = 0;
+	for (int shift = 0; shift < 64; shift += 7)
+	{
+		if (next == end)
+		{
+			return false;
+		}
+		uint8_t byte = *next++;
+		value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+		if ((byte & 0x80) == 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+// read a varint that must fit in a uint32_t
+// - param 1: a pointer to the next byte, moved past the varint
+// - param 2: a pointer just past the last byte
+// - param 3: a uint32_t, set to the value
+// - return: bool, false if the bytes run out or the value is too big
+static bool getVarint32(const uint8_t *&next, const uint8_t *end, uint32_t &value)
+{
+	uint64_t wide;
+	if (!getVarint(next, end, wide) || wide > UINT32_MAX)
+	{
+		return false;
+	}
+	value = static_cast<uint32_t>(wide);
+	return true;
+}
+
+// append a number as 8 bytes, little endian (for checksums, which varints would make longer)
+// - param 1: a vector of bytes, appended to
+// - param 2: a uint64_t, the value
+// - return: nothing
+static void putFixed64(std::vector<uint8_t> &bytes, uint64_t value)
+{
+	for (int i = 0; i < 8; i++)
+	{
+		bytes.push_back(static_cast<uint8_t>(value >> (8 * i)));
+	}
+}
+
+// read a number written by putFixed64()
+// - param 1: a pointer to the next byte, moved past the number
+// - param 2: a pointer just past the last byte
+// - param 3: a uint64_t, set to the value
+// - return: bool, false if the bytes run out
+static bool getFixed64(const uint8_t *&next, const uint8_t *end, uint64_t &value)
+{
+	if (end - next < 8)
+	{
+		return false;
+	}
+	value = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		value |= static_cast<uint64_t>(*next++) << (8 * i);
+	}
+	return true;
+}
+
+// append a signed number as a zigzag varint (so small negative numbers stay small)
+// - param 1: a vector of bytes, appended to
+// - param 2: an int64_t, the value
+// - return: nothing
+static void putSigned(std::vector<uint8_t> &bytes, int64_t value)
+{
+	putVarint(bytes, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+// read a zigzag varint
+// - param 1: a pointer to the next byte, moved past the varint
+// - param 2: a pointer just past the last byte
+// - param 3: an int64_t, set to the value
+// - return: bool, false if the bytes run out
+static bool getSigned(const uint8_t *&next, const uint8_t *end, int64_t &value)
+{
+	uint64_t zigzag;
+	if (!getVarint(next, end, zigzag))
+	{
+		return false;
+	}
+	value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+	return true;
+}
+
+// read a zigzag varint that must fit in an int32_t
+// - param 1: a pointer to the next byte, moved past the varint
+// - param 2: a pointer just past the last byte
+// - param 3: an int32_t, set to the value
+// - return: bool, false if the bytes run out or the value is too big
+static bool getSigned(const uint8_t *&next, const uint8_t *end, int32_t &value)
+{
+	int64_t wide;
+	if (!getSigned(next, end, wide) || wide < INT32_MIN || wide > INT32_MAX)
+	{
+		return false;
+	}
+	value = static_cast<int32_t>(wide);
+	return true;
+}
+
+// append a shape: its TetShape and rotation (a byte each), then its gridLoc
+// - param 1: a vector of bytes, appended to
+// - param 2: the GridTetromino
+// - return: nothing
+static void putShape(std::vector<uint8_t> &bytes, const GridTetromino &shape)
+{
+	bytes.push_back(static_cast<uint8_t>(shape.getShape()));
+	bytes.push_back(static_cast<uint8_t>(shape.getRotation()));
+	putSigned(bytes, shape.getGridLoc().getX());
+	putSigned(bytes, shape.getGridLoc().getY());
+}
+
+// read a shape written by putShape()
+// - param 1: a pointer to the next byte, moved past the shape
+// - param 2: a pointer just past the last byte
+// - param 3: a GridTetromino, set to the shape
+// - return: bool, false if the bytes run out or do not hold a shape
+static bool getShape(const uint8_t *&next, const uint8_t *end, GridTetromino &shape)
+{
+	int32_t x;
+	int32_t y;
+	if (end - next < 2 || next[0] >= TetShape::COUNT || next[1] >= TetrominoTables::ROTATION_COUNT)
+	{
+		return false;
+	}
+	shape.setShape(static_cast<TetShape>(next[0]));
+	shape.setRotation(next[1]);
+	next += 2;
+	if (!getSigned(next, end, x) || !getSigned(next, end, y))
+	{
+		return false;
+	}
+	shape.setGridLoc(x, y);
+	return true;
+}
+
+// append a whole game state, packed
+//   the board is its row masks, then a 4-bit color for each filled cell (top row
+//   first, left to right, two to a byte), and the randomizer is packed field by field
+//   (see Randomizer::pack())
+// - param 1: a vector of bytes, appended to
+// - param 2: the GameState
+// - return: nothing
+static void putState(std::vector<uint8_t> &bytes, const GameState &state)
+{
+	const uint16_t *rows = state.board.getRowMasks();
+	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	{
+		putVarint(bytes, rows[y]);
+	}
+	bool half = false;
+	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	{
+		for (int x = 0; x < Gameboard::MAX_X; x++)
+		{
+			if ((rows[y] >> x) & 1)
+			{
+				uint8_t color = static_cast<uint8_t>(state.board.getContent(x, y) & 0x0F);
+				if (half)
+				{
+					bytes.back() |= static_cast<uint8_t>(color << 4);
+				}
+				else
+				{
+					bytes.push_back(color);
+				}
+				half = !half;
+			}
+		}
+	}
+
+	putShape(bytes, state.currentShape);
+	putShape(bytes, state.nextShape);
+	bytes.push_back(static_cast<uint8_t>(state.lockedRows.count));
+	for (int i = 0; i < state.lockedRows.count; i++)
+	{
+		bytes.push_back(static_cast<uint8_t>(state.lockedRows.rowIndices[i]));
+	}
+	uint8_t randomizer[Randomizer::PACKED_SIZE];
+	state.randomizer.pack(randomizer);
+	bytes.insert(bytes.end(), randomizer, randomizer + Randomizer::PACKED_SIZE);
+
+	putVarint(bytes, state.seed);
+	putVarint(bytes, state.frame);
+	putSigned(bytes, state.gravity);
+	putSigned(bytes, state.gravityProgress);
+	putSigned(bytes, state.score);
+	putSigned(bytes, state.level);
+	putSigned(bytes, state.cleared);
+	bytes.push_back(static_cast<uint8_t>((state.gameOver ? 1 : 0) | (state.shapePlacedSinceLastStep ? 2 : 0)));
+	putFixed64(bytes, state.checksum);
+}
+
+// read a game state written by putState()
+// - param 1: a pointer to the next byte, moved past the state
+// - param 2: a pointer just past the last byte
+// - param 3: a GameState, set to the state
+// - return: bool, false if the bytes run out or do not hold a state
+static bool getState(const uint8_t *&next, const uint8_t *end, GameState &state)
+{
+	uint16_t rows[Gameboard::MAX_Y];
+	for (uint16_t &row : rows)
+	{
+		uint32_t mask;
+		if (!getVarint32(next, end, mask) || mask > Gameboard::FULL_ROW_MASK)
+		{
+			return false;
+		}
+		row = static_cast<uint16_t>(mask);
+	}
+	state.board.empty();
+	bool half = false;
+	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	{
+		for (int x = 0; x < Gameboard::MAX_X; x++)
+		{
+			if ((rows[y] >> x) & 1)
+			{
+				if (!half && next == end)
+				{
+					return false;
+				}
+				int color = half ? (*next++ >> 4) : (*next & 0x0F);
+				if (color > TetColor::PURPLE)
+				{
+					return false;
+				}
+				state.board.setContent(x, y, color);
+				half = !half;
+			}
+		}
+	}
+	if (half)
+	{
+		next++;
+	}
+
+	if (!getShape(next, end, state.currentShape) || !getShape(next, end, state.nextShape) ||
+		next == end || *next > Gameboard::MAX_Y)
+	{
+		return false;
+	}
+	// (the ghost is dropped from the current shape when the state is loaded, so
+	//  every block of it must be in a column of the board, and above the floor)
+	for (const Point &block : state.currentShape.getBlockLocsMappedToGrid())
+	{
+		if (block.getX() < 0 || block.getX() >= Gameboard::MAX_X || block.getY() >= Gameboard::MAX_Y)
+		{
+			return false;
+		}
+	}
+	state.lockedRows.count = static_cast<int8_t>(*next++);
+	for (int i = 0; i < state.lockedRows.count; i++)
+	{
+		if (next == end || *next >= Gameboard::MAX_Y)
+		{
+			return false;
+		}
+		state.lockedRows.rowIndices[i] = static_cast<int8_t>(*next++);
+	}
+	if (end - next < Randomizer::PACKED_SIZE || !state.randomizer.unpack(next))
+	{
+		return false;
+	}
+	next += Randomizer::PACKED_SIZE;
+
+	if (!getVarint(next, end, state.seed) || !getVarint32(next, end, state.frame) ||
+		!getSigned(next, end, state.gravity) || !getSigned(next, end, state.gravityProgress) ||
+		!getSigned(next, end, state.score) || !getSigned(next, end, state.level) ||
+		!getSigned(next, end, state.cleared) || next == end || *next > 3)
+	{
+		return false;
+	}
+	state.gameOver = (*next & 1) != 0;
+	state.shapePlacedSinceLastStep = (*next & 2) != 0;
+	next++;
+	return getFixed64(next, end, state.checksum);
+}
+
+// find the first event on or after a frame
+// - param 1: a vector of Events, in frame order
+// - param 2: a uint32_t, the frame
+// - return: an iterator to the event (or end())
+static std::vector<Replay::Event>::const_iterator firstEventAt(const std::vector<Replay::Event> &events, uint32_t frame)
+{
+	return std::lower_bound(events.begin(), events.end(), frame,
+		[](const Replay::Event &event, uint32_t at) { return event.frame < at; });
+}
+
+// start recording a new game (forgetting anything recorded before)
+// assert the game has not been stepped yet
+// - param 1: the TetrisEngine, at the start of its game
+// - return: nothing
+void Replay::start(const TetrisEngine &engine)
+{
+	assert(engine.getFrame() == 0 && "Replay - recording must start before the game is stepped");
+	rulesVersion = RULES_VERSION;
+	seed = engine.getSeed();
+	startLevel = engine.getLevel();
+	events.clear();
+	finalFrame = 0;
+	finalScore = 0;
+	std::memset(finalRows, 0, sizeof(finalRows));
+	finalChecksum = 0;
+	checksums.clear();
+	keyframeInterval = 0;
+	keyframes.clear();
+	keyframeBytes.clear();
+}
+
+// record an input
+// assert frames are recorded in order
+// - param 1: a uint32_t, the frame the input is given on (TetrisEngine::getFrame())
+// - param 2: the Input
+// - return: nothing
+void Replay::record(uint32_t frame, TetrisEngine::Input input)
+{
+	assert((events.empty() || events.back().frame <= frame) && "Replay - inputs must be recorded in frame order");
+	events.push_back({ frame, input });
+}
+
+// record the game's checksum, if it is on a frame that keeps one
+//   (call after every step - calling more often, or missing a few frames, is harmless)
+// - param 1: the TetrisEngine, just stepped
+// - return: nothing
+void Replay::recordChecksum(const TetrisEngine &engine)
+{
+	uint32_t frame = engine.getFrame();
+	if (frame % CHECKSUM_INTERVAL == 0 && frame / CHECKSUM_INTERVAL == checksums.size() + 1)
+	{
+		checksums.push_back(engine.getChecksum());
+	}
+}
+
+// record how the game ended (or where it stopped)
+// - param 1: the TetrisEngine, after its last input
+// - return: nothing
+void Replay::finish(const TetrisEngine &engine)
+{
+	finalFrame = engine.getFrame();
+	finalScore = engine.getScore();
+	std::memcpy(finalRows, engine.getBoard().getRowMasks(), sizeof(finalRows));
+	finalChecksum = engine.getChecksum();
+}
+
+// make an engine at the start of the recorded game
+// - params: none
+// - return: a TetrisEngine, seeded and at the starting level
+TetrisEngine Replay::createEngine() const
+{
+	TetrisEngine engine(seed);
+	if (startLevel != 0)
+	{
+		engine.setLevel(startLevel);
+	}
+	return engine;
+}
+
+// play the recording on an engine up to the start of a frame: give it the
+// inputs recorded on each frame from where it is, stepping it after each,
+// until it reaches the frame (whose own inputs are left to the next call)
+//   (the engine must be playing this replay's game, at or before the frame,
+//   with none of the inputs of the frame it is on given yet)
+// - param 1: the TetrisEngine
+// - param 2: a uint32_t, the frame to stop at
+// - return: nothing
+void Replay::playTo(TetrisEngine &engine, uint32_t frame) const
+{
+	auto next = firstEventAt(events, engine.getFrame());
+	while (engine.getFrame() < frame && !engine.getGameOver())
+	{
+		for (; next != events.end() && next->frame == engine.getFrame(); ++next)
+		{
+			engine.input(next->input);
+		}
+		// nothing happens between inputs but gravity: step straight to the next input (or the end)
+		uint32_t until = (next != events.end() && next->frame < frame) ? next->frame : frame;
+		while (engine.getFrame() < until && !engine.getGameOver())
+		{
+			engine.step();
+		}
+	}
+}
+
+// play the game through once, keeping a keyframe every interval shapes
+//   (replacing any keyframes there were)
+// assert interval is positive
+// - param 1: an int, the shapes between keyframes
+// - return: nothing
+void Replay::buildKeyframes(int interval)
+{
+	assert(interval > 0 && "Replay - keyframes need a positive interval");
+	keyframeInterval = interval;
+	keyframes.clear();
+	keyframeBytes.clear();
+
+	TetrisEngine engine = createEngine();
+	LockCounter counter;
+	engine.setListener(&counter);
+	uint32_t due = static_cast<uint32_t>(interval);
+	auto next = events.begin();
+	while (engine.getFrame() < finalFrame && !engine.getGameOver())
+	{
+		if (counter.shapes >= due)
+		{
+			keyframes.push_back({ counter.shapes, engine.getFrame(), static_cast<uint32_t>(keyframeBytes.size()) });
+			putState(keyframeBytes, engine.saveState());
+			due = counter.shapes + interval;
+		}
+		for (; next != events.end() && next->frame == engine.getFrame(); ++next)
+		{
+			engine.input(next->input);
+		}
+		engine.step();
+	}
+}
+
+// get the game at the start of the first frame on which a number of shapes
+// have been locked (or the end of the game, if it never gets that far)
+// - param 1: an int, the shapes locked
+// - return: a TetrisEngine, at that point (with no listener)
+TetrisEngine Replay::seekPiece(int piece) const
+{
+	TetrisEngine engine = createEngine();
+	LockCounter counter;
+	auto keyframe = std::upper_bound(keyframes.begin(), keyframes.end(), piece,
+		[](int wanted, const Keyframe &k) { return wanted < static_cast<int>(k.piece); });
+	if (keyframe != keyframes.begin())
+	{
+		--keyframe;
+		loadKeyframe(*keyframe, engine);
+		counter.shapes = keyframe->piece;
+	}
+
+	engine.setListener(&counter);
+	auto next = firstEventAt(events, engine.getFrame());
+	while (static_cast<int>(counter.shapes) < piece && engine.getFrame() < finalFrame && !engine.getGameOver())
+	{
+		for (; next != events.end() && next->frame == engine.getFrame(); ++next)
+		{
+			engine.input(next->input);
+		}
+		engine.step();
+	}
+	engine.setListener(nullptr);
+	return engine;
+}
+
+// get the game at the start of a frame (see playTo()), or at the end of the
+// game if the frame is later
+// - param 1: a uint32_t, the frame
+// - return: a TetrisEngine, at that point (with no listener)
+TetrisEngine Replay::seekFrame(uint32_t frame) const
+{
+	TetrisEngine engine = createEngine();
+	auto keyframe = std::upper_bound(keyframes.begin(), keyframes.end(), frame,
+		[](uint32_t wanted, const Keyframe &k) { return wanted < k.frame; });
+	if (keyframe != keyframes.begin())
+	{
+		loadKeyframe(*(keyframe - 1), engine);
+	}
+	playTo(engine, std::min(frame, finalFrame));
+	return engine;
+}
+
+// play the whole game back headless and check it ends as recorded
+// - params: none
+// - return: bool, true if every checksum and the final frame, score and board
+//   all match (false for a replay recorded with different rules)
+bool Replay::verify() const
+{
+	if (rulesVersion != RULES_VERSION)
+	{
+		return false;
+	}
+	TetrisEngine engine = createEngine();
+	return playBack(engine) == NO_DESYNC && engine.getFrame() == finalFrame && engine.getScore() == finalScore &&
+		std::memcmp(engine.getBoard().getRowMasks(), finalRows, sizeof(finalRows)) == 0;
+}
+
+// play the whole game back headless and find where it first drifts from the recording
+// - params: none
+// - return: a uint32_t, the first frame whose checksum differs from the one
+//   recorded (the final frame if only the end differs), or NO_DESYNC
+uint32_t Replay::findDesync() const
+{
+	TetrisEngine engine = createEngine();
+	return playBack(engine);
+}
+
+// pack the replay into bytes (see the top of this file)
+// - params: none
+// - return: a vector of bytes
+std::vector<uint8_t> Replay::encode() const
+{
+	std::vector<uint8_t> bytes(MAGIC, MAGIC + sizeof(MAGIC));
+	putVarint(bytes, FORMAT_VERSION);
+	putVarint(bytes, rulesVersion);
+	putVarint(bytes, seed);
+	putVarint(bytes, static_cast<uint32_t>(startLevel));
+	putVarint(bytes, events.size());
+	uint32_t frame = 0;
+	for (const Event &event : events)
+	{
+		putVarint(bytes, (static_cast<uint64_t>(event.frame - frame) << INPUT_BITS) | event.input);
+		frame = event.frame;
+	}
+	putVarint(bytes, finalFrame);
+	putVarint(bytes, static_cast<uint64_t>(finalScore));
+	for (uint16_t row : finalRows)
+	{
+		putVarint(bytes, row);
+	}
+	putFixed64(bytes, finalChecksum);
+	putVarint(bytes, checksums.size());
+	for (uint64_t checksum : checksums)
+	{
+		putFixed64(bytes, checksum);
+	}
+
+	putVarint(bytes, keyframeInterval);
+	putVarint(bytes, Randomizer::PACKED_SIZE);
+	putVarint(bytes, keyframeBytes.size());
+	bytes.insert(bytes.end(), keyframeBytes.begin(), keyframeBytes.end());
+	uint32_t index = static_cast<uint32_t>(bytes.size());
+	putVarint(bytes, keyframes.size());
+	Keyframe previous{ 0, 0, 0 };
+	for (const Keyframe &keyframe : keyframes)
+	{
+		putVarint(bytes, keyframe.piece - previous.piece);
+		putVarint(bytes, keyframe.frame - previous.frame);
+		putVarint(bytes, keyframe.offset - previous.offset);
+		previous = keyframe;
+	}
+	for (int i = 0; i < FOOTER_SIZE; i++)
+	{
+		bytes.push_back(static_cast<uint8_t>(index >> (8 * i)));
+	}
+	return bytes;
+}
+
+// unpack a replay packed by encode()
+// - param 1: a pointer to the bytes
+// - param 2: a size_t, the number of bytes
+// - return: bool, true if the bytes held a whole replay (if not, the replay is unchanged)
+bool Replay::decode(const uint8_t *data, size_t size)
+{
+	const uint8_t *next = data;
+	const uint8_t *end = data + size;
+	if (size < sizeof(MAGIC) || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0)
+	{
+		return false;
+	}
+	next += sizeof(MAGIC);
+
+	Replay replay;
+	uint32_t format;
+	uint32_t level;
+	uint64_t count;
+	if (!getVarint32(next, end, format) || format != FORMAT_VERSION ||
+		!getVarint32(next, end, replay.rulesVersion) || !getVarint(next, end, replay.seed) ||
+		!getVarint32(next, end, level) || level > INT32_MAX ||
+		!getVarint(next, end, count) || count > static_cast<uint64_t>(end - next))	// (every event takes a byte or more)
+	{
+		return false;
+	}
+	replay.startLevel = static_cast<int>(level);
+
+	replay.events.resize(static_cast<size_t>(count));
+	uint64_t frame = 0;
+	for (Event &event : replay.events)
+	{
+		uint64_t packed;
+		if (!getVarint(next, end, packed) || (packed & ((1 << INPUT_BITS) - 1)) > TetrisEngine::HARD_DROP)
+		{
+			return false;
+		}
+		frame += packed >> INPUT_BITS;
+		if (frame > UINT32_MAX)
+		{
+			return false;
+		}
+		event.frame = static_cast<uint32_t>(frame);
+		event.input = static_cast<TetrisEngine::Input>(packed & ((1 << INPUT_BITS) - 1));
+	}
+
+	uint64_t score;
+	if (!getVarint32(next, end, replay.finalFrame) || !getVarint(next, end, score) || score > INT64_MAX)
+	{
+		return false;
+	}
+	replay.finalScore = static_cast<int64_t>(score);
+	for (uint16_t &row : replay.finalRows)
+	{
+		uint32_t mask;
+		if (!getVarint32(next, end, mask) || mask > Gameboard::FULL_ROW_MASK)
+		{
+			return false;
+		}
+		row = static_cast<uint16_t>(mask);
+	}
+	if (!getFixed64(next, end, replay.finalChecksum) || !getVarint(next, end, count) ||
+		count > static_cast<uint64_t>(end - next) / 8)
+	{
+		return false;
+	}
+	replay.checksums.resize(static_cast<size_t>(count));
+	for (uint64_t &checksum : replay.checksums)
+	{
+		getFixed64(next, end, checksum);
+	}
+	if (!replay.decodeKeyframes(data, next, end))
+	{
+		return false;
+	}
+	if (next != end)
+	{
+		return false;
+	}
+	*this = replay;
+	return true;
+}
+
+// write the encoded replay to a file
+// - param 1: a string, the file's path
+// - return: bool, true if the file was written
+bool Replay::save(const std::string &path) const
+{
+	std::vector<uint8_t> bytes = encode();
+	std::ofstream file(path, std::ios::binary);
+	file.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+	return static_cast<bool>(file);
+}
+
+// read a replay from a file written by save()
+// - param 1: a string, the file's path
+// - return: bool, true if the file was read and decoded
+bool Replay::load(const std::string &path)
+{
+	std::ifstream file(path, std::ios::binary);
+	if (!file)
+	{
+		return false;
+	}
+	std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+	return decode(bytes.data(), bytes.size());
+}
+
+uint32_t Replay::getRulesVersion() const
+{
+	return rulesVersion;
+}
+
+uint64_t Replay::getSeed() const
+{
+	return seed;
+}
+
+int Replay::getStartLevel() const
+{
+	return startLevel;
+}
+
+const std::vector<Replay::Event> &Replay::getEvents() const
+{
+	return events;
+}
+
+int Replay::getKeyframeInterval() const
+{
+	return keyframeInterval;
+}
+
+const std::vector<Replay::Keyframe> &Replay::getKeyframes() const
+{
+	return keyframes;
+}
+
+uint32_t Replay::getFinalFrame() const
+{
+	return finalFrame;
+}
+
+int64_t Replay::getFinalScore() const
+{
+	return finalScore;
+}
+
+uint64_t Replay::getFinalChecksum() const
+{
+	return finalChecksum;
+}
+
+const std::vector<uint64_t> &Replay::getChecksums() const
+{
+	return checksums;
+}
+
+// load a keyframe into an engine
+// - param 1: the Keyframe
+// - param 2: the TetrisEngine, set to the snapshot
+// - return: nothing
+void Replay::loadKeyframe(const Keyframe &keyframe, TetrisEngine &engine) const
+{
+	const uint8_t *next = keyframeBytes.data() + keyframe.offset;
+	GameState state;
+	bool loaded = getState(next, keyframeBytes.data() + keyframeBytes.size(), state);
+	assert(loaded && "Replay - keyframes are checked when decoded");
+	(void)loaded;
+	engine.loadState(state);
+}
+
+// play the whole recording on an engine (the inputs of the final frame too),
+// checking the checksums as it goes
+// - param 1: the TetrisEngine, at the start of the game
+// - return: a uint32_t, as findDesync()
+uint32_t Replay::playBack(TetrisEngine &engine) const
+{
+	for (size_t i = 0; i < checksums.size(); i++)
+	{
+		uint32_t frame = static_cast<uint32_t>((i + 1) * CHECKSUM_INTERVAL);
+		playTo(engine, frame);
+		if (engine.getFrame() != frame || engine.getChecksum() != checksums[i])
+		{
+			return frame;
+		}
+	}
+	playTo(engine, finalFrame);
+	if (engine.getFrame() == finalFrame)
+	{
+		// finish() was called after the inputs of the last frame
+		for (auto event = firstEventAt(events, finalFrame); event != events.end(); ++event)
+		{
+			engine.input(event->input);
+		}
+	}
+	return (engine.getChecksum() != finalChecksum) ? finalFrame : NO_DESYNC;
+}
+
+// read the keyframe section and index of an encoded replay, checking every keyframe
+// - param 1: a pointer to the first byte of the encoded replay
+// - param 2: a pointer to the section, moved past it (and the footer)
+// - param 3: a pointer just past the last byte
+// - return: bool, false if the section is damaged
+bool Replay::decodeKeyframes(const uint8_t *data, const uint8_t *&next, const uint8_t *end)
+{
+	uint32_t interval;
+	uint32_t layout;
+	uint32_t size;
+	if (!getVarint32(next, end, interval) || interval > INT32_MAX || !getVarint32(next, end, layout) ||
+		!getVarint32(next, end, size) || size > static_cast<size_t>(end - next))
+	{
+		return false;
+	}
+	const uint8_t *packed = next;
+	next += size;
+
+	// the index
+	uint32_t index = static_cast<uint32_t>(next - data);
+	uint64_t count;
+	if (!getVarint(next, end, count) || count > size)	// (every keyframe takes bytes)
+	{
+		return false;
+	}
+	std::vector<Keyframe> found(static_cast<size_t>(count));
+	uint64_t piece = 0;
+	uint64_t frame = 0;
+	uint64_t offset = 0;
+	for (Keyframe &keyframe : found)
+	{
+		uint64_t delta[3];
+		for (uint64_t &d : delta)
+		{
+			if (!getVarint(next, end, d) || d > UINT32_MAX)
+			{
+				return false;
+			}
+		}
+		piece += delta[0];
+		frame += delta[1];
+		offset += delta[2];
+		if (piece > UINT32_MAX || frame > UINT32_MAX || offset >= size)
+		{
+			return false;
+		}
+		keyframe = { static_cast<uint32_t>(piece), static_cast<uint32_t>(frame), static_cast<uint32_t>(offset) };
+	}
+
+	// the footer points back at the index
+	if (end - next < FOOTER_SIZE)
+	{
+		return false;
+	}
+	uint32_t footer = 0;
+	for (int i = 0; i < FOOTER_SIZE; i++)
+	{
+		footer |= static_cast<uint32_t>(*next++) << (8 * i);
+	}
+	if (footer != index)
+	{
+		return false;
+	}
+
+	if (layout != Randomizer::PACKED_SIZE)
+	{
+		return true;	// recorded with another Randomizer layout: seek from the start instead
+	}
+
+	// each keyframe must unpack, filling exactly the bytes up to the next one
+	for (size_t i = 0; i < found.size(); i++)
+	{
+		const uint8_t *at = packed + found[i].offset;
+		const uint8_t *stop = packed + ((i + 1 < found.size()) ? found[i + 1].offset : size);
+		GameState state;
+		if (at >= stop || !getState(at, stop, state) || at != stop)
+		{
+			return false;
+		}
+	}
+	keyframeInterval = static_cast<int>(interval);
+	keyframes = found;
+	keyframeBytes.assign(packed, packed + size);
+	return true;
+}
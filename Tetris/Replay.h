@@ -0,0 +1,233 @@
+// A Replay is a recording of one game: where it started and every input, with
+// the frame it was given on.
+//
+// A TetrisEngine game is exactly reproducible from its seed and the frame number
+// of each input (see TetrisEngine.h), so that is all a replay keeps - plus how the
+// game ended, so a playback can check it came out the same:
+//   - the rules version (RULES_VERSION, bumped whenever a change to the engine
+//     would make old games play out differently), the seed and the starting level
+//   - the inputs, in the order they were given, each with its frame number
+//   - the final frame, score and board (its row masks)
+//   - the game's checksum (TetrisEngine::getChecksum()) every CHECKSUM_INTERVAL
+//     frames, and at the end
+//
+// Recording sits at the engine's input boundary: start() when a game begins,
+// record() for every input handed to TetrisEngine::input() (whatever the input
+// came from - keys, a bot, a script), recordChecksum() after every step, and
+// finish() when it ends.
+//
+// encode() packs a replay into bytes: numbers are unsigned LEB128 varints (7 bits
+// a byte, small numbers take 1 byte), and each input is one varint holding the
+// frames since the previous input and the input itself (delta << 3 | input).
+// Players give a few inputs a second, so most inputs take 1 or 2 bytes and a
+// whole game fits in a few kilobytes.
+//
+// verify() plays a replay back headless, stepping the engine as fast as it will
+// go with nothing drawn, and checks the checksums along the way and the final
+// frame, score and board.  When a build plays a game differently from the one
+// that recorded it, findDesync() names the first second of play that differs.
+//
+// Keyframes make seeking quick.  buildKeyframes() plays the game through once and
+// keeps a snapshot of the whole game state (see GameState.h) every N shapes, each
+// packed to about a hundred bytes: the board as its row masks plus a 4-bit color
+// per filled cell, the shapes as shape/rotation/x/y, the randomizer field by
+// field (see Randomizer::pack()), and the rest as varints.  seekPiece() and
+// seekFrame() load the last keyframe before the point wanted and play only the
+// few frames after it.
+//
+// An encoded replay with keyframes is laid out as
+//   "TRPL", format, rules, seed, level, inputs, ending		(as above)
+//   the final checksum (8 bytes), the count of checksums, then each (8 bytes)
+//   keyframe interval, randomizer size, the packed snapshots
+//   the index: the count, then each keyframe's shape number, frame and byte offset (as deltas)
+//   the footer: the byte offset of the index (4 bytes, little endian)
+// so a reader can go straight to the index from the end of the file.  Every
+// keyframe is unpacked and checked when a replay is decoded, and a replay with
+// one that doesn't unpack is turned away.  Keyframes with a randomizer size other
+// than Randomizer::PACKED_SIZE are dropped (the replay itself still plays back;
+// seeking just starts from the beginning).
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "Gameboard.h"
+#include "TetrisEngine.h"
+
+class Replay
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+public:
+	// CONSTANTS
+	static const uint32_t RULES_VERSION = 1;	// the engine rules a replay was recorded with
+	static const uint32_t FORMAT_VERSION = 1;	// the layout encode() writes
+	static const int KEYFRAME_INTERVAL = 50;	// the shapes between keyframes, by default
+	static const uint32_t CHECKSUM_INTERVAL = 60;	// the frames between recorded checksums (a second of play)
+	static const uint32_t NO_DESYNC = UINT32_MAX;	// findDesync() when the playback matches
+
+	// an input and the frame it was given on (TetrisEngine::getFrame() at the time)
+	struct Event
+	{
+		uint32_t frame;
+		TetrisEngine::Input input;
+	};
+
+	// a snapshot of the game at the start of a frame
+	struct Keyframe
+	{
+		uint32_t piece;		// shapes locked before the frame
+		uint32_t frame;
+		uint32_t offset;	// where its packed GameState starts in keyframeBytes
+	};
+
+private:
+	// MEMBER VARIABLES
+	uint32_t rulesVersion{ RULES_VERSION };
+	uint64_t seed{ 0 };
+	int startLevel{ 0 };
+	std::vector<Event> events;
+
+	// how the game ended (set by finish())
+	uint32_t finalFrame{ 0 };
+	int64_t finalScore{ 0 };
+	uint16_t finalRows[Gameboard::MAX_Y]{};
+	uint64_t finalChecksum{ 0 };
+
+	// the checksums
+	std::vector<uint64_t> checksums;		// checksums[i] is the game's checksum on frame (i + 1) * CHECKSUM_INTERVAL
+
+	// seeking (set by buildKeyframes())
+	int keyframeInterval{ 0 };				// shapes between keyframes (0 for no keyframes)
+	std::vector<Keyframe> keyframes;		// in order
+	std::vector<uint8_t> keyframeBytes;		// the keyframes' packed GameStates
+
+public:
+	// start recording a new game (forgetting anything recorded before)
+	// assert the game has not been stepped yet
+	// - param 1: the TetrisEngine, at the start of its game
+	// - return: nothing
+	void start(const TetrisEngine &engine);
+
+	// record an input
+	// assert frames are recorded in order
+	// - param 1: a uint32_t, the frame the input is given on (TetrisEngine::getFrame())
+	// - param 2: the Input
+	// - return: nothing
+	void record(uint32_t frame, TetrisEngine::Input input);
+
+	// record the game's checksum, if it is on a frame that keeps one
+	//   (call after every step - calling more often, or missing a few frames, is harmless)
+	// - param 1: the TetrisEngine, just stepped
+	// - return: nothing
+	void recordChecksum(const TetrisEngine &engine);
+
+	// record how the game ended (or where it stopped)
+	// - param 1: the TetrisEngine, after its last input
+	// - return: nothing
+	void finish(const TetrisEngine &engine);
+
+	// make an engine at the start of the recorded game
+	// - params: none
+	// - return: a TetrisEngine, seeded and at the starting level
+	TetrisEngine createEngine() const;
+
+	// play the recording on an engine up to the start of a frame: give it the
+	// inputs recorded on each frame from where it is, stepping it after each,
+	// until it reaches the frame (whose own inputs are left to the next call)
+	//   (the engine must be playing this replay's game, at or before the frame,
+	//   with none of the inputs of the frame it is on given yet)
+	// - param 1: the TetrisEngine
+	// - param 2: a uint32_t, the frame to stop at
+	// - return: nothing
+	void playTo(TetrisEngine &engine, uint32_t frame) const;
+
+	// play the game through once, keeping a keyframe every interval shapes
+	//   (replacing any keyframes there were)
+	// assert interval is positive
+	// - param 1: an int, the shapes between keyframes
+	// - return: nothing
+	void buildKeyframes(int interval = KEYFRAME_INTERVAL);
+
+	// get the game at the start of the first frame on which a number of shapes
+	// have been locked (or the end of the game, if it never gets that far)
+	// - param 1: an int, the shapes locked
+	// - return: a TetrisEngine, at that point (with no listener)
+	TetrisEngine seekPiece(int piece) const;
+
+	// get the game at the start of a frame (see playTo()), or at the end of the
+	// game if the frame is later
+	// - param 1: a uint32_t, the frame
+	// - return: a TetrisEngine, at that point (with no listener)
+	TetrisEngine seekFrame(uint32_t frame) const;
+
+	// play the whole game back headless and check it ends as recorded
+	// - params: none
+	// - return: bool, true if every checksum and the final frame, score and board
+	//   all match (false for a replay recorded with different rules)
+	bool verify() const;
+
+	// play the whole game back headless and find where it first drifts from the recording
+	// - params: none
+	// - return: a uint32_t, the first frame whose checksum differs from the one
+	//   recorded (the final frame if only the end differs), or NO_DESYNC
+	uint32_t findDesync() const;
+
+	// pack the replay into bytes (see the top of this file)
+	// - params: none
+	// - return: a vector of bytes
+	std::vector<uint8_t> encode() const;
+
+	// unpack a replay packed by encode()
+	// - param 1: a pointer to the bytes
+	// - param 2: a size_t, the number of bytes
+	// - return: bool, true if the bytes held a whole replay (if not, the replay is unchanged)
+	bool decode(const uint8_t *data, size_t size);
+
+	// write the encoded replay to a file
+	// - param 1: a string, the file's path
+	// - return: bool, true if the file was written
+	bool save(const std::string &path) const;
+
+	// read a replay from a file written by save()
+	// - param 1: a string, the file's path
+	// - return: bool, true if the file was read and decoded
+	bool load(const std::string &path);
+
+	// getters for the recording
+	// - params: none
+	// - return: the matching member (see above)
+	uint32_t getRulesVersion() const;
+	uint64_t getSeed() const;
+	int getStartLevel() const;
+	const std::vector<Event> &getEvents() const;
+	uint32_t getFinalFrame() const;
+	int64_t getFinalScore() const;
+	uint64_t getFinalChecksum() const;
+	const std::vector<uint64_t> &getChecksums() const;
+	int getKeyframeInterval() const;
+	const std::vector<Keyframe> &getKeyframes() const;
+
+private:
+	// load a keyframe into an engine
+	// - param 1: the Keyframe
+	// - param 2: the TetrisEngine, set to the snapshot
+	// - return: nothing
+	void loadKeyframe(const Keyframe &keyframe, TetrisEngine &engine) const;
+
+	// play the whole recording on an engine (the inputs of the final frame too),
+	// checking the checksums as it goes
+	// - param 1: the TetrisEngine, at the start of the game
+	// - return: a uint32_t, as findDesync()
+	uint32_t playBack(TetrisEngine &engine) const;
+
+	// read the keyframe section and index of an encoded replay, checking every keyframe
+	// - param 1: a pointer to the first byte of the encoded replay
+	// - param 2: a pointer to the section, moved past it (and the footer)
+	// - param 3: a pointer just past the last byte
+	// - return: bool, false if the section is damaged
+	bool decodeKeyframes(const uint8_t *data, const uint8_t *&next, const uint8_t *end);
+};
+
+#endif /* REPLAY_H */
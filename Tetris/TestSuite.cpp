@@ -16,10 +16,124 @@
 #include "GridTetromino.h"
 #endif
 
+#ifdef WALLKICKS
+#include "WallKicks.h"
+#include "TetrominoTables.h"
+#endif
+
+#ifdef RANDOMIZER
+#include <cstring>
+#include <vector>
+#include "Randomizer.h"
+#endif
+
+#ifdef TETRISENGINE
+#include <cstring>
+#include "TetrisEngine.h"
+#endif
+
+#ifdef FIXEDTIMESTEP
+#include "FixedTimestep.h"
+#endif
+
+#ifdef MOVEGENERATOR
+#include <algorithm>
+#include <array>
+#include <set>
+#include <vector>
+#include "InputPolicy.h"
+#include "MoveGenerator.h"
+#include "Randomizer.h"
+#include "TetrisEngine.h"
+#include "WallKicks.h"
+#endif
+
+#ifdef PERFT
+#include "Perft.h"
+#endif
+
+#ifdef BOARDFEATURES
+#include <cstring>
+#include "BoardFeatures.h"
+#include "Randomizer.h"
+#endif
+
+#ifdef BATCHLEGALITY
+#include <algorithm>
+#include <vector>
+#include "BatchLegality.h"
+#include "Randomizer.h"
+#include "TetrominoTables.h"
+#endif
+
+#ifdef BATCHTETRIS
+#include <vector>
+#include "BatchTetris.h"
+#include "Randomizer.h"
+#include "TetrisEngine.h"
+#endif
+
+#ifdef GAMEFARM
+#include <memory>
+#include <vector>
+#include "GameFarm.h"
+#include "InputPolicy.h"
+#endif
+
+#ifdef REPLAY
+#include <vector>
+#include "InputPolicy.h"
+#include "Replay.h"
+#include "TetrisEngine.h"
+#endif
+
+#ifdef KEYFRAMES
+#include <vector>
+#include "InputPolicy.h"
+#include "Randomizer.h"
+#include "Replay.h"
+#include "TetrisEngine.h"
+#endif
+
+#ifdef CHECKSUM
+#include "Gameboard.h"
+#include "InputPolicy.h"
+#include "Replay.h"
+#include "TetrisEngine.h"
+#endif
+
+#ifdef ZOBRIST
+#include <thread>
+#include <vector>
+#include "Gameboard.h"
+#include "TetrisEngine.h"
+#include "TranspositionTable.h"
+#endif
+
+#ifdef BEAMSEARCH
+#include <algorithm>
+#include <vector>
+#include "BeamSearch.h"
+#include "MoveGenerator.h"
+#include "TetrisEngine.h"
+#include "WorkerPool.h"
+#endif
+
+#ifdef EXPECTIMAX
+#include "ExpectimaxSearch.h"
+#include "MoveGenerator.h"
+#include "TetrisEngine.h"
+#endif
+
 #include <cassert>
 #include <iostream>
 #include <string>
 
+#ifdef ALLOCATIONS
+#include "../Tests/CountingAllocator.h"
+#include "TetrisEngine.h"
+#endif
+
 
 
 void TestSuite::runTestSuite()
@@ -31,6 +145,23 @@ void TestSuite::runTestSuite()
 	testTetrominoClass();
 	testGameboardClass();
 	testGridTetrominoClass();
+	testMovementAllocations();
+	testWallKicks();
+	testRandomizerClass();
+	testTetrisEngineClass();
+	testFixedTimestepClass();
+	testMoveGenerator();
+	testPerft();
+	testBoardFeatures();
+	testBatchLegality();
+	testBatchTetrisClass();
+	testGameFarmClass();
+	testReplayClass();
+	testReplayKeyframes();
+	testChecksum();
+	testZobrist();
+	testBeamSearch();
+	testExpectimax();
 	std::cout << "=== TestSuite complete ========================" << "\n\n";
 }
 
@@ -167,36 +298,54 @@ void TestSuite::testTetrominoClass()
 
 	int blockcount = BLOCK_COUNT;
 
-	assert(t.blockLocs.size() == blockcount &&
+	assert(t.getBlockLocs().size() == blockcount &&
 		"default Tetromino has no blockLocs - likely because no default set in constructor");
 
 	t.setShape(TetShape::S);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be: 4");
+	assert(t.getBlockLocs().size() == blockcount && "Tetromino shape size should be: 4");
 	t.setShape(TetShape::Z);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
+	assert(t.getBlockLocs().size() == blockcount && "Tetromino shape size should be 4");
 	t.setShape(TetShape::L);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
+	assert(t.getBlockLocs().size() == blockcount && "Tetromino shape size should be 4");
 	t.setShape(TetShape::J);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
+	assert(t.getBlockLocs().size() == blockcount && "Tetromino shape size should be 4");
 	t.setShape(TetShape::O);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
+	assert(t.getBlockLocs().size() == blockcount && "Tetromino shape size should be 4");
 	t.setShape(TetShape::I);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
+	assert(t.getBlockLocs().size() == blockcount && "Tetromino shape size should be 4");
 	t.setShape(TetShape::T);
-	assert(t.blockLocs.size() == blockcount && "Tetromino shape size should be 4");
+	assert(t.getBlockLocs().size() == blockcount && "Tetromino shape size should be 4");
 
 
-	// test the rotate functionality of a single block
-	t.blockLocs.clear();
-	t.blockLocs.push_back(Point(1, 2));
-	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == 2 && t.blockLocs[0].getY() == -1 && "Tetromino::rotateClockwise() failed");
-	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == -1 && t.blockLocs[0].getY() == -2 && "Tetromino::rotateClockwise() failed");
-	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == -2 && t.blockLocs[0].getY() == 1 && "Tetromino::rotateClockwise() failed");
+	// test the rotate functionality against rotating each block point by point
+	// (a point [1,2] rotated clockwise around [0,0] becomes [2,-1])
+	for (int shape = 0; shape < TetShape::COUNT; shape++)
+	{
+		t.setShape(static_cast<TetShape>(shape));
+		for (int rotation = 0; rotation < 4; rotation++)
+		{
+			BlockList expected = t.getBlockLocs();
+			for (auto& block : expected)
+			{
+				if (shape != TetShape::O)
+				{
+					block.multiplyX(-1);
+					block.swapXY();
+				}
+			}
+			t.rotateClockwise();
+			assert(t.getRotation() == (rotation + 1) % 4 && "Tetromino::rotateClockwise() did not step the rotation");
+			for (int i = 0; i < blockcount; i++)
+			{
+				assert(t.getBlockLocs()[i].getX() == expected[i].getX() && t.getBlockLocs()[i].getY() == expected[i].getY() &&
+					"Tetromino::rotateClockwise() failed");
+			}
+		}
+		assert(t.getRotation() == 0 && "Tetromino::rotateClockwise() 4 rotations should return to the start");
+	}
+	t.setShape(TetShape::T);
 	t.rotateClockwise();
-	assert(t.blockLocs[0].getX() == 1 && t.blockLocs[0].getY() == 2 && "Tetromino::rotateClockwise() failed");
+	assert(t.getBlockLocs()[3].getX() == -1 && t.getBlockLocs()[3].getY() == 0 && "Tetromino::rotateClockwise() failed");
 
 	// ensure const methods are actually const
 	// These lines will cause compile time errors you have methods in your Tetromino class that
@@ -328,6 +477,21 @@ void TestSuite::testGameboardClass()
 	assert(g.getContent(0, 3) == 2 && "Gameboard.removeRows() seems to have failed");
 	assert(g.getContent(0, 4) == 4 && "Gameboard.removeRows() seems to have failed");
 
+	// test the occupancy masks stay in step with the grid content
+	g.empty();
+	assert(g.getRowMask(0) == 0 && "Gameboard.getRowMask() expected an empty row mask");
+	g.setContent(0, 0, 1);
+	g.setContent(3, 0, 2);
+	assert(g.getRowMask(0) == ((1 << 0) | (1 << 3)) && "Gameboard.setContent() did not update the row mask");
+	g.setContent(0, 0, Gameboard::EMPTY_BLOCK);
+	assert(g.getRowMask(0) == (1 << 3) && "Gameboard.setContent() did not clear the row mask");
+	g.fillRow(1, 4);
+	g.copyRowIntoRow(1, 5);
+	assert(g.getRowMask(5) == Gameboard::FULL_ROW_MASK && "Gameboard.copyRowIntoRow() did not copy the row mask");
+	assert(g.getRowMask(-1) == 0 && "Gameboard.getRowMask() rows above the board should read as empty");
+	assert(g.getRowMask(Gameboard::MAX_Y) == Gameboard::FULL_ROW_MASK &&
+		"Gameboard.getRowMask() rows below the board should read as full");
+
 	// test getCompletedRowIndices()
 	g.empty();
 	assert(g.getCompletedRowIndices().size() == 0 &&
@@ -365,6 +529,63 @@ void TestSuite::testGameboardClass()
 	assert(g.getContent(1, 4) == Gameboard::EMPTY_BLOCK && "Gameboard.removeCompletedRows() unexpected results");	// row 4 is still empty
 
 
+	// test collapseCompletedRows() reports the cleared rows and compacts in one pass
+	g.empty();
+	for (int y = 10; y < Gameboard::MAX_Y; y++)
+	{
+		g.fillRow(y, y % 10);
+		if (y % 2 == 1)
+		{
+			g.setContent(y % 10, y, Gameboard::EMPTY_BLOCK);	// leave a gap in odd rows
+		}
+	}
+	Gameboard::RowClear rowClear = g.collapseCompletedRows();
+	assert(rowClear.count == 5 && rowClear.rowIndices[0] == 10 && rowClear.rowIndices[4] == 18 &&
+		"Gameboard.collapseCompletedRows() does not return expected results");
+	assert(g.getContent(0, 18) == 7 && g.getContent(7, 18) == Gameboard::EMPTY_BLOCK &&
+		"Gameboard.collapseCompletedRows() unexpected results");	// row 17 copied into row 18
+	assert(g.getContent(0, 15) == 1 && g.getContent(1, 15) == Gameboard::EMPTY_BLOCK &&
+		"Gameboard.collapseCompletedRows() unexpected results");	// row 11 copied into row 15
+	assert(g.getRowMask(14) == 0 && g.getCompletedRowIndices().size() == 0 &&
+		"Gameboard.collapseCompletedRows() unexpected results");	// vacated rows are empty
+
+	// test the row fill counts and lockBlocks() only reporting rows it touched
+	g.empty();
+	g.fillRow(8, 3);	// complete, but not touched by the lock below
+	g.fillRow(5, 3);
+	g.setContent(0, 5, Gameboard::EMPTY_BLOCK);
+	g.setContent(0, 5, Gameboard::EMPTY_BLOCK);	// clearing an empty cell must not change the count
+	assert(g.rowFill[5] == Gameboard::MAX_X - 1 && g.rowFill[8] == Gameboard::MAX_X &&
+		"Gameboard row fill counts do not match the grid");
+	BlockList lockPoints = { Point(0, 5), Point(0, 4), Point(1, 4), Point(-1, 4) };
+	Gameboard::RowClear lockClear = g.lockBlocks(lockPoints, 1);
+	assert(lockClear.count == 1 && lockClear.rowIndices[0] == 5 &&
+		"Gameboard.lockBlocks() should only report the completed rows it touched");
+	assert(g.rowFill[4] == 2 && "Gameboard.lockBlocks() did not update the row fill count");
+	g.removeRows(lockClear);
+	assert(g.rowFill[5] == 2 && g.rowFill[4] == 0 && g.rowFill[8] == Gameboard::MAX_X &&
+		"Gameboard.removeRows() did not move the row fill counts");
+
+	// test the skyline and drop distances
+	g.empty();
+	assert(g.getColumnHeight(0) == 0 && "Gameboard.getColumnHeight() expected an empty column");
+	g.setContent(2, 15, 1);
+	g.setContent(2, 17, 1);
+	assert(g.getColumnHeight(2) == Gameboard::MAX_Y - 15 && "Gameboard.getColumnHeight() unexpected result");
+	g.setContent(2, 15, Gameboard::EMPTY_BLOCK);
+	assert(g.getColumnHeight(2) == Gameboard::MAX_Y - 17 && "Gameboard.getColumnHeight() did not drop after a clear");
+	BlockList dropPoints = { Point(1, 0), Point(2, 0), Point(2, -1) };
+	assert(g.getDropDistance(dropPoints) == 16 && "Gameboard.getDropDistance() above the skyline unexpected result");
+	BlockList tuckPoints = { Point(2, 18) };	// under the overhang at row 17
+	assert(g.getDropDistance(tuckPoints) == 0 && "Gameboard.getDropDistance() under an overhang unexpected result");
+	tuckPoints = { Point(2, 17) };
+	assert(g.getDropDistance(tuckPoints) == -1 && "Gameboard.getDropDistance() should report a blocked position");
+	g.fillRow(18, 1);
+	g.setContent(2, 18, Gameboard::EMPTY_BLOCK);
+	g.fillRow(16, 1);
+	assert(g.removeCompletedRows() == 1 && g.getColumnHeight(2) == 2 && g.getColumnHeight(0) == 1 &&
+		"Gameboard skyline was not updated by removing rows");
+
 	// test areLocsEmpty()
 	g.empty();
 	g.fillRow(2, 2);
@@ -466,11 +687,11 @@ void TestSuite::testGameboardClass()
 	assert(gt.getGridLoc().getX() == 6 && gt.getGridLoc().getY() == 7);
 
 
-	// test getBlockLocsMappedToGrid()
-	gt.blockLocs = { Point(1,2) };
+	// test getBlockLocsMappedToGrid() (a T's second block is at [-1,0])
+	gt.setShape(TetShape::T);
 	gt.setGridLoc(5, 5);
-	std::vector<Point> locs = gt.getBlockLocsMappedToGrid();
-	assert(locs[0].getX() == 6 && locs[0].getY() == 7);
+	BlockList locs = gt.getBlockLocsMappedToGrid();
+	assert(locs[1].getX() == 4 && locs[1].getY() == 5);
 
 	// A const gridTetromino should be able to call the following methods
 	// (since these methods don't change the state of the class)
@@ -493,3 +714,1604 @@ void TestSuite::testGameboardClass()
 
 
 
+
+void TestSuite::testMovementAllocations()
+{
+#ifdef ALLOCATIONS
+	announceTest("Allocations");
+
+	// moves and rotates through the engine (each a legality check, wall kicks and
+	// a ghost update), with the shapes falling, locking and clearing rows between them
+	TetrisEngine engine(7);
+	const TetrisEngine::Input INPUTS[] = { TetrisEngine::MOVE_RIGHT, TetrisEngine::ROTATE, TetrisEngine::MOVE_LEFT,
+		TetrisEngine::ROTATE, TetrisEngine::MOVE_LEFT, TetrisEngine::SOFT_DROP };
+	long long before = allocationCount;
+	for (int i = 0; i < 1000 && !engine.getGameOver(); i++)
+	{
+		engine.input(INPUTS[i % 6]);
+		engine.step();
+		assert(allocationCount == before && "moving a shape should not allocate");
+	}
+
+	announceTestCompletion();
+#else
+	announceNotTested("Allocations");
+#endif
+}
+
+void TestSuite::testWallKicks()
+{
+#ifdef WALLKICKS
+	announceTest("WallKicks");
+
+	Gameboard board;
+	Point kick;
+
+	// a T in open space rotates without a kick
+	assert(WallKicks::resolveClockwise(board, TetShape::T, 0, 5, 10, kick) == true &&
+		kick.getX() == 0 && kick.getY() == 0 && "WallKicks::resolveClockwise() should not kick in open space");
+
+	// an upright I (SRS state R) against the left wall lies flat (R -> 0) by kicking two right
+	assert(WallKicks::resolveClockwise(board, TetShape::I, 0, 0, 10, kick) == true &&
+		kick.getX() == 2 && kick.getY() == 0 && "WallKicks::resolveClockwise() expected the I to kick off the wall");
+
+	// a T pointing right (R) against the left wall turns to point up (R -> 0) by kicking one right
+	assert(WallKicks::resolveClockwise(board, TetShape::T, 3, 0, 10, kick) == true &&
+		kick.getX() == 1 && kick.getY() == 0 && "WallKicks::resolveClockwise() expected the T to kick off the wall");
+
+	// a T pointing up beside a slot with an overhang turns into it (0 -> L) by its last
+	// kick, one right and two down, and clears the three rows it completes (a T-spin triple)
+	for (int y = 15; y < Gameboard::MAX_Y; y++)
+	{
+		board.fillRow(y, 1);
+	}
+	board.setContent(0, 18, Gameboard::EMPTY_BLOCK);
+	board.setContent(4, 15, Gameboard::EMPTY_BLOCK);
+	board.setContent(3, 16, Gameboard::EMPTY_BLOCK);
+	board.setContent(4, 16, Gameboard::EMPTY_BLOCK);
+	board.setContent(4, 17, Gameboard::EMPTY_BLOCK);
+	board.setContent(4, 13, 1);
+	assert(WallKicks::resolveClockwise(board, TetShape::T, 0, 3, 14, kick) == true &&
+		kick.getX() == 1 && kick.getY() == 2 && "WallKicks::resolveClockwise() expected the T to kick into the T-spin slot");
+	GridTetromino spun;
+	spun.setShape(TetShape::T);
+	spun.rotateClockwise();
+	spun.setGridLoc(3 + kick.getX(), 14 + kick.getY());
+	board.lockBlocks(spun.getBlockLocsMappedToGrid(), spun.getColor());
+	assert(board.removeCompletedRows() == 3 && "Gameboard - the T-spin triple should clear three rows");
+
+	// ...unless every candidate is blocked
+	board.empty();
+	board.fillRow(10, 1);
+	board.fillRow(9, 1);
+	board.setContent(0, 10, Gameboard::EMPTY_BLOCK);
+	board.setContent(0, 9, Gameboard::EMPTY_BLOCK);
+	assert(WallKicks::resolveClockwise(board, TetShape::I, 0, 0, 10, kick) == false &&
+		"WallKicks::resolveClockwise() should fail when every kick is blocked");
+
+	// an O never kicks, and always fits where it already is
+	assert(WallKicks::resolveClockwise(board, TetShape::O, 2, 4, 0, kick) == true &&
+		kick.getX() == 0 && kick.getY() == 0 && "WallKicks::resolveClockwise() O should never kick");
+
+	// the mask test agrees with the block test
+	GridTetromino t;
+	t.setShape(TetShape::L);
+	for (int rotation = 0; rotation < 4; rotation++)
+	{
+		const TetrominoTables::Orientation &o = TetrominoTables::SHAPES.orientations[TetShape::L][rotation];
+		for (int x = -2; x < Gameboard::MAX_X + 2; x++)
+		{
+			for (int y = 0; y < Gameboard::MAX_Y + 2; y++)
+			{
+				assert(board.canPlace(t.getBlockLocs(), x, y) ==
+					board.canPlaceRows(o.rowMasks, o.maxY - o.minY + 1, o.maxX - o.minX + 1, x + o.minX, y + o.minY) &&
+					"Gameboard.canPlaceRows() disagrees with Gameboard.canPlace()");
+			}
+		}
+		t.rotateClockwise();
+	}
+
+	announceTestCompletion();
+#else
+	announceNotTested("WallKicks");
+#endif
+}
+
+void TestSuite::testRandomizerClass()
+{
+#ifdef RANDOMIZER
+	announceTest("Randomizer");
+
+	// the same seed always gives the same sequence, a different seed a different one
+	Randomizer a(12345, Randomizer::UNIFORM);
+	Randomizer b(12345, Randomizer::UNIFORM);
+	Randomizer c(54321, Randomizer::UNIFORM);
+	bool differs = false;
+	for (int i = 0; i < 100; i++)
+	{
+		TetShape shape = a.next();
+		assert(shape == b.next() && "Randomizer - same seed should give the same sequence");
+		assert((0 <= shape && shape < TetShape::COUNT) && "Randomizer.next() returned an invalid shape");
+		differs = differs || (shape != c.next());
+	}
+	assert(differs && "Randomizer - different seeds should give different sequences");
+
+	// reset() restarts the sequence
+	TetShape first[10];
+	a.reset(99);
+	for (int i = 0; i < 10; i++) { first[i] = a.next(); }
+	a.reset(99);
+	for (int i = 0; i < 10; i++)
+	{
+		assert(a.next() == first[i] && "Randomizer.reset() should restart the sequence");
+	}
+
+	// a copy carries on with the same sequence
+	Randomizer copy = a;
+	for (int i = 0; i < 20; i++)
+	{
+		assert(copy.next() == a.next() && "Randomizer - a copy should continue the same sequence");
+	}
+
+	// nextBelow() stays in range
+	for (int i = 0; i < 1000; i++)
+	{
+		int value = a.nextBelow(7);
+		assert((0 <= value && value < 7) && "Randomizer.nextBelow() out of range");
+	}
+
+	// every run of 7 from the bag holds each shape exactly once
+	Randomizer bag(7, Randomizer::SEVEN_BAG);
+	for (int run = 0; run < 50; run++)
+	{
+		int counts[TetShape::COUNT]{};
+		for (int i = 0; i < TetShape::COUNT; i++)
+		{
+			counts[bag.next()]++;
+		}
+		for (int shape = 0; shape < TetShape::COUNT; shape++)
+		{
+			assert(counts[shape] == 1 && "Randomizer SEVEN_BAG - each bag should hold every shape once");
+		}
+	}
+
+	// the history policy repeats the last shape far less often than uniform picks (1 in 7)
+	Randomizer history(3, Randomizer::HISTORY);
+	TetShape previous = history.next();
+	int repeats = 0;
+	for (int i = 0; i < 7000; i++)
+	{
+		TetShape shape = history.next();
+		if (shape == previous) { repeats++; }
+		previous = shape;
+	}
+	assert(repeats < 200 && "Randomizer HISTORY - too many back to back repeats");
+
+	// the preview queue shows exactly what next() will return
+	Randomizer preview(42, Randomizer::SEVEN_BAG, Randomizer::MAX_PREVIEW);
+	Randomizer single(42, Randomizer::SEVEN_BAG, 1);
+	assert(preview.getPreviewCount() == Randomizer::MAX_PREVIEW && "Randomizer.getPreviewCount() failed");
+	for (int i = 0; i < 30; i++)
+	{
+		TetShape upcoming[Randomizer::MAX_PREVIEW];
+		for (int j = 0; j < Randomizer::MAX_PREVIEW; j++) { upcoming[j] = preview.peek(j); }
+		assert(preview.next() == upcoming[0] && "Randomizer.next() should return peek(0)");
+		for (int j = 1; j < Randomizer::MAX_PREVIEW; j++)
+		{
+			assert(preview.peek(j - 1) == upcoming[j] && "Randomizer - preview queue should shift by one");
+		}
+		// the preview length does not change the sequence
+		assert(upcoming[0] == single.next() && "Randomizer - preview length should not change the sequence");
+	}
+
+	// a packed state unpacks to the same sequence, and damaged bytes are turned away
+	Randomizer packed(11, Randomizer::SEVEN_BAG, 3);
+	for (int i = 0; i < 10; i++) { packed.next(); }
+	uint8_t bytes[Randomizer::PACKED_SIZE];
+	packed.pack(bytes);
+	Randomizer unpacked(0, Randomizer::UNIFORM, 1);
+	assert(unpacked.unpack(bytes) && unpacked.getPreviewCount() == 3 && "Randomizer.unpack() - should restore a packed state");
+	for (int i = 0; i < 20; i++)
+	{
+		assert(unpacked.next() == packed.next() && "Randomizer.unpack() - should continue the same sequence");
+	}
+	uint8_t before[Randomizer::PACKED_SIZE];
+	unpacked.pack(before);
+	const int badBytes[][2] = { { 16, 9 }, { 17 + TetShape::COUNT - 1, 64 }, { 17 + TetShape::COUNT, 8 },
+		{ Randomizer::PACKED_SIZE - 2, 3 }, { Randomizer::PACKED_SIZE - 1, 0 }, { Randomizer::PACKED_SIZE - 1, 7 } };
+	for (const auto &bad : badBytes)
+	{
+		uint8_t damaged[Randomizer::PACKED_SIZE];
+		std::memcpy(damaged, bytes, sizeof(bytes));
+		damaged[bad[0]] = static_cast<uint8_t>(bad[1]);
+		uint8_t after[Randomizer::PACKED_SIZE];
+		assert(!unpacked.unpack(damaged) && "Randomizer.unpack() - should refuse bytes that don't hold a state");
+		unpacked.pack(after);
+		assert(std::memcmp(after, before, sizeof(before)) == 0 && "Randomizer.unpack() - a refused state should change nothing");
+	}
+
+	// a shape in the queue could be any shape its bag has not already shown
+	// (worked out from the sequence so far, the way a player would)
+	for (int count = 1; count <= Randomizer::MAX_PREVIEW; count++)
+	{
+		Randomizer queue(5, Randomizer::SEVEN_BAG, count);
+		std::vector<TetShape> sequence;		// every shape so far, then the queue
+		for (int i = 0; i < 40; i++)
+		{
+			std::vector<TetShape> seen = sequence;
+			for (int index = 0; index < count; index++)
+			{
+				int start = static_cast<int>(seen.size()) / TetShape::COUNT * TetShape::COUNT;
+				uint8_t expected = (1 << TetShape::COUNT) - 1;
+				for (int j = start; j < static_cast<int>(seen.size()); j++)
+				{
+					expected &= ~(1 << seen[j]);
+				}
+				uint8_t possible = queue.getPossibleShapes(index);
+				assert(possible == expected && (possible & (1 << queue.peek(index))) &&
+					"Randomizer.getPossibleShapes() - should be the shapes its bag hasn't shown");
+				seen.push_back(queue.peek(index));
+			}
+			sequence.push_back(queue.next());
+		}
+	}
+	assert(Randomizer(5, Randomizer::UNIFORM).getPossibleShapes(0) == (1 << TetShape::COUNT) - 1 &&
+		"Randomizer.getPossibleShapes() - any shape can come from a UNIFORM randomizer");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Randomizer");
+#endif
+}
+
+#ifdef TETRISENGINE
+// counts the events a TetrisEngine reports
+class CountingListener : public TetrisListener
+{
+public:
+	int newGames{ 0 };
+	int hardDrops{ 0 };
+	int shapesLocked{ 0 };
+	int rowsCleared{ 0 };
+	int gameOvers{ 0 };
+
+	void onNewGame() override { newGames++; }
+	void onHardDrop() override { hardDrops++; }
+	void onShapeLocked() override { shapesLocked++; }
+	void onRowsCleared(int rows) override { rowsCleared += rows; }
+	void onGameOver() override { gameOvers++; }
+};
+#endif
+
+void TestSuite::testTetrisEngineClass()
+{
+#ifdef TETRISENGINE
+	announceTest("TetrisEngine");
+
+	// a game needs no window: it starts with an empty board and a shape at the spawn location
+	TetrisEngine engine(2024);
+	CountingListener listener;
+	engine.setListener(&listener);
+	assert(engine.getScore() == 0 && engine.getLevel() == 0 && !engine.getGameOver() && "TetrisEngine ctor - bad initial state");
+	assert(engine.getCurrentShape().getGridLoc().getX() == engine.getBoard().getSpawnLoc().getX() &&
+		engine.getCurrentShape().getGridLoc().getY() == engine.getBoard().getSpawnLoc().getY() &&
+		"TetrisEngine ctor - current shape should be at the spawn location");
+
+	// moves are applied to the current shape
+	int startX = engine.getCurrentShape().getGridLoc().getX();
+	assert(engine.input(TetrisEngine::MOVE_LEFT) && engine.getCurrentShape().getGridLoc().getX() == startX - 1 &&
+		"TetrisEngine.input() MOVE_LEFT failed");
+	assert(engine.input(TetrisEngine::MOVE_RIGHT) && engine.getCurrentShape().getGridLoc().getX() == startX &&
+		"TetrisEngine.input() MOVE_RIGHT failed");
+
+	// level 0 gravity moves the shape down one row every MAX_FRAMES_PER_ROW steps
+	int startY = engine.getCurrentShape().getGridLoc().getY();
+	for (int i = 1; i < TetrisEngine::MAX_FRAMES_PER_ROW; i++)
+	{
+		engine.step();
+	}
+	assert(engine.getCurrentShape().getGridLoc().getY() == startY && "TetrisEngine.step() fell too early");
+	engine.step();
+	assert(engine.getCurrentShape().getGridLoc().getY() == startY + 1 && "TetrisEngine.step() should move the shape down");
+	assert(engine.getFrame() == static_cast<uint32_t>(TetrisEngine::MAX_FRAMES_PER_ROW) && "TetrisEngine.getFrame() failed");
+
+	// hard dropping in the same place tops the board out
+	int drops = 0;
+	while (!engine.getGameOver() && drops < 100)
+	{
+		engine.input(TetrisEngine::HARD_DROP);
+		engine.step();
+		drops++;
+	}
+	assert(engine.getGameOver() && "TetrisEngine - stacking in one place should end the game");
+	assert(listener.hardDrops == drops && listener.shapesLocked == drops && listener.gameOvers == 1 &&
+		"TetrisEngine - listener missed events");
+	assert(!engine.input(TetrisEngine::MOVE_LEFT) && "TetrisEngine.input() should do nothing once the game is over");
+
+	// the same seed and the same inputs on the same frames give the same game
+	engine.reset();
+	TetrisEngine twin(2024);
+	assert(listener.newGames == 1 && engine.getFrame() == 0 && "TetrisEngine.reset() should start a new game");
+	assert(engine.getGhostShape().getGridLoc().getY() > engine.getCurrentShape().getGridLoc().getY() &&
+		"TetrisEngine.reset() - the ghost should drop, even straight after a game over");
+	const TetrisEngine::Input pattern[] = { TetrisEngine::MOVE_LEFT, TetrisEngine::MOVE_LEFT, TetrisEngine::ROTATE,
+		TetrisEngine::MOVE_RIGHT, TetrisEngine::HARD_DROP, TetrisEngine::MOVE_RIGHT, TetrisEngine::MOVE_RIGHT,
+		TetrisEngine::MOVE_RIGHT, TetrisEngine::HARD_DROP };
+	for (int i = 0; i < 200 && !engine.getGameOver(); i++)
+	{
+		TetrisEngine::Input action = pattern[i % (sizeof(pattern) / sizeof(pattern[0]))];
+		assert(engine.input(action) == twin.input(action) && "TetrisEngine - same seed and inputs should match");
+		for (int frame = 0; frame < 7; frame++)
+		{
+			engine.step();
+			twin.step();
+		}
+		assert(engine.getFrame() == twin.getFrame() && "TetrisEngine - frame counts diverged");
+	}
+	assert(engine.getScore() == twin.getScore() && engine.getGameOver() == twin.getGameOver() && "TetrisEngine - games diverged");
+	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	{
+		assert(engine.getBoard().getRowMask(y) == twin.getBoard().getRowMask(y) && "TetrisEngine - boards diverged");
+	}
+
+	// gravity speeds up with the level, up to 20G
+	TetrisEngine fast(7);
+	int32_t previousGravity = 0;
+	for (int level = 0; level <= 110; level++)
+	{
+		fast.setLevel(level);
+		assert(fast.getGravity() >= previousGravity && fast.getGravity() <= TetrisEngine::MAX_GRAVITY &&
+			"TetrisEngine - gravity should grow with the level");
+		previousGravity = fast.getGravity();
+	}
+	assert(previousGravity == TetrisEngine::MAX_GRAVITY && "TetrisEngine - high levels should reach 20G");
+
+	// at 20G a shape reaches the floor on its first step and locks on the next
+	int landingY = fast.getGhostShape().getGridLoc().getY();
+	fast.step();
+	assert(fast.getCurrentShape().getGridLoc().getY() == landingY && "TetrisEngine - 20G should fall to the floor in one step");
+	fast.step();
+	assert(fast.getBoard().getColumnHeight(fast.getGhostShape().getGridLoc().getX()) > 0 &&
+		fast.getCurrentShape().getGridLoc().getY() < landingY && "TetrisEngine - 20G shape should lock and the next spawn");
+
+	// a saved state (copied byte for byte) plays on exactly like the original
+	TetrisEngine original(99);
+	for (int i = 0; i < 5; i++)
+	{
+		original.input(TetrisEngine::MOVE_LEFT);
+		original.input(TetrisEngine::HARD_DROP);
+		original.step();
+	}
+	GameState saved = original.saveState();
+	GameState copied;
+	std::memcpy(&copied, &saved, sizeof(GameState));
+	for (int round = 0; round < 2; round++)
+	{
+		TetrisEngine replay(1);
+		replay.loadState(copied);
+		TetrisEngine &game = (round == 0) ? original : replay;
+		for (int i = 0; i < 300; i++)
+		{
+			game.input((i % 3 == 0) ? TetrisEngine::ROTATE : TetrisEngine::MOVE_RIGHT);
+			if (i % 17 == 0) { game.input(TetrisEngine::HARD_DROP); }
+			game.step();
+		}
+		if (round == 1)
+		{
+			GameState a = original.saveState();
+			GameState b = replay.saveState();
+			assert(a.score == b.score && a.frame == b.frame && a.gameOver == b.gameOver &&
+				a.currentShape.getShape() == b.currentShape.getShape() &&
+				a.randomizer.peek(0) == b.randomizer.peek(0) && "TetrisEngine.loadState() - games diverged");
+			for (int y = 0; y < Gameboard::MAX_Y; y++)
+			{
+				for (int x = 0; x < Gameboard::MAX_X; x++)
+				{
+					assert(a.board.getContent(x, y) == b.board.getContent(x, y) && "TetrisEngine.loadState() - boards diverged");
+				}
+			}
+		}
+	}
+
+	// the ghost is not in a snapshot, but a loaded game drops it to the same place,
+	// whether the shape is falling or has just locked (once the game is over the
+	// ghost no longer follows the shape)
+	TetrisEngine watched(31);
+	TetrisEngine loaded(1);
+	for (int i = 0; i < 2000 && !watched.getGameOver(); i++)
+	{
+		watched.input((i % 5 == 0) ? TetrisEngine::ROTATE : (i % 7 == 0) ? TetrisEngine::HARD_DROP : TetrisEngine::MOVE_LEFT);
+		for (int step = 0; step < 2 && !watched.getGameOver(); step++)
+		{
+			loaded.loadState(watched.saveState());
+			assert(loaded.getGhostShape().getGridLoc().getX() == watched.getGhostShape().getGridLoc().getX() &&
+				loaded.getGhostShape().getGridLoc().getY() == watched.getGhostShape().getGridLoc().getY() &&
+				loaded.getGhostShape().getRotation() == watched.getGhostShape().getRotation() &&
+				loaded.getGhostShape().getShape() == watched.getGhostShape().getShape() &&
+				"TetrisEngine.loadState() - the ghost should land where it did in the saved game");
+			watched.step();
+		}
+	}
+	assert(watched.getGameOver() && "TetrisEngine - the ghost test game should end");
+
+	// a score is 64 bits (a bot can pass INT32_MAX in a long game)
+	GameState rich = watched.saveState();
+	rich.score = INT64_C(5000000000);
+	loaded.loadState(rich);
+	assert(loaded.getScore() == INT64_C(5000000000) && "TetrisEngine.loadState() - the score should survive");
+
+	// newGame() starts over with a fresh seed
+	uint64_t oldSeed = engine.getSeed();
+	engine.newGame();
+	assert(engine.getSeed() != oldSeed && !engine.getGameOver() && engine.getScore() == 0 && "TetrisEngine.newGame() failed");
+
+	announceTestCompletion();
+#else
+	announceNotTested("TetrisEngine");
+#endif
+}
+
+void TestSuite::testFixedTimestepClass()
+{
+#ifdef FIXEDTIMESTEP
+	announceTest("FixedTimestep");
+
+	// 60 steps per second: a step is due every 16666.67 microseconds
+	FixedTimestep timestep(60);
+	assert(timestep.advance(16666) == 0 && "FixedTimestep.advance() stepped too early");
+	assert(timestep.advance(1) == 1 && "FixedTimestep.advance() should step once a frame of time has built up");
+
+	// uneven frame times add up to exactly the same number of steps as even ones
+	timestep.reset();
+	const int64_t frameTimes[] = { 7000, 21000, 3000, 16667, 33333, 12000 };
+	int steps = 0;
+	for (int second = 0; second < 10; second++)
+	{
+		int64_t elapsed = 0;
+		for (int i = 0; elapsed < FixedTimestep::MICROSECONDS_PER_SECOND; i++)
+		{
+			int64_t frameTime = frameTimes[i % 6];
+			if (elapsed + frameTime > FixedTimestep::MICROSECONDS_PER_SECOND)
+			{
+				frameTime = FixedTimestep::MICROSECONDS_PER_SECOND - elapsed;
+			}
+			steps += timestep.advance(frameTime);
+			elapsed += frameTime;
+		}
+	}
+	assert(steps == 600 && timestep.accumulator == 0 && "FixedTimestep - the remainder should carry over, not drift");
+
+	// a long stall is capped rather than caught up
+	assert(timestep.advance(FixedTimestep::MICROSECONDS_PER_SECOND) == FixedTimestep::MAX_STEPS_PER_ADVANCE &&
+		timestep.advance(0) == 0 && "FixedTimestep.advance() should drop a long backlog");
+
+	announceTestCompletion();
+#else
+	announceNotTested("FixedTimestep");
+#endif
+}
+
+#ifdef MOVEGENERATOR
+// the cells a shape fills at a position, sorted (so equal cell sets compare equal)
+static std::array<int, 4> placementCells(TetShape shape, int rotation, int x, int y)
+{
+	GridTetromino t;
+	t.setShape(shape);
+	t.setRotation(rotation);
+	t.setGridLoc(x, y);
+	std::array<int, 4> cells;
+	int i = 0;
+	for (auto &block : t.getBlockLocsMappedToGrid())
+	{
+		cells[i++] = block.getY() * 100 + block.getX();
+	}
+	std::sort(cells.begin(), cells.end());
+	return cells;
+}
+
+// the lock positions found by trying every move one at a time (breadth first),
+// using the game's own canPlace() and WallKicks - to check the generator against
+static std::set<std::array<int, 4>> bruteForcePlacements(const Gameboard &board, TetShape shape)
+{
+	const int ROWS = MoveGenerator::ROWS;
+	const int ABOVE = MoveGenerator::ABOVE_BOARD;
+	std::set<std::array<int, 4>> found;
+	std::vector<bool> seen(4 * Gameboard::MAX_X * 4 * ROWS, false);
+	auto index = [&](int r, int x, int y) { return (r * Gameboard::MAX_X * 4 + (x + Gameboard::MAX_X)) * ROWS + (y + ABOVE); };
+
+	GridTetromino t;
+	t.setShape(shape);
+	std::vector<std::array<int, 3>> queue;
+	if (!board.canPlace(t.getBlockLocs(), Gameboard::SPAWN_X, Gameboard::SPAWN_Y)) { return found; }
+	queue.push_back({ 0, Gameboard::SPAWN_X, Gameboard::SPAWN_Y });
+	seen[index(0, Gameboard::SPAWN_X, Gameboard::SPAWN_Y)] = true;
+
+	for (size_t head = 0; head < queue.size(); head++)
+	{
+		int r = queue[head][0], x = queue[head][1], y = queue[head][2];
+		t.setRotation(r);
+		if (!board.canPlace(t.getBlockLocs(), x, y + 1))
+		{
+			found.insert(placementCells(shape, r, x, y));
+		}
+
+		std::array<int, 3> moves[4] = { { r, x - 1, y }, { r, x + 1, y }, { r, x, y + 1 }, { -1, 0, 0 } };
+		Point kick;
+		if (WallKicks::resolveClockwise(board, shape, r, x, y, kick))
+		{
+			moves[3] = { (r + 1) % 4, x + kick.getX(), y + kick.getY() };
+		}
+		for (int m = 0; m < 4; m++)
+		{
+			int nr = moves[m][0], nx = moves[m][1], ny = moves[m][2];
+			if (nr < 0 || ny < -ABOVE || ny >= ROWS - ABOVE) { continue; }
+			t.setRotation(nr);
+			if (m < 3 && !board.canPlace(t.getBlockLocs(), nx, ny)) { continue; }
+			if (!seen[index(nr, nx, ny)])
+			{
+				seen[index(nr, nx, ny)] = true;
+				queue.push_back({ nr, nx, ny });
+			}
+		}
+	}
+	return found;
+}
+#endif
+
+void TestSuite::testMoveGenerator()
+{
+#ifdef MOVEGENERATOR
+	announceTest("MoveGenerator");
+
+	// on an empty board every column and distinct orientation can be reached
+	Gameboard board;
+	MoveGenerator::PlacementList list;
+	GridTetromino t;
+	const int EMPTY_COUNTS[TetShape::COUNT] = { 17, 17, 34, 34, 9, 17, 34 };	// S Z L J O I T
+	for (int shape = 0; shape < TetShape::COUNT; shape++)
+	{
+		t.setShape(static_cast<TetShape>(shape));
+		t.setGridLoc(board.getSpawnLoc());
+		assert(MoveGenerator::generatePlacements(board, t, list) == EMPTY_COUNTS[shape] &&
+			"MoveGenerator - wrong number of placements on an empty board");
+	}
+
+	// a shape that does not fit where it starts has nowhere to go
+	board.fillRow(0, 1);
+	t.setShape(TetShape::T);
+	t.setGridLoc(board.getSpawnLoc());
+	assert(MoveGenerator::generatePlacements(board, t, list) == 0 && "MoveGenerator - blocked shape should have no placements");
+
+	// an overhang: an O can only reach the hole under it by sliding along the floor
+	board.empty();
+	for (int x = 0; x < 6; x++) { board.setContent(x, 16, 1); }
+	t.setShape(TetShape::O);
+	t.setGridLoc(board.getSpawnLoc());
+	MoveGenerator::generatePlacements(board, t, list);
+	bool tucked = false;
+	for (int i = 0; i < list.count; i++)
+	{
+		const MoveGenerator::Placement &p = list.placements[i];
+		tucked = tucked || (p.x == 0 && p.y == 17);
+	}
+	assert(tucked && "MoveGenerator - expected a slide under the overhang");
+
+	// on random boards, the generator finds exactly the placements a one move at
+	// a time search finds, each placement locks, none fill the same cells, and
+	// findInputs() finds the way to each
+	Randomizer random(11, Randomizer::UNIFORM);
+	TetrisEngine engine(11);
+	for (int trial = 0; trial < 60; trial++)
+	{
+		board.empty();
+		for (int y = 8; y < Gameboard::MAX_Y; y++)
+		{
+			for (int x = 0; x < Gameboard::MAX_X; x++)
+			{
+				if (random.nextBelow(100) < 20 + 4 * (y - 8)) { board.setContent(x, y, 1); }
+			}
+		}
+		TetShape shape = static_cast<TetShape>(trial % TetShape::COUNT);
+		t.setShape(shape);
+		t.setGridLoc(board.getSpawnLoc());
+		MoveGenerator::generatePlacements(board, t, list);
+
+		std::set<std::array<int, 4>> generated;
+		for (int i = 0; i < list.count; i++)
+		{
+			const MoveGenerator::Placement &p = list.placements[i];
+			GridTetromino placed;
+			placed.setShape(shape);
+			placed.setRotation(p.rotation);
+			assert(board.canPlace(placed.getBlockLocs(), p.x, p.y) && !board.canPlace(placed.getBlockLocs(), p.x, p.y + 1) &&
+				"MoveGenerator - a placement should fit and be unable to fall");
+			assert(generated.insert(placementCells(shape, p.rotation, p.x, p.y)).second &&
+				"MoveGenerator - two placements fill the same cells");
+
+			// the engine, given the inputs findInputs() chose, takes the shape there
+			TetrisEngine::Input inputs[InputPolicy::MAX_INPUTS];
+			int count = MoveGenerator::findInputs(board, t, p, inputs, InputPolicy::MAX_INPUTS);
+			assert(count > 0 && inputs[count - 1] == TetrisEngine::HARD_DROP && "MoveGenerator.findInputs() - no path to a placement");
+			engine.board = board;
+			engine.currentShape = t;
+			for (int input = 0; input < count - 1; input++)
+			{
+				assert(engine.input(inputs[input]) && "MoveGenerator.findInputs() - every input should move the shape");
+			}
+			assert(engine.currentShape.getRotation() == p.rotation && engine.currentShape.getGridLoc().getX() == p.x &&
+				engine.currentShape.getGridLoc().getY() == p.y && "MoveGenerator.findInputs() - the inputs should reach the placement");
+			assert(MoveGenerator::findInputs(board, t, p, inputs, count - 1) == 0 && "MoveGenerator.findInputs() - the path should not fit");
+		}
+		assert(generated == bruteForcePlacements(board, shape) && "MoveGenerator - disagrees with a move by move search");
+	}
+
+	announceTestCompletion();
+#else
+	announceNotTested("MoveGenerator");
+#endif
+}
+
+void TestSuite::testPerft()
+{
+#ifdef PERFT
+	announceTest("Perft");
+
+	// known counts on an empty board
+	Gameboard board;
+	const TetShape SEQUENCE[] = { TetShape::T, TetShape::I, TetShape::O, TetShape::S, TetShape::Z };
+	const uint64_t EMPTY_COUNTS[] = { 1, 34, 596, 5542 };
+	for (int depth = 0; depth < 4; depth++)
+	{
+		assert(Perft::count(board, SEQUENCE, 5, depth) == EMPTY_COUNTS[depth] && "Perft - wrong count on an empty board");
+	}
+
+	// known counts with a well in the right column (the I clears two rows)
+	for (int y = 17; y < Gameboard::MAX_Y; y++)
+	{
+		for (int x = 0; x < Gameboard::MAX_X - 1; x++)
+		{
+			board.setContent(x, y, 1);
+		}
+	}
+	const TetShape WELL_SEQUENCE[] = { TetShape::I, TetShape::L, TetShape::J };
+	const uint64_t WELL_COUNTS[] = { 1, 17, 578, 20335 };
+	for (int depth = 0; depth < 4; depth++)
+	{
+		assert(Perft::count(board, WELL_SEQUENCE, 3, depth) == WELL_COUNTS[depth] && "Perft - wrong count with a well");
+	}
+
+	// a board topped out at the spawn location has nothing to count
+	board.fillRow(0, 1);
+	board.fillRow(1, 1);
+	assert(Perft::count(board, SEQUENCE, 5, 1) == 0 && "Perft - a topped out board should count 0");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Perft");
+#endif
+}
+
+void TestSuite::testBoardFeatures()
+{
+#ifdef BOARDFEATURES
+	announceTest("BoardFeatures (" + std::string(BoardFeatures::getInstructionSet()) + ")");
+
+	// an empty board: every row has 2 transitions (at the walls), every column 1 (at the floor)
+	Gameboard board;
+	BoardFeatures::Features features;
+	BoardFeatures::extract(board, features);
+	assert(features.aggregateHeight == 0 && features.holes == 0 && features.wellSum == 0 &&
+		"BoardFeatures - an empty board should have no height, holes or wells");
+	assert(features.rowTransitions == 2 * Gameboard::MAX_Y && features.columnTransitions == Gameboard::MAX_X &&
+		"BoardFeatures - wrong transitions on an empty board");
+
+	// the bottom row filled but for the right column, and a hole under column 1:
+	//   . # . . . . . . . .   (row 16)
+	//   . . . . . . . . . .
+	//   # # # # # # # # # .
+	for (int x = 0; x < Gameboard::MAX_X - 1; x++) { board.setContent(x, 18, 1); }
+	board.setContent(1, 16, 1);
+	BoardFeatures::extract(board, features);
+	const int32_t HEIGHTS[Gameboard::MAX_X] = { 1, 3, 1, 1, 1, 1, 1, 1, 1, 0 };
+	const int32_t WELLS[Gameboard::MAX_X] = { 2, 0, 0, 0, 0, 0, 0, 0, 0, 1 };
+	for (int x = 0; x < Gameboard::MAX_X; x++)
+	{
+		assert(features.columnHeights[x] == HEIGHTS[x] && features.columnHeights[x] == board.getColumnHeight(x) &&
+			"BoardFeatures - wrong column height");
+		assert(features.wellDepths[x] == WELLS[x] && "BoardFeatures - wrong well depth");
+	}
+	assert(features.aggregateHeight == 11 && features.maxHeight == 3 && features.bumpiness == 5 &&
+		"BoardFeatures - wrong height features");
+	assert(features.holes == 1 && features.coveredCells == 1 && "BoardFeatures - wrong holes");
+	assert(features.rowTransitions == 40 && features.columnTransitions == 12 && "BoardFeatures - wrong transitions");
+	assert(features.wellSum == 4 && "BoardFeatures - wrong well sum");
+
+	// on random boards (with overhangs) the SIMD and scalar versions agree
+	Randomizer random(5, Randomizer::UNIFORM);
+	for (int trial = 0; trial < 500; trial++)
+	{
+		board.empty();
+		int top = random.nextBelow(Gameboard::MAX_Y);
+		for (int y = top; y < Gameboard::MAX_Y; y++)
+		{
+			for (int x = 0; x < Gameboard::MAX_X; x++)
+			{
+				if (random.nextBelow(100) < 60) { board.setContent(x, y, 1); }
+			}
+		}
+		BoardFeatures::Features scalar;
+		BoardFeatures::extract(board, features);
+		BoardFeatures::extractScalar(board, scalar);
+		assert(std::memcmp(&features, &scalar, sizeof(features)) == 0 && "BoardFeatures - SIMD and scalar disagree");
+	}
+
+	announceTestCompletion();
+#else
+	announceNotTested("BoardFeatures");
+#endif
+}
+
+void TestSuite::testBatchLegality()
+{
+#ifdef BATCHLEGALITY
+	announceTest("BatchLegality");
+
+	// on random boards, every position of every shape (including ones off the
+	// board in every direction) gets the same answer as Gameboard.canPlaceRows()
+	Gameboard board;
+	Randomizer random(3, Randomizer::UNIFORM);
+	for (int trial = 0; trial < 40; trial++)
+	{
+		board.empty();
+		for (int y = 6; y < Gameboard::MAX_Y; y++)
+		{
+			for (int x = 0; x < Gameboard::MAX_X; x++)
+			{
+				if (random.nextBelow(100) < 40) { board.setContent(x, y, 1); }
+			}
+		}
+		BatchLegality::PaddedBoard padded;
+		BatchLegality::pad(board, padded);
+
+		TetShape shape = static_cast<TetShape>(trial % TetShape::COUNT);
+		std::vector<BatchLegality::Candidate> candidates;
+		for (int rotation = 0; rotation < TetrominoTables::ROTATION_COUNT; rotation++)
+		{
+			for (int y = -8; y < Gameboard::MAX_Y + 4; y++)
+			{
+				for (int x = -6; x < Gameboard::MAX_X + 6; x++)
+				{
+					candidates.push_back({ static_cast<int8_t>(x), static_cast<int8_t>(y), static_cast<int8_t>(rotation) });
+				}
+			}
+		}
+
+		// uneven batch sizes, so the last few candidates of a batch are tested too
+		for (size_t first = 0; first < candidates.size(); first += 61)
+		{
+			int count = static_cast<int>(std::min<size_t>(61, candidates.size() - first));
+			uint64_t legal = BatchLegality::test(padded, shape, &candidates[first], count);
+			for (int i = 0; i < count; i++)
+			{
+				const BatchLegality::Candidate &c = candidates[first + i];
+				const TetrominoTables::Orientation &o = TetrominoTables::SHAPES.orientations[shape][c.rotation];
+				bool fits = board.canPlaceRows(o.rowMasks, o.maxY - o.minY + 1, o.maxX - o.minX + 1, c.x + o.minX, c.y + o.minY);
+				assert(((legal >> i) & 1) == (fits ? 1u : 0u) && "BatchLegality - disagrees with Gameboard.canPlaceRows()");
+			}
+			assert((legal >> count) == 0 && "BatchLegality - bits set past the last candidate");
+		}
+	}
+
+	// the Gameboard overload pads the board itself
+	board.empty();
+	board.fillRow(Gameboard::MAX_Y - 1, 1);
+	BatchLegality::Candidate spawnAndFloor[] = { { Gameboard::SPAWN_X, Gameboard::SPAWN_Y, 0 }, { Gameboard::SPAWN_X, Gameboard::MAX_Y - 1, 0 } };
+	assert(BatchLegality::test(board, TetShape::T, spawnAndFloor, 2) == 0x1 && "BatchLegality - wrong result from a Gameboard");
+
+	announceTestCompletion();
+#else
+	announceNotTested("BatchLegality");
+#endif
+}
+
+void TestSuite::testBatchTetrisClass()
+{
+#ifdef BATCHTETRIS
+	announceTest("BatchTetris");
+
+	// every array starts on a cache line
+	const int GAMES = 5;
+	BatchTetris batch(GAMES, 21);
+	assert(reinterpret_cast<uintptr_t>(batch.boards) % BatchTetris::CACHE_LINE == 0 &&
+		reinterpret_cast<uintptr_t>(batch.randomizers) % BatchTetris::CACHE_LINE == 0 &&
+		reinterpret_cast<uintptr_t>(batch.cleared) % BatchTetris::CACHE_LINE == 0 && "BatchTetris - arrays should be cache line aligned");
+
+	// each game plays exactly like a TetrisEngine given the same inputs: rotate,
+	// move towards the column, hard drop - through game overs and restarts
+	std::vector<TetrisEngine> engines;
+	for (int game = 0; game < GAMES; game++)
+	{
+		engines.emplace_back(batch.getSeed(game));
+	}
+	Randomizer random(8, Randomizer::UNIFORM);
+	int32_t actions[GAMES];
+	int32_t rewards[GAMES];
+	uint8_t dones[GAMES];
+	int gamesOver = 0;
+	int rowsCleared = 0;
+	for (int turn = 0; turn < 3000; turn++)
+	{
+		for (int game = 0; game < GAMES; game++)
+		{
+			actions[game] = random.nextBelow(BatchTetris::ACTION_COUNT);
+		}
+		batch.step(actions, rewards, dones);
+
+		for (int game = 0; game < GAMES; game++)
+		{
+			TetrisEngine &engine = engines[game];
+			int64_t scoreBefore = engine.getScore();
+			int levelBefore = engine.getLevel();
+			for (int r = 0; r < actions[game] / Gameboard::MAX_X; r++)
+			{
+				engine.input(TetrisEngine::ROTATE);
+			}
+			int targetX = actions[game] % Gameboard::MAX_X;
+			while (engine.getCurrentShape().getGridLoc().getX() != targetX &&
+				engine.input(targetX < engine.getCurrentShape().getGridLoc().getX() ? TetrisEngine::MOVE_LEFT : TetrisEngine::MOVE_RIGHT))
+			{
+			}
+			engine.input(TetrisEngine::HARD_DROP);
+			engine.processLock();
+			engine.shapePlacedSinceLastStep = false;
+
+			assert((dones[game] == 1) == engine.getGameOver() && "BatchTetris - game over differs from TetrisEngine");
+			if (engine.getGameOver())
+			{
+				gamesOver++;
+				engine.newGame();
+				assert(batch.getSeed(game) == engine.getSeed() && "BatchTetris - a restarted game should be seeded like TetrisEngine");
+			}
+			else
+			{
+				assert(rewards[game] == engine.getScore() - scoreBefore && "BatchTetris - wrong reward");
+				rowsCleared += (engine.getLevel() != levelBefore || rewards[game] != 0) ? 1 : 0;
+			}
+			assert(batch.getScore(game) == engine.getScore() && batch.getLevel(game) == engine.getLevel() &&
+				"BatchTetris - score or level differs from TetrisEngine");
+			assert(batch.getShape(game) == engine.getCurrentShape().getShape() && batch.getNextShape(game) == engine.getNextShape().getShape() &&
+				"BatchTetris - shapes differ from TetrisEngine");
+			for (int y = 0; y < Gameboard::MAX_Y; y++)
+			{
+				assert(batch.getRowMask(game, y) == engine.getBoard().getRowMask(y) && "BatchTetris - board differs from TetrisEngine");
+			}
+		}
+	}
+	assert(gamesOver > 0 && rowsCleared > 0 && "BatchTetris - the test should cover row clears and restarts");
+
+	announceTestCompletion();
+#else
+	announceNotTested("BatchTetris");
+#endif
+}
+
+void TestSuite::testGameFarmClass()
+{
+#ifdef GAMEFARM
+	announceTest("GameFarm");
+
+	// the spread of some numbers
+	std::vector<int64_t> values = { 50, 10, 40, 20, 30 };
+	GameFarm::Distribution spread = GameFarm::distribution(values);
+	assert(spread.min == 10 && spread.median == 30 && spread.max == 50 && spread.mean == 30.0 &&
+		"GameFarm::distribution() failed");
+
+	// hard dropping every frame tops out without clearing a row
+	GameFarm dropper([]() { return std::unique_ptr<InputPolicy>(new ScriptedPolicy("H")); }, 2);
+	GameFarm::Report report = dropper.run(3, 5);
+	for (const GameFarm::GameResult &result : dropper.getResults())
+	{
+		assert(result.toppedOut && result.shapes > 0 && result.rowsCleared == 0 && result.score == 0 &&
+			"GameFarm - hard dropping in place should top out");
+	}
+	assert(report.games == 3 && report.threads == 2 && report.scores.max == 0 && "GameFarm - bad report");
+
+	// a run gives the same games however many threads play it
+	auto makeRandom = []() { return std::unique_ptr<InputPolicy>(new RandomPolicy()); };
+	GameFarm one(makeRandom, 1);
+	GameFarm four(makeRandom, 4);
+	report = one.run(24, 77);
+	GameFarm::Report fourReport = four.run(24, 77);
+	assert(report.steals == 0 && fourReport.threads == 4 && "GameFarm - wrong workers");
+	uint64_t shapes = 0;
+	for (int game = 0; game < 24; game++)
+	{
+		const GameFarm::GameResult &a = one.getResults()[game];
+		const GameFarm::GameResult &b = four.getResults()[game];
+		assert(a.seed == b.seed && a.score == b.score && a.rowsCleared == b.rowsCleared && a.shapes == b.shapes &&
+			a.frames == b.frames && a.toppedOut && b.toppedOut && "GameFarm - a game should not depend on the thread playing it");
+		shapes += a.shapes;
+	}
+	assert(report.shapes == shapes && fourReport.shapes == shapes && report.frames == fourReport.frames &&
+		report.scores.mean == fourReport.scores.mean && "GameFarm - reports should match");
+
+	// the bot clears rows, and stops at the shape cap
+	GameFarm bots([]() { return std::unique_ptr<InputPolicy>(new BotPolicy()); }, 2);
+	report = bots.run(4, 9, 150);
+	for (const GameFarm::GameResult &result : bots.getResults())
+	{
+		assert(!result.toppedOut && result.shapes == 150 && result.rowsCleared >= 50 &&
+			"GameFarm - the bot should survive 150 shapes, clearing rows");
+	}
+	assert(report.rowsCleared.min >= 50 && report.shapes == 600 && "GameFarm - bad bot report");
+
+	announceTestCompletion();
+#else
+	announceNotTested("GameFarm");
+#endif
+}
+
+#if defined(REPLAY) || defined(KEYFRAMES) || defined(CHECKSUM)
+// play a game with a policy, recording it
+// - param 1: the InputPolicy to play with
+// - param 2: a uint64_t, the game's seed
+// - param 3: a uint32_t, the most frames to play
+// - param 4: a Replay, the recording
+// - return: the TetrisEngine at the end
+static TetrisEngine recordGame(InputPolicy &policy, uint64_t seed, uint32_t maxFrames, Replay &replay)
+{
+	TetrisEngine engine(seed);
+	policy.newGame(seed);
+	replay.start(engine);
+	TetrisEngine::Input inputs[InputPolicy::MAX_INPUTS];
+	while (!engine.getGameOver() && engine.getFrame() < maxFrames)
+	{
+		int count = policy.chooseInputs(engine, inputs);
+		for (int i = 0; i < count; i++)
+		{
+			replay.record(engine.getFrame(), inputs[i]);
+			engine.input(inputs[i]);
+		}
+		engine.step();
+		replay.recordChecksum(engine);
+	}
+	replay.finish(engine);
+	return engine;
+}
+#endif
+
+void TestSuite::testReplayClass()
+{
+#ifdef REPLAY
+	announceTest("Replay");
+
+	// a game played to the end plays back the same, and packs into a few bytes an input
+	ScriptedPolicy script("LU......D.....R.....L....R..DD........L........");
+	Replay replay;
+	TetrisEngine engine = recordGame(script, 31, UINT32_MAX, replay);
+	assert(engine.getGameOver() && replay.getEvents().size() > 200 && "Replay - the test game should end");
+	assert(replay.verify() && "Replay.verify() - a recorded game should play back the same");
+	std::vector<uint8_t> bytes = replay.encode();
+	assert(bytes.size() < 2 * replay.getEvents().size() + 8 * replay.getChecksums().size() + 64 &&
+		"Replay.encode() - inputs should take under 2 bytes each");
+
+	Replay decoded;
+	assert(decoded.decode(bytes.data(), bytes.size()) && decoded.getSeed() == 31 &&
+		decoded.getFinalFrame() == engine.getFrame() && decoded.getFinalScore() == engine.getScore() &&
+		decoded.getEvents().size() == replay.getEvents().size() && "Replay.decode() failed");
+	for (size_t i = 0; i < replay.getEvents().size(); i++)
+	{
+		assert(decoded.events[i].frame == replay.events[i].frame && decoded.events[i].input == replay.events[i].input &&
+			"Replay.decode() - events differ");
+	}
+	assert(decoded.verify() && decoded.encode() == bytes && "Replay - a decoded replay should play back the same");
+
+	// damaged or foreign bytes are refused, and leave the replay as it was
+	assert(!decoded.decode(bytes.data(), bytes.size() - 1) && !decoded.decode(bytes.data() + 1, bytes.size() - 1) &&
+		decoded.verify() && "Replay.decode() should refuse damaged bytes");
+	std::vector<uint8_t> longer = bytes;
+	longer.push_back(0);
+	assert(!decoded.decode(longer.data(), longer.size()) && "Replay.decode() should refuse trailing bytes");
+
+	// a game that does not end the way it was recorded fails
+	decoded.finalScore++;
+	assert(!decoded.verify() && "Replay.verify() should notice a different score");
+	decoded.finalScore = INT64_C(5000000000);
+	std::vector<uint8_t> rich = decoded.encode();
+	assert(decoded.decode(rich.data(), rich.size()) && decoded.getFinalScore() == INT64_C(5000000000) &&
+		"Replay - a score past INT32_MAX should survive encode() and decode()");
+	decoded = replay;
+	decoded.finalRows[Gameboard::MAX_Y - 1] ^= 1;
+	assert(!decoded.verify() && "Replay.verify() should notice a different board");
+	decoded = replay;
+	decoded.rulesVersion = Replay::RULES_VERSION + 1;
+	assert(!decoded.verify() && "Replay.verify() should refuse other rules");
+
+	// a bot game stopped part way (with several inputs on its last frame) plays back too,
+	// and playing to a frame in stages is the same as playing to it at once
+	BotPolicy bot;
+	engine = recordGame(bot, 5, 400, replay);
+	assert(!engine.getGameOver() && replay.verify() && "Replay.verify() - a game stopped part way should play back");
+	TetrisEngine once = replay.createEngine();
+	TetrisEngine staged = replay.createEngine();
+	replay.playTo(once, 300);
+	replay.playTo(staged, 97);
+	replay.playTo(staged, 98);
+	replay.playTo(staged, 300);
+	assert(once.getFrame() == 300 && staged.getFrame() == 300 && once.getScore() == staged.getScore() &&
+		once.getCurrentShape().getGridLoc().getX() == staged.getCurrentShape().getGridLoc().getX() && "Replay.playTo() failed");
+	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	{
+		assert(once.getBoard().getRowMask(y) == staged.getBoard().getRowMask(y) && "Replay.playTo() - boards differ");
+	}
+
+	announceTestCompletion();
+#else
+	announceNotTested("Replay");
+#endif
+}
+
+#ifdef KEYFRAMES
+// check two engines hold the same game, then that they carry on the same
+// - param 1: a TetrisEngine
+// - param 2: a TetrisEngine
+// - return: bool, true if the games match
+static bool sameGame(TetrisEngine a, TetrisEngine b)
+{
+	for (int turn = 0; turn < 2; turn++)
+	{
+		if (a.getFrame() != b.getFrame() || a.getScore() != b.getScore() || a.getLevel() != b.getLevel() ||
+			a.getChecksum() != b.getChecksum() ||
+			a.getGameOver() != b.getGameOver() || a.getGravity() != b.getGravity() ||
+			a.getCurrentShape().getShape() != b.getCurrentShape().getShape() ||
+			a.getCurrentShape().getRotation() != b.getCurrentShape().getRotation() ||
+			a.getCurrentShape().getGridLoc().getX() != b.getCurrentShape().getGridLoc().getX() ||
+			a.getCurrentShape().getGridLoc().getY() != b.getCurrentShape().getGridLoc().getY() ||
+			a.getNextShape().getShape() != b.getNextShape().getShape())
+		{
+			return false;
+		}
+		for (int y = 0; y < Gameboard::MAX_Y; y++)
+		{
+			for (int x = 0; x < Gameboard::MAX_X; x++)
+			{
+				if (a.getBoard().getContent(x, y) != b.getBoard().getContent(x, y))
+				{
+					return false;
+				}
+			}
+		}
+		// the same inputs from here should play the same (the randomizers match too)
+		for (int frame = 0; frame < 90; frame++)
+		{
+			TetrisEngine::Input input = (frame % 9 == 8) ? TetrisEngine::HARD_DROP : static_cast<TetrisEngine::Input>(frame % 4);
+			a.input(input);
+			b.input(input);
+			a.step();
+			b.step();
+		}
+	}
+	return true;
+}
+#endif
+
+void TestSuite::testReplayKeyframes()
+{
+#ifdef KEYFRAMES
+	announceTest("Replay keyframes");
+
+	// a bot game, with and without keyframes
+	BotPolicy bot;
+	Replay plain;
+	recordGame(bot, 12, 1200, plain);
+	Replay replay = plain;
+	replay.buildKeyframes(50);
+	assert(replay.getKeyframeInterval() == 50 && replay.getKeyframes().size() >= 20 && "Replay.buildKeyframes() - too few keyframes");
+	for (size_t i = 0; i < replay.getKeyframes().size(); i++)
+	{
+		assert(replay.getKeyframes()[i].piece == 50 * (i + 1) && "Replay.buildKeyframes() - a keyframe every 50 shapes");
+	}
+	assert(replay.verify() && "Replay - keyframes should not change the game");
+
+	// keyframes are compact, and survive encoding
+	std::vector<uint8_t> bytes = replay.encode();
+	size_t keyframeBytes = bytes.size() - plain.encode().size();
+	assert(keyframeBytes < 200 * replay.getKeyframes().size() && "Replay - keyframes should be compact");
+	Replay decoded;
+	assert(decoded.decode(bytes.data(), bytes.size()) && decoded.getKeyframes().size() == replay.getKeyframes().size() &&
+		decoded.encode() == bytes && "Replay.decode() - keyframes lost");
+
+	// seeking through keyframes lands on the same game as playing from the start
+	const int pieces[] = { 0, 1, 49, 50, 51, 333, 1000, 1199, 5000 };
+	for (int piece : pieces)
+	{
+		TetrisEngine sought = decoded.seekPiece(piece);
+		assert(sameGame(sought, plain.seekPiece(piece)) && "Replay.seekPiece() - keyframe seek differs");
+		assert((piece > 1200 || sought.getFrame() == static_cast<uint32_t>(piece)) && "Replay.seekPiece() - the bot locks a shape a frame");
+	}
+	const uint32_t frames[] = { 0, 7, 50, 640, 1199, 1200, 9000 };
+	for (uint32_t frame : frames)
+	{
+		assert(sameGame(decoded.seekFrame(frame), plain.seekFrame(frame)) && "Replay.seekFrame() - keyframe seek differs");
+	}
+
+	// a damaged index is refused
+	std::vector<uint8_t> damaged = bytes;
+	damaged.back() ^= 1;
+	assert(!decoded.decode(damaged.data(), damaged.size()) && "Replay.decode() should refuse a bad footer");
+
+	// a damaged file either is refused, or decodes to keyframes that load
+	// (every keyframe is checked as it is decoded - the randomizer too)
+	for (size_t i = 0; i < bytes.size(); i++)
+	{
+		damaged = bytes;
+		damaged[i] ^= static_cast<uint8_t>(1 << (i % 8));
+		Replay fuzzed;
+		if (fuzzed.decode(damaged.data(), damaged.size()) && !fuzzed.getKeyframes().empty())
+		{
+			fuzzed.seekPiece(fuzzed.getKeyframes().back().piece);
+		}
+	}
+
+	// a replay in another format is refused
+	std::vector<uint8_t> other = plain.encode();
+	other[4] = Replay::FORMAT_VERSION + 1;
+	assert(!decoded.decode(other.data(), other.size()) && "Replay.decode() should refuse another format");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Replay keyframes");
+#endif
+}
+
+void TestSuite::testChecksum()
+{
+#ifdef CHECKSUM
+	announceTest("Checksum");
+
+	// the board's checksum follows its content, however it got there
+	Gameboard played;
+	Gameboard built;
+	assert(played.getChecksum() == built.getChecksum() && "Gameboard.getChecksum() - empty boards should agree");
+	for (int x = 0; x < Gameboard::MAX_X; x++)
+	{
+		played.setContent(x, 17, x % 7);
+		played.setContent(x, 18, (x + 3) % 7);
+	}
+	played.setContent(2, 16, 4);
+	played.setContent(2, 15, 5);
+	uint64_t full = played.getChecksum();
+	assert(played.removeCompletedRows() == 2 && "Gameboard - two rows should clear");
+	built.setContent(2, 18, 4);
+	built.setContent(2, 17, 5);
+	assert(played.getChecksum() == built.getChecksum() && played.getChecksum() != full &&
+		"Gameboard.getChecksum() - a line clear should leave the checksum of the board it leaves");
+	built.setContent(2, 17, 6);
+	assert(played.getChecksum() != built.getChecksum() && "Gameboard.getChecksum() should see colors");
+	built.setContent(2, 17, 5);
+	built.setContent(3, 10, 1);
+	built.setContent(3, 10, Gameboard::EMPTY_BLOCK);
+	assert(played.getChecksum() == built.getChecksum() && "Gameboard.getChecksum() - emptying a cell should undo it");
+
+	// a randomizer's checksum covers the preview slots in use, not the rest
+	Randomizer shortQueue(5, Randomizer::SEVEN_BAG, 3);
+	shortQueue.next();
+	shortQueue.next();
+	Randomizer twinQueue = shortQueue;
+	for (int i = shortQueue.getPreviewCount(); i < Randomizer::MAX_PREVIEW; i++)
+	{
+		shortQueue.preview[i] = TetShape::O;
+		twinQueue.preview[i] = TetShape::I;
+	}
+	assert(shortQueue.getChecksum() == twinQueue.getChecksum() && "Randomizer.getChecksum() - should only read the preview queue");
+
+	// games played the same agree every frame; a single different input splits them for good
+	ScriptedPolicy script("LU......D.....R.....L....R..DD........L........");
+	TetrisEngine a(77);
+	TetrisEngine b(77);
+	assert(a.getChecksum() == b.getChecksum() && "TetrisEngine.getChecksum() - new games should agree");
+	uint64_t previous = a.getChecksum();
+	bool differed = false;
+	TetrisEngine::Input inputs[InputPolicy::MAX_INPUTS];
+	for (int frame = 0; frame < 600; frame++)
+	{
+		int count = script.chooseInputs(a, inputs);
+		for (int i = 0; i < count; i++)
+		{
+			a.input(inputs[i]);
+			b.input(inputs[i]);
+		}
+		if (frame == 300)
+		{
+			b.input(TetrisEngine::HARD_DROP);
+		}
+		a.step();
+		b.step();
+		assert(!a.getGameOver() && "TetrisEngine - the checksum test game should not end");
+		assert(a.getChecksum() != previous && "TetrisEngine.getChecksum() should change every step");
+		previous = a.getChecksum();
+		if (frame < 300)
+		{
+			assert(a.getChecksum() == b.getChecksum() && "TetrisEngine.getChecksum() - the same game should agree");
+		}
+		differed = differed || (a.getChecksum() != b.getChecksum());
+		assert((frame < 300 || differed) && "TetrisEngine.getChecksum() - a different input should show the frame it is given");
+		assert((frame <= 300 || a.getChecksum() != b.getChecksum()) && "TetrisEngine.getChecksum() - games that drifted should stay apart");
+	}
+
+	// the checksum carries through a saved state, and starts again with a new game
+	TetrisEngine copy(1);
+	copy.loadState(a.saveState());
+	a.step();
+	copy.step();
+	assert(a.getChecksum() == copy.getChecksum() && "TetrisEngine.loadState() should keep the checksum");
+	a.reset();
+	assert(a.getChecksum() == 0 && "TetrisEngine.reset() should restart the checksum");
+
+	// replays keep the checksums, and name the first second a playback drifts from them
+	BotPolicy bot;
+	Replay replay;
+	recordGame(bot, 12, 1000, replay);
+	assert(replay.getChecksums().size() == 1000 / Replay::CHECKSUM_INTERVAL && replay.findDesync() == Replay::NO_DESYNC &&
+		replay.verify() && "Replay - a recording should match its checksums");
+	Replay drifted = replay;
+	drifted.checksums[5] ^= 1;
+	assert(drifted.findDesync() == 6 * Replay::CHECKSUM_INTERVAL && !drifted.verify() &&
+		"Replay.findDesync() should find the first checksum that differs");
+	drifted = replay;
+	drifted.events[drifted.events.size() / 2].input = TetrisEngine::MOVE_LEFT;
+	uint32_t changed = drifted.events[drifted.events.size() / 2].frame;
+	uint32_t desync = drifted.findDesync();
+	assert(desync >= changed && desync < changed + Replay::CHECKSUM_INTERVAL && "Replay.findDesync() should find a changed input");
+	drifted = replay;
+	drifted.finalChecksum ^= 1;
+	assert(drifted.findDesync() == drifted.getFinalFrame() && "Replay.findDesync() should check the final checksum");
+
+	std::vector<uint8_t> bytes = replay.encode();
+	Replay decoded;
+	assert(decoded.decode(bytes.data(), bytes.size()) && decoded.getChecksums() == replay.getChecksums() &&
+		decoded.getFinalChecksum() == replay.getFinalChecksum() && decoded.verify() && "Replay.decode() - checksums lost");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Checksum");
+#endif
+}
+
+void TestSuite::testZobrist()
+{
+#ifdef ZOBRIST
+	announceTest("Zobrist");
+
+	// the board's key follows its occupancy (not its colors), however it got there
+	Gameboard played;
+	Gameboard built;
+	assert(played.getZobristKey() == 0 && built.getZobristKey() == 0 && "Gameboard.getZobristKey() - an empty board's key should be 0");
+	for (int x = 0; x < Gameboard::MAX_X; x++)
+	{
+		played.setContent(x, 17, x % 7);
+		played.setContent(x, 18, (x + 3) % 7);
+	}
+	played.setContent(2, 16, 4);
+	played.setContent(2, 15, 5);
+	uint64_t full = played.getZobristKey();
+	assert(played.removeCompletedRows() == 2 && "Gameboard - two rows should clear");
+	built.setContent(2, 18, 1);
+	built.setContent(2, 17, 6);
+	assert(played.getZobristKey() == built.getZobristKey() && played.getZobristKey() != full &&
+		"Gameboard.getZobristKey() - a line clear should leave the key of the board it leaves, whatever the colors");
+	built.setContent(2, 17, 3);
+	assert(played.getZobristKey() == built.getZobristKey() && "Gameboard.getZobristKey() - recoloring a cell should not change the key");
+	built.setContent(3, 10, 1);
+	assert(played.getZobristKey() != built.getZobristKey() && "Gameboard.getZobristKey() - filling a cell should change the key");
+	built.setContent(3, 10, Gameboard::EMPTY_BLOCK);
+	assert(played.getZobristKey() == built.getZobristKey() && "Gameboard.getZobristKey() - emptying a cell should undo it");
+
+	// the key after a lock is known before locking
+	for (int x = 0; x < Gameboard::MAX_X - 1; x++)
+	{
+		built.setContent(x, Gameboard::MAX_Y - 1, 2);
+	}
+	BlockList flat{ Point(4, 15), Point(5, 15), Point(6, 15), Point(7, 15) };
+	BlockList upright{ Point(9, 15), Point(9, 16), Point(9, 17), Point(9, 18) };
+	BlockList above{ Point(9, -1), Point(9, 0), Point(9, 1), Point(9, 2) };
+	const BlockList *placements[] = { &flat, &upright, &above };
+	for (const BlockList *blocks : placements)
+	{
+		int rowsCompleted;
+		uint64_t key = built.getZobristKeyAfterLock(*blocks, rowsCompleted);
+		Gameboard locked = built;
+		Gameboard::RowClear rowClear = locked.lockBlocks(*blocks, 1);
+		assert(key == locked.getZobristKey() && rowsCompleted == rowClear.count &&
+			"Gameboard.getZobristKeyAfterLock() should match lockBlocks()");
+	}
+
+	// the engine's key covers the falling shape
+	TetrisEngine engine(5);
+	uint64_t start = engine.getZobristKey();
+	assert(start != engine.getBoard().getZobristKey() && "TetrisEngine.getZobristKey() should include the shapes");
+	engine.input(TetrisEngine::MOVE_LEFT);
+	assert(engine.getZobristKey() != start && "TetrisEngine.getZobristKey() should change when the shape moves");
+	engine.input(TetrisEngine::MOVE_RIGHT);
+	assert(engine.getZobristKey() == start && "TetrisEngine.getZobristKey() should come back with the shape");
+	engine.input(TetrisEngine::ROTATE);
+	assert(engine.getZobristKey() != start && "TetrisEngine.getZobristKey() should change when the shape rotates");
+
+	// the table finds what was stored, and a deeper result outranks a shallower one
+	TranspositionTable table(4);
+	TranspositionTable::Entry entry;
+	assert(table.getCapacity() == 16 * TranspositionTable::BUCKET_SIZE && table.getPerMille() == 0 &&
+		!table.probe(12345, entry) && "TranspositionTable - a new table should be empty");
+	for (int bits = 1; bits <= 6; bits++)
+	{
+		TranspositionTable sized(bits);
+		assert(reinterpret_cast<uintptr_t>(sized.slots) % 64 == 0 && "TranspositionTable - buckets should start on a cache line");
+	}
+	table.store(12345, 1.5f, 3, 7);
+	assert(table.probe(12345, entry) && entry.value == 1.5f && entry.depth == 3 && entry.move == 7 &&
+		"TranspositionTable.probe() should find a stored entry");
+	table.store(12345, 2.5f, 1, 0);
+	assert(table.probe(12345, entry) && entry.value == 1.5f && "TranspositionTable.store() should keep a deeper entry");
+	table.store(12345, 3.5f, 4, 0);
+	assert(table.probe(12345, entry) && entry.value == 3.5f && entry.depth == 4 && "TranspositionTable.store() should replace a shallower entry");
+
+	// a full bucket gives up its shallowest entry, then its oldest (keys differing
+	// only above the bucket bits share a bucket)
+	const uint64_t apart = 1ull << 40;
+	table.clear();
+	for (int i = 0; i < TranspositionTable::BUCKET_SIZE; i++)
+	{
+		table.store(9 + i * apart, static_cast<float>(i), (i == 2) ? 1 : 5);
+	}
+	table.store(9 + 10 * apart, 10.0f, 5);
+	assert(!table.probe(9 + 2 * apart, entry) && table.probe(9 + 10 * apart, entry) && table.probe(9, entry) &&
+		"TranspositionTable.store() should replace the shallowest entry in a full bucket");
+	table.newSearch();
+	table.store(9 + 20 * apart, 20.0f, 5);
+	table.store(9 + 21 * apart, 21.0f, 5);
+	assert(table.probe(9 + 20 * apart, entry) && table.probe(9 + 21 * apart, entry) &&
+		"TranspositionTable.store() should replace entries from older searches first, depth for depth");
+	table.store(12345, 1.0f);
+	table.store(12345, 2.0f);
+	assert(table.probe(12345, entry) && entry.value == 2.0f && "TranspositionTable.store() should update an equal depth");
+	table.clear();
+	assert(!table.probe(12345, entry) && table.getPerMille() == 0 && "TranspositionTable.clear() should empty the table");
+
+	// threads storing and probing at once only ever find the values stored for the keys
+	TranspositionTable shared(8);
+	std::vector<std::thread> threads;
+	bool wrong[4] = {};
+	for (int t = 0; t < 4; t++)
+	{
+		threads.emplace_back([&shared, &wrong, t]()
+		{
+			TranspositionTable::Entry found;
+			for (uint64_t i = 0; i < 20000; i++)
+			{
+				uint64_t key = (i * 0x9E3779B97F4A7C15ull) % 5000 + 1;
+				if (shared.probe(key, found) && found.value != static_cast<float>(key % 1000))
+				{
+					wrong[t] = true;
+				}
+				shared.store(key, static_cast<float>(key % 1000), static_cast<int>((i + t) % 8));
+			}
+		});
+	}
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+	assert(!wrong[0] && !wrong[1] && !wrong[2] && !wrong[3] && shared.getPerMille() > 900 &&
+		"TranspositionTable - threads sharing a table should never see a wrong value");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Zobrist");
+#endif
+}
+
+void TestSuite::testBeamSearch()
+{
+#ifdef BEAMSEARCH
+	announceTest("BeamSearch");
+
+	// a pool runs every task of every job exactly once, on its own workers
+	WorkerPool pool(4);
+	assert(pool.getWorkers() == 4 && WorkerPool(1).getWorkers() == 1 && "WorkerPool.getWorkers() failed");
+	std::vector<int> runs(1000, 0);
+	std::vector<int> workers(1000, -1);
+	for (int job = 0; job < 3; job++)
+	{
+		pool.run(1000, [&runs, &workers](int task, int worker) { runs[task]++; workers[task] = worker; });
+	}
+	pool.run(0, [&runs](int task, int worker) { runs[task]++; });
+	assert(std::count(runs.begin(), runs.end(), 3) == 1000 && "WorkerPool.run() - every task should run once per job");
+	assert(*std::min_element(workers.begin(), workers.end()) >= 0 && *std::max_element(workers.begin(), workers.end()) < 4 &&
+		"WorkerPool.run() - a task ran on a worker that doesn't exist");
+
+	// with no preview, the search picks the best board one placement away
+	BotPolicy::Weights weights;
+	Gameboard board;
+	for (int x = 0; x < Gameboard::MAX_X - 2; x++)
+	{
+		board.setContent(x, Gameboard::MAX_Y - 1, 1);
+		board.setContent(x + 1, Gameboard::MAX_Y - 2, 2);
+	}
+	GridTetromino current;
+	current.setShape(TetShape::O);
+	current.setGridLoc(board.getSpawnLoc());
+	BeamSearch search(weights, 16, 4);
+	BeamSearch::Result result = search.search(board, current, nullptr, 0);
+	MoveGenerator::PlacementList list;
+	int count = MoveGenerator::generatePlacements(board, current, list);
+	float best = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		GridTetromino placed = current;
+		placed.setRotation(list.placements[i].rotation);
+		placed.setGridLoc(list.placements[i].x, list.placements[i].y);
+		Gameboard after = board;
+		Gameboard::RowClear rowClear = after.lockBlocks(placed.getBlockLocsMappedToGrid(), placed.getColor());
+		after.removeRows(rowClear);
+		float score = static_cast<float>(weights.rowsCleared * rowClear.count) + static_cast<float>(weights.evaluate(after, 0));
+		best = (i == 0 || score > best) ? score : best;
+	}
+	assert(result.found && result.plies == 1 && result.nodes == count && result.score == best &&
+		"BeamSearch.search() - a one ply search should find the best placement");
+
+	// a longer preview searches a ply per shape, and keeps each board in the beam once
+	TetShape preview[3] = { TetShape::O, TetShape::I, TetShape::O };
+	result = search.search(board, current, preview, 3);
+	assert(result.found && result.plies == 4 && result.nodes > 3 * count && "BeamSearch.search() - a ply per shape");
+	std::vector<uint64_t> keys;
+	for (int i = 0; i < search.beamSize; i++)
+	{
+		keys.push_back(search.beam[i].board.getZobristKey());
+	}
+	std::sort(keys.begin(), keys.end());
+	assert(search.beamSize == 16 && std::unique(keys.begin(), keys.end()) == keys.end() &&
+		"BeamSearch - a board should be kept in the beam once");
+
+#ifdef ALLOCATIONS
+	// once it has run, a search allocates nothing
+	board.setContent(0, 10, 3);
+	long long before = allocationCount;
+	search.search(board, current, preview, 3);
+	assert(allocationCount == before && "BeamSearch.search() should not allocate");
+#endif
+
+	// the same game on one thread or four, and it lasts
+	BeamPolicy oneThread(weights, 32, 1);
+	BeamPolicy fourThreads(weights, 32, 4);
+	TetrisEngine a(21);
+	TetrisEngine b(21);
+	TetrisEngine::Input inputs[InputPolicy::MAX_INPUTS];
+	for (int frame = 0; frame < 400; frame++)
+	{
+		count = oneThread.chooseInputs(a, inputs);
+		for (int i = 0; i < count; i++)
+		{
+			a.input(inputs[i]);
+		}
+		count = fourThreads.chooseInputs(b, inputs);
+		for (int i = 0; i < count; i++)
+		{
+			b.input(inputs[i]);
+		}
+		a.step();
+		b.step();
+		assert(a.getChecksum() == b.getChecksum() && "BeamSearch - a game should play the same on any number of threads");
+	}
+	assert(!a.getGameOver() && a.getScore() > 0 && "BeamPolicy - should not top out in 400 shapes");
+
+	announceTestCompletion();
+#else
+	announceNotTested("BeamSearch");
+#endif
+}
+
+void TestSuite::testExpectimax()
+{
+#ifdef EXPECTIMAX
+	announceTest("Expectimax");
+
+	// with no chance plies and no preview, the search picks the best board one placement away
+	BotPolicy::Weights weights;
+	Gameboard board;
+	for (int x = 0; x < Gameboard::MAX_X - 2; x++)
+	{
+		board.setContent(x, Gameboard::MAX_Y - 1, 1);
+		board.setContent(x + 1, Gameboard::MAX_Y - 2, 2);
+	}
+	GridTetromino current;
+	current.setShape(TetShape::T);
+	current.setGridLoc(board.getSpawnLoc());
+	const uint8_t ALL = (1 << TetShape::COUNT) - 1;
+	ExpectimaxSearch known(weights, 0, 0, 4, 4);
+	ExpectimaxSearch::Result result = known.search(board, current, nullptr, 0, ALL, Randomizer::SEVEN_BAG);
+	MoveGenerator::PlacementList list;
+	int count = MoveGenerator::generatePlacements(board, current, list);
+	float best = 0.0f;
+	for (int i = 0; i < count; i++)
+	{
+		GridTetromino placed = current;
+		placed.setRotation(list.placements[i].rotation);
+		placed.setGridLoc(list.placements[i].x, list.placements[i].y);
+		Gameboard after = board;
+		Gameboard::RowClear rowClear = after.lockBlocks(placed.getBlockLocsMappedToGrid(), placed.getColor());
+		after.removeRows(rowClear);
+		float score = static_cast<float>(weights.rowsCleared * rowClear.count) + static_cast<float>(weights.evaluate(after, 0));
+		best = (i == 0 || score > best) ? score : best;
+	}
+	assert(result.found && result.chancePlies == 0 && result.nodes == count && result.score == best &&
+		"ExpectimaxSearch.search() - a one ply search should find the best placement");
+
+	// a shape that is sure to come is searched just like one in the preview
+	TetShape preview[1] = { TetShape::I };
+	result = known.search(board, current, preview, 1, ALL, Randomizer::SEVEN_BAG);
+	ExpectimaxSearch chance(weights, 1, 0, 4, 4);
+	ExpectimaxSearch::Result sure = chance.search(board, current, nullptr, 0, 1 << TetShape::I, Randomizer::SEVEN_BAG);
+	assert(sure.found && sure.chancePlies == 1 && sure.score == result.score &&
+		sure.placement.x == result.placement.x && sure.placement.y == result.placement.y &&
+		sure.placement.rotation == result.placement.rotation &&
+		"ExpectimaxSearch - a chance node with one shape should be a known shape");
+
+	// the seven bag: a drawn shape can't come again until the bag is empty
+	chance.bagged = true;
+	assert(chance.afterDrawing(ALL, TetShape::I) == (ALL & ~(1 << TetShape::I)) &&
+		chance.afterDrawing(1 << TetShape::O, TetShape::O) == ALL && "ExpectimaxSearch - a drawn shape leaves the bag");
+	chance.bagged = false;
+	assert(chance.afterDrawing(1 << TetShape::O, TetShape::O) == ALL && "ExpectimaxSearch - without a bag, any shape can come");
+
+	// the same search again is answered from the table
+	ExpectimaxSearch deep(weights, 2, 0, 4, 4);
+	ExpectimaxSearch::Result first = deep.search(board, current, preview, 1, ALL, Randomizer::SEVEN_BAG);
+	ExpectimaxSearch::Result again = deep.search(board, current, preview, 1, ALL, Randomizer::SEVEN_BAG);
+	assert(first.found && first.chancePlies == 2 && !first.outOfTime && "ExpectimaxSearch.search() - should search every chance ply");
+	assert(again.score == first.score && again.placement.x == first.placement.x && again.placement.y == first.placement.y &&
+		again.placement.rotation == first.placement.rotation && again.nodes * 10 < first.nodes &&
+		"ExpectimaxSearch - chance nodes should be memoized");
+
+#ifdef ALLOCATIONS
+	// once it has run, a search allocates nothing
+	board.setContent(0, 10, 3);
+	long long before = allocationCount;
+	deep.search(board, current, preview, 1, ALL, Randomizer::SEVEN_BAG);
+	assert(allocationCount == before && "ExpectimaxSearch.search() should not allocate");
+#endif
+
+	// the budget cuts a deep search short, keeping the deepest search that finished
+	ExpectimaxSearch hurried(weights, ExpectimaxSearch::MAX_CHANCE_PLIES, 1, 8, 1);
+	result = hurried.search(board, current, preview, 1, ALL, Randomizer::SEVEN_BAG);
+	assert(result.found && result.outOfTime && result.chancePlies < ExpectimaxSearch::MAX_CHANCE_PLIES &&
+		"ExpectimaxSearch - the time budget should stop the search");
+
+	// with no budget, the same game on one thread or four
+	ExpectimaxPolicy oneThread(weights, 1, 0, 4, 1);
+	ExpectimaxPolicy fourThreads(weights, 1, 0, 4, 4);
+	TetrisEngine a(8);
+	TetrisEngine b(8);
+	TetrisEngine::Input inputs[InputPolicy::MAX_INPUTS];
+	for (int frame = 0; frame < 150; frame++)
+	{
+		count = oneThread.chooseInputs(a, inputs);
+		for (int i = 0; i < count; i++)
+		{
+			a.input(inputs[i]);
+		}
+		count = fourThreads.chooseInputs(b, inputs);
+		for (int i = 0; i < count; i++)
+		{
+			b.input(inputs[i]);
+		}
+		a.step();
+		b.step();
+		assert(a.getChecksum() == b.getChecksum() && "ExpectimaxSearch - a game should play the same on any number of threads");
+	}
+	assert(!a.getGameOver() && a.getScore() > 0 && "ExpectimaxPolicy - should not top out in 150 shapes");
+
+	announceTestCompletion();
+#else
+	announceNotTested("Expectimax");
+#endif
+}
@@ -10,6 +10,23 @@
 #define TETROMINO
 #define GAMEBOARD
 #define GRIDTETROMINO
+//#define ALLOCATIONS	(defined by the Tests project, which counts heap allocations - see Tests/CountingAllocator.h)
+#define WALLKICKS
+#define RANDOMIZER
+#define TETRISENGINE
+#define FIXEDTIMESTEP
+#define MOVEGENERATOR
+#define PERFT
+#define BOARDFEATURES
+#define BATCHLEGALITY
+#define BATCHTETRIS
+#define GAMEFARM
+#define REPLAY
+#define KEYFRAMES
+#define CHECKSUM
+#define ZOBRIST
+#define BEAMSEARCH
+#define EXPECTIMAX
 
 #include <string>
 
@@ -21,6 +38,23 @@ private:
 	static void testTetrominoClass();	// tests for the Tetromino class
 	static void testGameboardClass();
 	static void testGridTetrominoClass(); // tests for the GridTetromino class
+	static void testMovementAllocations(); // tests that moving/rotating/testing a shape never allocates
+	static void testWallKicks();		// tests for the SRS wall kick resolver
+	static void testRandomizerClass();	// tests for the Randomizer class
+	static void testTetrisEngineClass();	// tests for the headless TetrisEngine class
+	static void testFixedTimestepClass();	// tests for the FixedTimestep class
+	static void testMoveGenerator();		// tests for the placement generator
+	static void testPerft();				// tests for the perft placement counter
+	static void testBoardFeatures();		// tests for the board feature extractor
+	static void testBatchLegality();		// tests for the batched legality test
+	static void testBatchTetrisClass();		// tests for the lock-step BatchTetris class
+	static void testGameFarmClass();		// tests for the GameFarm class and the input policies
+	static void testReplayClass();			// tests for replay recording, encoding and playback
+	static void testReplayKeyframes();		// tests for replay keyframes and seeking
+	static void testChecksum();				// tests for the rolling game state checksum
+	static void testZobrist();				// tests for the Zobrist keys and the transposition table
+	static void testBeamSearch();			// tests for the worker pool, the beam search and BeamPolicy
+	static void testExpectimax();			// tests for the expectimax search and ExpectimaxPolicy
 
 	static void announceTest(const std::string& className);
 	static void announceTestCompletion();
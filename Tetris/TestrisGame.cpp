@@ -5,17 +5,17 @@
 
 const int TetrisGame::BLOCK_WIDTH{ 32 };
 const int TetrisGame::BLOCK_HEIGHT{ 32 };
-const double TetrisGame::MAX_SECONDS_PER_TICK{ 0.72 };
-const double TetrisGame::MIN_SECONDS_PER_TICK{ 0.72 };
-const double TetrisGame::MAX_LEVELS{ 100.0 };
+const std::string TetrisGame::REPLAY_FILE{ "lastgame.replay" };
 // constructor
 //   initialize/assign private member vars names that match param names
-//   reset() the game
 //   load font from file: fonts/RedOctober.ttf
 //   setup scoreText
-// - params: already specified
-TetrisGame::TetrisGame(sf::RenderWindow& window, sf::Sprite& blockSprite, const Point& gameboardOffset, const Point& nextShapeOffset)
-	:window(window), blockSprite(blockSprite), gameboardOffset(gameboardOffset), nextShapeOffset(nextShapeOffset)
+//   load the sounds, then listen to the engine and reset() it
+// - params 1-4: already specified
+// - param 5: a uint64_t, the seed for the first game's piece sequence
+//   (each later game is seeded from the previous game's randomizer)
+TetrisGame::TetrisGame(sf::RenderWindow& window, sf::Sprite& blockSprite, const Point& gameboardOffset, const Point& nextShapeOffset, uint64_t seed)
+	:engine(seed), timestep(TetrisEngine::FRAMES_PER_SECOND), blockSprite(blockSprite), window(window), gameboardOffset(gameboardOffset), nextShapeOffset(nextShapeOffset)
 {
 	// setup our fonts for drawing the score
 	if (!scoreFont.loadFromFile("fonts/RedOctober.ttf")) { assert(false && "Missing font: RedOctober.ttf"); };
@@ -55,7 +55,8 @@ TetrisGame::TetrisGame(sf::RenderWindow& window, sf::Sprite& blockSprite, const
 	gameOverSound.setBuffer(gameOverBuffer);
 	clearedSound.setBuffer(clearedBuffer);
 	
-	reset();
+	engine.setListener(this);
+	engine.reset();
 }
 
 // Draw anything to do with the game,
@@ -69,13 +70,14 @@ void TetrisGame::draw()
 	window.draw(scoreText);
 	window.draw(levelText);
 	window.draw(gameOverText);
-	drawTetromino(currentShape, gameboardOffset, 255);
-	drawTetromino(nextShape, nextShapeOffset, 255);
-	drawTetromino(ghostShape, gameboardOffset, 128);
+	drawTetromino(engine.getCurrentShape(), gameboardOffset, 255);
+	drawTetromino(engine.getNextShape(), nextShapeOffset, 255);
+	drawTetromino(engine.getGhostShape(), gameboardOffset, 128);
 }
 
 // Event and game loop processing
 // handles keypress events (up, left, right, down, space)
+// by passing the matching input to the engine
 // - param 1: sf::Event event
 // - return: nothing
 void TetrisGame::onKeyPressed(sf::Event event)
@@ -84,255 +86,184 @@ void TetrisGame::onKeyPressed(sf::Event event)
 	{
 		if (event.key.code == sf::Keyboard::Up)
 		{
-			if (attemptRotate(currentShape))
-			{ 
-				rotateSound.play();
-				updateGhostShape();
-			}
+			applyInput(TetrisEngine::ROTATE);
 		}
 		if (event.key.code == sf::Keyboard::Left)
 		{
-			attemptMove(currentShape,-1,0);
-			updateGhostShape();
+			applyInput(TetrisEngine::MOVE_LEFT);
 		}
 		if (event.key.code == sf::Keyboard::Right)
 		{
-			attemptMove(currentShape, 1, 0);
-			updateGhostShape();
+			applyInput(TetrisEngine::MOVE_RIGHT);
 		}
 		if (event.key.code == sf::Keyboard::Down)
 		{
-			attemptMove(currentShape, 0, 1);
-			updateGhostShape();
+			applyInput(TetrisEngine::SOFT_DROP);
 		}
 		if (event.key.code == sf::Keyboard::Space)
 		{
-			drop(currentShape);
-			lock(currentShape);
-			dropSound.play();
+			applyInput(TetrisEngine::HARD_DROP);
 		}
 		if (event.key.code == sf::Keyboard::Q)
 		{
-			if (gameOver) { window.close(); }
+			if (engine.getGameOver()) { window.close(); }
 		}
 		if (event.key.code == sf::Keyboard::Enter)
 		{
-			if (gameOver) { reset(); }
+			if (engine.getGameOver())
+			{
+				timestep.reset();
+				engine.newGame();
+			}
 		}
 	}
 }
 
-// called every game loop to handle ticks & tetromino placement (locking)
-// - param 1: float secondsSinceLastLoop
+// called every game loop to advance the engine
+//   the elapsed time goes into the fixed timestep, and the engine is stepped
+//   once for each whole frame that is due (after the auto player's inputs, if any)
+// - param 1: sf::Time timeSinceLastLoop
 // return: nothing
-void TetrisGame::processGameLoop(float secondsSinceLastLoop)
+void TetrisGame::processGameLoop(sf::Time timeSinceLastLoop)
 {
-	secondsSinceLastTick += secondsSinceLastLoop;
-	if (secondsSinceLastTick > secondsPerTick)
-	{
-		tick(); 
-		secondsSinceLastTick = 0.0;
-	}
-	if (shapePlacedSinceLastGameLoop) 
+	int steps = timestep.advance(timeSinceLastLoop.asMicroseconds());
+	TetrisEngine::Input inputs[InputPolicy::MAX_INPUTS];
+	for (int i = 0; i < steps; i++)
 	{
-		if (spawnNextShape()) 
+		if (autoPlayer)
 		{
-			nextShape.setShape(Tetromino::getRandomShape());
-
-			int rowsRemoved = board.removeCompletedRows();
-			if (rowsRemoved > 0)
-			{
-				clearedSound.play();
-			}
-
-			if (rowsRemoved == 1)
+			int count = autoPlayer->chooseInputs(engine, inputs);
+			for (int input = 0; input < count; input++)
 			{
-				score += 40 * (level + 1);
-				determineSecondsPerTick();
-			}
-			if (rowsRemoved == 2)
-			{
-				score += 100 * (level + 1);
-				determineSecondsPerTick();
-			}
-			if (rowsRemoved == 3)
-			{
-				score += 300 * (level + 1);
-				determineSecondsPerTick();
-			}
-			if (rowsRemoved == 4)
-			{
-				score += 1200 * (level + 1);
-				determineSecondsPerTick();
-			}
-			updateScoreDisplay();
-			cleared += rowsRemoved;
-		
-			if (cleared >= 10)
-			{
-				level++;
-				cleared = cleared % 10;
-				levelUp.play();
-				updateLevelDisplay();
+				applyInput(inputs[input]);
 			}
 		}
-		else 
+		engine.step();
+		if (recording)
 		{
-			gameOver = true;
-			music.stop();
-			gameOverSound.play();
-			gameOverText.setString("Play Again: Enter   Quit: Q");
+			replay.recordChecksum(engine);
 		}
-
-		shapePlacedSinceLastGameLoop = false;
 	}
 }
 
-// A tick() forces the currentShape to move (if there were no tick,
-// the currentShape would float in position forever). This should
-// call attemptMove() on the currentShape.  If not successful, lock() 
-// the currentShape (it can move no further).
-// - params: none
+// let an InputPolicy play the game (e.g. a bot - see BeamSearch.h)
+//   the policy is started on the current game's seed, and again for each new game
+// - param 1: an InputPolicy pointer (not owned), or nullptr to go back to the keyboard alone
 // - return: nothing
-void TetrisGame::tick()
+void TetrisGame::setAutoPlayer(InputPolicy *policy)
 {
-	bool check = attemptMove(currentShape, 0, 1);
-	updateGhostShape();
-	if (!check) 
+	autoPlayer = policy;
+	if (autoPlayer)
 	{
-		lock(currentShape);
+		autoPlayer->newGame(engine.getSeed());
 	}
 }
 
-// reset everything for a new game (use existing functions) 
-//  - set the score to 0 and call updateScoreDisplay()
-//  - call determineSecondsPerTick() to determine the tick rate.
-//  - clear the gameboard,
-//  - pick & spawn next shape
-//  - pick next shape again (for the "on-deck" shape)
+// get the InputPolicy playing the game
 // - params: none
-// - return: nothing
-void TetrisGame::reset()
+// - return: an InputPolicy pointer, or nullptr for none
+InputPolicy *TetrisGame::getAutoPlayer() const
 {
-	score = 0;
-	level = 0;
-	updateScoreDisplay();
-	updateLevelDisplay();
-	determineSecondsPerTick();
-	board.empty();
-	pickNextShape();
-	spawnNextShape();
-	pickNextShape();
-	music.play();
-	gameOver = false;
+	return autoPlayer;
 }
 
-// assign nextShape.setShape a new random shape  
+// getter for the engine's gameOver state
 // - params: none
-// - return: nothing
-void TetrisGame::pickNextShape()
+// - return: bool representing current state of the game
+bool TetrisGame::getGameOver() const
+{
+	return engine.getGameOver();
+}
+
+// take a snapshot of the game (see TetrisEngine::saveState())
+// - params: none
+// - return: a GameState, the snapshot
+GameState TetrisGame::saveState() const
 {
-	nextShape.setShape(Tetromino::getRandomShape());
+	return engine.saveState();
 }
 
-// update the ghost shape to drop just under the current shape
-// - params: nothing
+// carry on from a snapshot (see TetrisEngine::loadState()),
+//   then bring the score, level and game over text up to date
+//   (the current game is no longer recorded: its replay would not play back)
+// - param 1: a GameState, the snapshot
 // - return: nothing
-void TetrisGame::updateGhostShape()
+void TetrisGame::loadState(const GameState &state)
 {
-	ghostShape = currentShape;
-	drop(ghostShape);
+	engine.loadState(state);
+	recording = false;
+	updateScoreDisplay();
+	updateLevelDisplay();
+	gameOverText.setString(engine.getGameOver() ? "Play Again: Enter   Quit: Q" : "");
 }
 
-// copy the nextShape into the currentShape (through assignment)
-//   position the currentShape to its spawn location.
-// - params: none
-// - return: bool, true/false based on isPositionLegal()
-bool TetrisGame::spawnNextShape()
+// TetrisListener events =========================================
+// (called by the engine - play the matching sound and update the text)
+void TetrisGame::onNewGame()
 {
-	currentShape = nextShape;
-	currentShape.setGridLoc(board.getSpawnLoc());
-	if (isPositionLegal(currentShape))
+	replay.start(engine);
+	recording = true;
+	if (autoPlayer)
 	{
-		return true;
+		autoPlayer->newGame(engine.getSeed());
 	}
-	return false;
+	updateScoreDisplay();
+	updateLevelDisplay();
+	gameOverText.setString("");
+	music.play();
 }
 
-// Test if a rotation is legal on the tetromino and if so, rotate it. 
-//  To accomplish this:
-//	 1) create a (local) temporary copy of the tetromino
-//	 2) rotate it (temp.rotateClockwise())
-//	 3) test if temp rotation was legal (isPositionLegal()), 
-//      if so - rotate the original tetromino.
-// - param 1: GridTetromino shape
-// - return: bool, true/false to indicate successful movement
-bool TetrisGame::attemptRotate(GridTetromino& shape)
+void TetrisGame::onRotate()
 {
-	if (gameOver) { return false; }
-	GridTetromino temp = shape;
-	temp.rotateClockwise();
-	if (isPositionLegal(temp))
-	{
-		shape.rotateClockwise();
-		return true;
-	}
-	return false;
+	rotateSound.play();
 }
 
-// test if a move is legal on the tetromino, if so, move it.
-//  To do this:
-//	 1) create a (local) temporary copy of the tetromino
-//	 2) move it (temp.move())
-//	 3) test if temp move was legal (isPositionLegal(),
-//      if so - move the original.	
-// - param 1: GridTetromino shape
-// - param 2: int x;
-// - param 3: int y;
-// - return: true/false to indicate successful movement
-bool TetrisGame::attemptMove(GridTetromino& shape, int x, int y)
+void TetrisGame::onHardDrop()
 {
-	if (gameOver) { return false; }
-	GridTetromino temp = shape;
-	temp.move(x,y);
-	if (isPositionLegal(temp)) 
-	{
-		shape.move(x, y);
-		return true;
-	}
-	return false;
+	dropSound.play();
 }
 
-// drops the tetromino vertically as far as it can 
-//   legally go.  Use attemptMove(). This can be done in 1 line.
-// - param 1: GridTetromino shape
-// - return: nothing;
-void TetrisGame::drop(GridTetromino& shape)
+void TetrisGame::onRowsCleared(int rows)
 {
-	while (attemptMove(shape, 0, 1)){}
+	clearedSound.play();
 }
 
-// copy the contents (color) of the tetromino's mapped block locs to the grid.
-	//	 1) get the tetromino's mapped locs via tetromino.getBlockLocsMappedToGrid()
-	//   2) use the board's setContent() method to set the content at the mapped locations.
-	//   3) record the fact that we placed a shape by setting shapePlacedSinceLastGameLoop
-	//      to true
-	// - param 1: GridTetromino shape
-	// - return: nothing
-void TetrisGame::lock(GridTetromino& shape)
+void TetrisGame::onScoreChanged(int64_t score)
 {
-	std::vector<Point> blocks = shape.getBlockLocsMappedToGrid();
-	for (auto& block : blocks)
+	updateScoreDisplay();
+}
+
+void TetrisGame::onLevelUp(int level)
+{
+	levelUp.play();
+	updateLevelDisplay();
+}
+
+void TetrisGame::onGameOver()
+{
+	music.stop();
+	gameOverSound.play();
+	gameOverText.setString("Play Again: Enter   Quit: Q");
+	if (recording)
 	{
-		board.setContent(block, shape.getColor());
+		replay.finish(engine);
+		replay.buildKeyframes();
+		replay.save(REPLAY_FILE);
 	}
-	shapePlacedSinceLastGameLoop = true;
 }
 
-bool TetrisGame::getGameOver() const
+// record an input in the replay and give it to the engine
+// - param 1: the Input
+// - return: nothing
+void TetrisGame::applyInput(TetrisEngine::Input input)
 {
-	return gameOver;
+	if (recording)
+	{
+		replay.record(engine.getFrame(), input);
+	}
+	engine.input(input);
 }
+
 // Graphics methods ==============================================
 
 // Draw a tetris block sprite on the canvas		
@@ -367,6 +298,7 @@ void TetrisGame::drawBlock(const Point& topLeft, int xOffset, int yOffset, const
 // return: nothing
 void TetrisGame::drawGameboard()
 {
+	const Gameboard &board = engine.getBoard();
 	for (int i = 0; i < board.MAX_Y; i++)
 	{
 		for (int j = 0; j < board.MAX_X; j++)
@@ -387,9 +319,9 @@ void TetrisGame::drawGameboard()
 // param 1: GridTetromino tetromino
 // param 2: Point topLeft
 // return: nothing
-void TetrisGame::drawTetromino(GridTetromino& tetromino, Point topLeft, int transparency)
+void TetrisGame::drawTetromino(const GridTetromino& tetromino, Point topLeft, int transparency)
 {
-	std::vector<Point>blocks = tetromino.getBlockLocsMappedToGrid();
+	BlockList blocks = tetromino.getBlockLocsMappedToGrid();
 	
 	for (auto& block : blocks)
 	{
@@ -404,7 +336,7 @@ void TetrisGame::drawTetromino(GridTetromino& tetromino, Point topLeft, int tran
 // return: nothing
 void TetrisGame::updateScoreDisplay() 
 {
-	std::string current_score = std::to_string(score);
+	std::string current_score = std::to_string(engine.getScore());
 	std::string text = "score: " + current_score;
 	scoreText.setString(text);
 }
@@ -416,57 +348,7 @@ void TetrisGame::updateScoreDisplay()
 // return: nothing
 void TetrisGame::updateLevelDisplay()
 {
-	std::string current_level = std::to_string(level);
+	std::string current_level = std::to_string(engine.getLevel());
 	std::string text = "level: " + current_level;
 	levelText.setString(text);
 }
-
-// State & gameplay/logic methods ================================
-
-// Determine if a Tetromino can legally be placed at its current position
-// on the gameboard.
-//   Tip: Make use of Gameboard's areLocsEmpty() and pass it the shape's mapped locs.
-// - param 1: GridTetromino shape
-// - return: bool, true if shape is within borders (isWithinBorders()) and 
-//           the shape's mapped board locs are empty (false otherwise).
-bool TetrisGame::isPositionLegal(GridTetromino& shape) const
-{
-	std::vector<Point> blocks = shape.getBlockLocsMappedToGrid(); 
-	if (board.areAllLocsEmpty(blocks) && isWithinBorders(shape))
-	{
-		return true;
-	}
-	return false;
-}
-
-
-// Determine if the shape is within the left, right, & bottom gameboard borders
-//   * Ignore the upper border because we want shapes to be able to drop
-//     in from the top of the gameboard.
-//   All of a shape's blocks must be inside these 3 borders to return true
-// - param 1: GridTetromino shape
-// - return: bool, true if the shape is within the left, right, and lower border
-//	         of the grid, but *NOT* the top border (false otherwise)
-bool TetrisGame::isWithinBorders(GridTetromino shape) const
-{
-	std::vector<Point> blocks = shape.getBlockLocsMappedToGrid();
-	bool check = true;
-	for (auto& block : blocks)
-	{
-		if (block.getX() >= 0 && block.getX() <= 9 && block.getY() <= Gameboard::MAX_Y){} // do nothing if this is true
-		else { check = false; }
-	}
-	return check;
-}
-
-
-// set secsPerTick 
-//   - basic: use MAX_SECS_PER_TICK
-//   - advanced: base it on score (higher score results in lower secsPerTick)
-// params: none
-// return: nothing
-void TetrisGame::determineSecondsPerTick()
-{
-	double update_seconds = MAX_SECONDS_PER_TICK - (static_cast<double>(level)/ MAX_LEVELS);		// max levels are 10 and 300 points bumps you to a new level for now
-	secondsPerTick = update_seconds;
-}
\ No newline at end of file
@@ -0,0 +1,560 @@
+#include "Checksum.h"
+#include "TetrisEngine.h"
+#include "WallKicks.h"
+#include "Zobrist.h"
+
+
+const int TetrisEngine::FRAMES_PER_SECOND{ 60 };
+const int32_t TetrisEngine::GRAVITY_UNIT{ 65536 };
+const int32_t TetrisEngine::MAX_GRAVITY{ 20 * 65536 };
+const int TetrisEngine::MAX_FRAMES_PER_ROW{ 43 };
+const int TetrisEngine::MAX_LEVELS{ 100 };
+
+// constructor
+//   start a new game with the given seed
+// - param 1: a uint64_t, the seed for the first game's piece sequence
+//   (each later game is seeded from the previous game's randomizer)
+TetrisEngine::TetrisEngine(uint64_t seed)
+	:seed(seed), randomizer(seed, Randomizer::SEVEN_BAG)
+{
+	reset();
+}
+
+// register something to be told about game events
+// - param 1: a TetrisListener pointer (not owned), or nullptr for none
+// - return: nothing
+void TetrisEngine::setListener(TetrisListener *listener)
+{
+	this->listener = listener;
+}
+
+// reset everything for a new game, using the current seed
+//  - set the score and level to 0
+//  - call determineGravity() to determine the fall rate.
+//  - clear the gameboard,
+//  - restart the randomizer from seed
+//  - pick & spawn next shape
+//  - pick next shape again (for the "on-deck" shape)
+//  - tell the listener (onNewGame)
+// - params: none
+// - return: nothing
+void TetrisEngine::reset()
+{
+	gameOver = false;	// (first: spawning and dropping the ghost do nothing once the game is over)
+	score = 0;
+	level = 0;
+	cleared = 0;
+	determineGravity();
+	frame = 0;
+	gravityProgress = 0;
+	shapePlacedSinceLastStep = false;
+	lockedRows = Gameboard::RowClear();
+	board.empty();
+	randomizer.reset(seed);
+	pickNextShape();
+	spawnNextShape();
+	pickNextShape();
+	updateGhostShape();
+	updateBoardKey();
+	updateShapeKey();
+	updateProgressKey();
+	checksum = 0;
+	if (listener) { listener->onNewGame(); }
+}
+
+// start the following game: draw a new seed from the randomizer and reset()
+// - params: none
+// - return: nothing
+void TetrisEngine::newGame()
+{
+	seed = randomizer.nextRandom();
+	reset();
+}
+
+// apply a player action to the current shape
+//   does nothing once the game is over
+// - param 1: an Input, the action
+// - return: bool, true if the action changed the current shape
+bool TetrisEngine::input(Input action)
+{
+	if (gameOver) { return false; }
+
+	bool moved = false;
+	switch (action)
+	{
+	case MOVE_LEFT:
+		moved = attemptMove(currentShape, -1, 0);
+		break;
+	case MOVE_RIGHT:
+		moved = attemptMove(currentShape, 1, 0);
+		break;
+	case SOFT_DROP:
+		moved = attemptMove(currentShape, 0, 1);
+		break;
+	case ROTATE:
+		moved = attemptRotate(currentShape);
+		if (moved && listener) { listener->onRotate(); }
+		break;
+	case HARD_DROP:
+		drop(currentShape);
+		updateShapeKey();
+		lock(currentShape);
+		if (listener) { listener->onHardDrop(); }
+		return true;
+	}
+	if (moved)
+	{
+		updateGhostShape();
+		updateShapeKey();
+	}
+	return moved;
+}
+
+// advance the game by one frame
+//   handles gravity & tetromino placement (locking): the current shape falls
+//   the whole rows of gravity that are due (see fall()), and when a shape has
+//   been locked, spawn the next one, clear rows and update score and level.
+//   does nothing once the game is over
+// - params: none
+// - return: nothing
+void TetrisEngine::step()
+{
+	if (gameOver) { return; }
+
+	frame++;
+	gravityProgress += gravity;
+	int rows = gravityProgress / GRAVITY_UNIT;
+	if (rows > 0)
+	{
+		gravityProgress -= rows * GRAVITY_UNIT;
+		if (!shapePlacedSinceLastStep)	// (a shape hard dropped this frame is already locked)
+		{
+			fall(rows);
+		}
+	}
+	if (shapePlacedSinceLastStep)
+	{
+		processLock();
+		shapePlacedSinceLastStep = false;
+	}
+	checksum = Checksum::mix(checksum ^ Checksum::mix(boardKey + shapeKey) ^
+		(progressKey + static_cast<uint32_t>(gravityProgress)));
+}
+
+// A tick() forces the currentShape to fall one row (if there were no tick,
+// the currentShape would float in position forever).  If it can move no
+// further, lock() the currentShape.
+// - params: none
+// - return: nothing
+void TetrisEngine::tick()
+{
+	if (gameOver) { return; }
+	fall(1);
+}
+
+// take a snapshot of the game (everything but the listener)
+// - params: none
+// - return: a GameState, the snapshot
+GameState TetrisEngine::saveState() const
+{
+	GameState state;
+	state.board = board;
+	state.currentShape = currentShape;
+	state.nextShape = nextShape;
+	state.lockedRows = lockedRows;
+	state.randomizer = randomizer;
+	state.seed = seed;
+	state.frame = frame;
+	state.gravity = gravity;
+	state.gravityProgress = gravityProgress;
+	state.score = score;
+	state.level = level;
+	state.cleared = cleared;
+	state.gameOver = gameOver;
+	state.shapePlacedSinceLastStep = shapePlacedSinceLastStep;
+	state.checksum = checksum;
+	return state;
+}
+
+// carry on from a snapshot taken by saveState()
+//   the listener is kept, and is not told about the change
+// - param 1: a GameState, the snapshot
+// - return: nothing
+void TetrisEngine::loadState(const GameState &state)
+{
+	board = state.board;
+	currentShape = state.currentShape;
+	nextShape = state.nextShape;
+	lockedRows = state.lockedRows;
+	randomizer = state.randomizer;
+	seed = state.seed;
+	frame = state.frame;
+	gravity = state.gravity;
+	gravityProgress = state.gravityProgress;
+	score = state.score;
+	level = state.level;
+	cleared = state.cleared;
+	gameOver = state.gameOver;
+	shapePlacedSinceLastStep = state.shapePlacedSinceLastStep;
+	checksum = state.checksum;
+	updateGhostShape();
+	updateBoardKey();
+	updateShapeKey();
+	updateProgressKey();
+}
+
+// start the current game at a higher level (e.g. for speed runs and bots)
+//   updates the gravity to match
+// - param 1: an int, the level
+// - return: nothing
+void TetrisEngine::setLevel(int level)
+{
+	this->level = level;
+	determineGravity();
+	updateProgressKey();
+}
+
+// getters for the game state
+// - params: none
+// - return: the matching member (see above)
+const Gameboard &TetrisEngine::getBoard() const
+{
+	return board;
+}
+
+const GridTetromino &TetrisEngine::getCurrentShape() const
+{
+	return currentShape;
+}
+
+const GridTetromino &TetrisEngine::getNextShape() const
+{
+	return nextShape;
+}
+
+const GridTetromino &TetrisEngine::getGhostShape() const
+{
+	return ghostShape;
+}
+
+int64_t TetrisEngine::getScore() const
+{
+	return score;
+}
+
+int TetrisEngine::getLevel() const
+{
+	return level;
+}
+
+bool TetrisEngine::getGameOver() const
+{
+	return gameOver;
+}
+
+uint64_t TetrisEngine::getSeed() const
+{
+	return seed;
+}
+
+const Randomizer &TetrisEngine::getRandomizer() const
+{
+	return randomizer;
+}
+
+uint32_t TetrisEngine::getFrame() const
+{
+	return frame;
+}
+
+int32_t TetrisEngine::getGravity() const
+{
+	return gravity;
+}
+
+// get the rolling checksum of the game: every frame stepped folds in the board
+// (occupancy and colors), the falling shape, the next shape, the randomizer,
+// the score, level and rows cleared (see Checksum.h)
+//   two games that have played the same frames the same way always agree;
+//   games that differ on any frame disagree from then on (but for a 1 in
+//   2^64 chance)
+// - params: none
+// - return: a uint64_t, 0 at the start of a game
+uint64_t TetrisEngine::getChecksum() const
+{
+	return checksum;
+}
+
+// get the Zobrist key of the position: the board's occupancy, the falling
+// shape (its shape, rotation and gridLoc) and the next shape (see Zobrist.h)
+//   for bots to recognise positions they have seen before
+// - params: none
+// - return: a uint64_t
+uint64_t TetrisEngine::getZobristKey() const
+{
+	return board.getZobristKey() ^ pieceZobristKey ^ Zobrist::KEYS.nextShapes[nextShape.getShape()];
+}
+
+// assign nextShape.setShape the next shape from the randomizer
+// - params: none
+// - return: nothing
+void TetrisEngine::pickNextShape()
+{
+	nextShape.setShape(randomizer.next());
+}
+
+// update the ghost shape to drop just under the current shape
+// - params: nothing
+// - return: nothing
+void TetrisEngine::updateGhostShape()
+{
+	ghostShape = currentShape;
+	drop(ghostShape);
+}
+
+// update boardKey after the board changes (a lock, a line clear, a new game
+// or a loaded state)
+// - params: none
+// - return: nothing
+void TetrisEngine::updateBoardKey()
+{
+	boardKey = board.getChecksum();
+}
+
+// update shapeKey (and pieceZobristKey) after the current shape moves, rotates or spawns
+// - params: none
+// - return: nothing
+void TetrisEngine::updateShapeKey()
+{
+	shapeKey = Checksum::shapeKey(currentShape.getShape(), currentShape.getRotation(),
+		currentShape.getGridLoc().getX(), currentShape.getGridLoc().getY());
+	pieceZobristKey = Zobrist::pieceKey(currentShape.getShape(), currentShape.getRotation(),
+		currentShape.getGridLoc().getX(), currentShape.getGridLoc().getY());
+}
+
+// update progressKey after a lock (or anything else that changes the next
+// shape, the randomizer, score, level or rows cleared)
+// - params: none
+// - return: nothing
+void TetrisEngine::updateProgressKey()
+{
+	progressKey = Checksum::mix(randomizer.getChecksum() ^ nextShape.getShape());
+	progressKey = Checksum::mix(progressKey ^ (static_cast<uint64_t>(static_cast<uint32_t>(score)) << 32 |
+		static_cast<uint64_t>(level) << 8 | static_cast<uint64_t>(cleared)));
+}
+
+// copy the nextShape into the currentShape (through assignment)
+//   position the currentShape to its spawn location.
+//   The shape has spawned legally if the board can report a drop distance for it
+//   (getDropDistance() returns -1 when the spawn spot is already blocked).
+// - params: none
+// - return: bool, true if the shape spawned legally, false if the board has topped out
+bool TetrisEngine::spawnNextShape()
+{
+	currentShape = nextShape;
+	currentShape.setGridLoc(board.getSpawnLoc());
+	updateShapeKey();
+	BlockList blocks = currentShape.getBlockLocsMappedToGrid();
+	return board.getDropDistance(blocks) >= 0;
+}
+
+// make the currentShape fall up to the given number of rows in one move.
+//   The distance it can fall comes from the board's skyline (getDropDistance()),
+//   so the cost is the same for 1 row or 20.  If it is already resting on
+//   the stack or the floor, lock() it instead.
+// - param 1: an int, the rows to fall
+// - return: nothing
+void TetrisEngine::fall(int rows)
+{
+	BlockList blocks = currentShape.getBlockLocsMappedToGrid();
+	int distance = board.getDropDistance(blocks);
+	if (distance <= 0)
+	{
+		lock(currentShape);
+		return;
+	}
+	currentShape.move(0, (rows < distance) ? rows : distance);
+	updateShapeKey();
+}
+
+// spawn the next shape after a lock, then remove the locked rows and
+// update the score and level (or end the game if the spawn failed)
+// - params: none
+// - return: nothing
+void TetrisEngine::processLock()
+{
+	if (!spawnNextShape())
+	{
+		gameOver = true;
+		updateBoardKey();
+		if (listener) { listener->onGameOver(); }
+		return;
+	}
+	pickNextShape();
+
+	board.removeRows(lockedRows);
+	updateBoardKey();
+	int rowsRemoved = lockedRows.count;
+	if (rowsRemoved > 0)
+	{
+		if (rowsRemoved == 1)
+		{
+			score += 40 * (level + 1);
+		}
+		if (rowsRemoved == 2)
+		{
+			score += 100 * (level + 1);
+		}
+		if (rowsRemoved == 3)
+		{
+			score += 300 * (level + 1);
+		}
+		if (rowsRemoved == 4)
+		{
+			score += 1200 * (level + 1);
+		}
+		determineGravity();
+		if (listener)
+		{
+			listener->onRowsCleared(rowsRemoved);
+			listener->onScoreChanged(score);
+		}
+	}
+	cleared += rowsRemoved;
+
+	if (cleared >= 10)
+	{
+		level++;
+		cleared = cleared % 10;
+		determineGravity();
+		if (listener) { listener->onLevelUp(level); }
+	}
+	updateGhostShape();
+	updateProgressKey();
+}
+
+// Test if a rotation is legal on the tetromino and if so, rotate it.
+//  To accomplish this (without copying the tetromino):
+//	 1) ask WallKicks::resolveClockwise() for the first SRS kick where the
+//      rotated shape fits on the board,
+//	 2) if there is one - rotate the tetromino and move it by the kick.
+// - param 1: GridTetromino shape
+// - return: bool, true/false to indicate successful movement
+bool TetrisEngine::attemptRotate(GridTetromino &shape)
+{
+	if (gameOver) { return false; }
+	Point kick;
+	if (WallKicks::resolveClockwise(board, shape.getShape(), shape.getRotation(),
+		shape.getGridLoc().getX(), shape.getGridLoc().getY(), kick))
+	{
+		shape.rotateClockwise();
+		shape.move(kick.getX(), kick.getY());
+		return true;
+	}
+	return false;
+}
+
+// test if a move is legal on the tetromino, if so, move it.
+//  To do this (without copying the tetromino):
+//	 1) test the shape's block locs at its gridLoc plus the move (board.canPlace())
+//	 2) if legal - move the shape.
+// - param 1: GridTetromino shape
+// - param 2: int x;
+// - param 3: int y;
+// - return: true/false to indicate successful movement
+bool TetrisEngine::attemptMove(GridTetromino &shape, int x, int y)
+{
+	if (gameOver) { return false; }
+	if (board.canPlace(shape.getBlockLocs(), shape.getGridLoc().getX() + x, shape.getGridLoc().getY() + y))
+	{
+		shape.move(x, y);
+		return true;
+	}
+	return false;
+}
+
+// drops the tetromino vertically as far as it can
+//   legally go.  The distance comes from the board's skyline (getDropDistance()),
+//   so the shape is moved once rather than one row at a time.
+// - param 1: GridTetromino shape
+// - return: nothing;
+void TetrisEngine::drop(GridTetromino &shape)
+{
+	if (gameOver) { return; }
+	BlockList blocks = shape.getBlockLocsMappedToGrid();
+	int distance = board.getDropDistance(blocks);
+	if (distance > 0)
+	{
+		shape.move(0, distance);
+	}
+}
+
+// copy the contents (color) of the tetromino's mapped block locs to the grid.
+//	 1) get the tetromino's mapped locs via tetromino.getBlockLocsMappedToGrid()
+//   2) use the board's lockBlocks() method to set the content at the mapped locations,
+//      keeping the rows it completed in lockedRows.
+//   3) record the fact that we placed a shape by setting shapePlacedSinceLastStep
+//      to true
+//   4) tell the listener (onShapeLocked)
+// - param 1: GridTetromino shape
+// - return: nothing
+void TetrisEngine::lock(GridTetromino &shape)
+{
+	BlockList blocks = shape.getBlockLocsMappedToGrid();
+	lockedRows = board.lockBlocks(blocks, shape.getColor());
+	shapePlacedSinceLastStep = true;
+	if (listener) { listener->onShapeLocked(); }
+}
+
+// Determine if a Tetromino can legally be placed at its current position
+// on the gameboard.
+//   Uses Gameboard's canPlace() on the shape's block locs at its gridLoc, which
+//   checks the borders and the board content in a single pass.
+// - param 1: GridTetromino shape
+// - return: bool, true if shape is within borders and
+//           the shape's mapped board locs are empty (false otherwise).
+bool TetrisEngine::isPositionLegal(const GridTetromino &shape) const
+{
+	return board.canPlace(shape.getBlockLocs(), shape.getGridLoc().getX(), shape.getGridLoc().getY());
+}
+
+// Determine if the shape is within the left, right, & bottom gameboard borders
+//   * Ignore the upper border because we want shapes to be able to drop
+//     in from the top of the gameboard.
+//   All of a shape's blocks must be inside these 3 borders to return true
+// - param 1: GridTetromino shape
+// - return: bool, true if the shape is within the left, right, and lower border
+//	         of the grid, but *NOT* the top border (false otherwise)
+bool TetrisEngine::isWithinBorders(const GridTetromino &shape) const
+{
+	BlockList blocks = shape.getBlockLocsMappedToGrid();
+	bool check = true;
+	for (auto& block : blocks)
+	{
+		if (block.getX() >= 0 && block.getX() < Gameboard::MAX_X && block.getY() < Gameboard::MAX_Y){} // do nothing if this is true
+		else { check = false; }
+	}
+	return check;
+}
+
+// set gravity from the level
+//   - level 0 falls a row every MAX_FRAMES_PER_ROW frames, and each level
+//     takes 1/100th of a second off that
+//   - once that reaches 1 row per frame, each further 1/60th of a second
+//     adds another row per frame, up to MAX_GRAVITY
+// params: none
+// return: nothing
+void TetrisEngine::determineGravity()
+{
+	int framesPerRow = MAX_FRAMES_PER_ROW - (level * FRAMES_PER_SECOND) / MAX_LEVELS;	// 1/100th of a second faster per level
+	if (framesPerRow > 1)
+	{
+		// round up, so the first row falls after exactly framesPerRow frames
+		gravity = (GRAVITY_UNIT + framesPerRow - 1) / framesPerRow;
+	}
+	else
+	{
+		int rowsPerFrame = 2 - framesPerRow;
+		gravity = (rowsPerFrame >= MAX_GRAVITY / GRAVITY_UNIT) ? MAX_GRAVITY : rowsPerFrame * GRAVITY_UNIT;
+	}
+}
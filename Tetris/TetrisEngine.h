@@ -0,0 +1,317 @@
+// This class holds the rules and state of a single tetris game.
+//
+// It is plain C++ (no SFML): there is no window, no sound and nothing is loaded
+// from disk, so a game can be created, played and tested anywhere - including a
+// server with no display or audio device.
+//
+// A game is driven through two calls:
+//   - input(): apply a player action (move, rotate, drop) to the current shape
+//   - step():  advance the game by one frame, which makes the current shape fall, and
+//              locks it, clears rows, scores and spawns the next shape as needed
+// and read back through the getters (board, shapes, score, level, game over).
+//
+// Time is counted in whole frames (FRAMES_PER_SECOND of them per second of play),
+// never in seconds: the engine has no clock of its own, so a game is exactly
+// reproducible from its seed and the frame number of each input.  Turning wall
+// clock time into a number of steps is the caller's job (see FixedTimestep).
+//
+// Anything that wants to react to the game (drawing, sounds, text) is layered on
+// top: it reads the getters, and can register a TetrisListener to be told when
+// things happen.  TetrisGame is the SFML layer for the desktop game.
+//
+// Every step also folds the game state into a rolling checksum (getChecksum(),
+// see Checksum.h), so two copies of a game that should be playing in lockstep -
+// a replay and its recording, two builds, two networked peers - can compare one
+// number per frame and know on the very frame they drift apart.
+//
+// This class is responsible for:
+//   - setting up the board,
+//   - spawning tetrominoes,
+//   - moving and placing tetrominoes,
+//   - clearing rows, scoring and levels
+
+#ifndef TETRISENGINE_H
+#define TETRISENGINE_H
+
+#include <cstdint>
+#include "Gameboard.h"
+#include "GridTetromino.h"
+#include "Randomizer.h"
+#include "GameState.h"
+#include "TetrisListener.h"
+
+class TetrisEngine
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+public:
+	// the player actions a game accepts
+	enum Input
+	{
+		MOVE_LEFT,
+		MOVE_RIGHT,
+		SOFT_DROP,
+		ROTATE,
+		HARD_DROP
+	};
+
+	// STATIC CONSTANTS
+	static const int FRAMES_PER_SECOND;		// simulation frames per second of play, init to 60
+	static const int32_t GRAVITY_UNIT;		// gravity of 1 row per frame ("1G"), init to 65536 (16.16 fixed point)
+	static const int32_t MAX_GRAVITY;		// the fastest gravity, init to 20G (straight to the floor)
+	static const int MAX_FRAMES_PER_ROW;	// frames per row at level 0, init to 43 (~0.72 seconds)
+	static const int MAX_LEVELS;
+
+private:
+	// MEMBER VARIABLES
+
+	// State members ---------------------------------------------
+	int64_t score;				// the current game score (64 bits: a bot can play for days)
+	int level;					// the current level the player is on
+	int cleared;				// the amount of rows cleared on the current level
+	bool gameOver{ false };
+	Gameboard board;			// the gameboard (grid) to represent where all the blocks are.
+	GridTetromino nextShape;	// the tetromino shape that is "on deck".
+	GridTetromino currentShape;	// the tetromino that is currently falling.
+	GridTetromino ghostShape;	// the ghost shape for where the current shape will land
+	Gameboard::RowClear lockedRows;	// the rows completed by the last locked shape (removed next step)
+	uint64_t seed;				// the seed the current game's piece sequence started from
+	Randomizer randomizer;		// chooses the shapes (owned per game, so games never share random state)
+
+	TetrisListener *listener{ nullptr };	// told about game events (not owned, may be nullptr)
+
+	// Time members ----------------------------------------------
+	// Note: gravity is how far the current shape falls each frame, in rows / GRAVITY_UNIT,
+	// so it can be a fraction of a row (level 0) or many rows (high levels).
+	uint32_t frame{ 0 };						// the number of frames stepped in the current game
+	int32_t gravity{ 0 };						// the rows per frame, in GRAVITY_UNITs (changes depending on level)
+
+	int32_t gravityProgress{ 0 };				// add gravity to this every step, each whole GRAVITY_UNIT
+												// is a row the shape has to fall.
+	bool shapePlacedSinceLastStep{ false };		// Tracks whether we have placed (locked) a shape on
+												// the gameboard since the last step
+
+	// Checksum members ------------------------------------------
+	uint64_t checksum{ 0 };			// the rolling checksum, folded in at the end of every step
+	uint64_t boardKey{ 0 };			// the board's checksum, updated whenever the board changes
+	uint64_t shapeKey{ 0 };			// the key of currentShape, updated whenever it moves
+	uint64_t progressKey{ 0 };		// the key of everything else (next shape, randomizer,
+									// score, level, cleared), updated once per locked shape
+	uint64_t pieceZobristKey{ 0 };	// the Zobrist key of currentShape, updated with shapeKey
+public:
+	// MEMBER FUNCTIONS
+
+	// constructor
+	//   start a new game with the given seed
+	// - param 1: a uint64_t, the seed for the first game's piece sequence
+	//   (each later game is seeded from the previous game's randomizer)
+	TetrisEngine(uint64_t seed);
+
+	// register something to be told about game events
+	// - param 1: a TetrisListener pointer (not owned), or nullptr for none
+	// - return: nothing
+	void setListener(TetrisListener *listener);
+
+	// reset everything for a new game, using the current seed
+	//  - set the score and level to 0
+	//  - call determineGravity() to determine the fall rate.
+	//  - clear the gameboard,
+	//  - restart the randomizer from seed
+	//  - pick & spawn next shape
+	//  - pick next shape again (for the "on-deck" shape)
+	//  - tell the listener (onNewGame)
+	// - params: none
+	// - return: nothing
+	void reset();
+
+	// start the following game: draw a new seed from the randomizer and reset()
+	// - params: none
+	// - return: nothing
+	void newGame();
+
+	// apply a player action to the current shape
+	//   does nothing once the game is over
+	// - param 1: an Input, the action
+	// - return: bool, true if the action changed the current shape
+	bool input(Input action);
+
+	// advance the game by one frame
+	//   handles gravity & tetromino placement (locking): the current shape falls
+	//   the whole rows of gravity that are due (see fall()), and when a shape has
+	//   been locked, spawn the next one, clear rows and update score and level.
+	//   does nothing once the game is over
+	// - params: none
+	// - return: nothing
+	void step();
+
+	// A tick() forces the currentShape to fall one row (if there were no tick,
+	// the currentShape would float in position forever).  If it can move no
+	// further, lock() the currentShape.
+	// - params: none
+	// - return: nothing
+	void tick();
+
+	// take a snapshot of the game (everything but the listener)
+	// - params: none
+	// - return: a GameState, the snapshot
+	GameState saveState() const;
+
+	// carry on from a snapshot taken by saveState()
+	//   the listener is kept, and is not told about the change
+	// - param 1: a GameState, the snapshot
+	// - return: nothing
+	void loadState(const GameState &state);
+
+	// start the current game at a higher level (e.g. for speed runs and bots)
+	//   updates the gravity to match
+	// - param 1: an int, the level
+	// - return: nothing
+	void setLevel(int level);
+
+	// getters for the game state
+	// - params: none
+	// - return: the matching member (see above)
+	const Gameboard &getBoard() const;
+	const GridTetromino &getCurrentShape() const;
+	const GridTetromino &getNextShape() const;
+	const GridTetromino &getGhostShape() const;
+	int64_t getScore() const;
+	int getLevel() const;
+	bool getGameOver() const;
+	uint64_t getSeed() const;
+	const Randomizer &getRandomizer() const;
+	uint32_t getFrame() const;
+	int32_t getGravity() const;
+
+	// get the rolling checksum of the game: every frame stepped folds in the board
+	// (occupancy and colors), the falling shape, the next shape, the randomizer,
+	// the score, level and rows cleared (see Checksum.h)
+	//   two games that have played the same frames the same way always agree;
+	//   games that differ on any frame disagree from then on (but for a 1 in
+	//   2^64 chance)
+	// - params: none
+	// - return: a uint64_t, 0 at the start of a game
+	uint64_t getChecksum() const;
+
+	// get the Zobrist key of the position: the board's occupancy, the falling
+	// shape (its shape, rotation and gridLoc) and the next shape (see Zobrist.h)
+	//   for bots to recognise positions they have seen before
+	// - params: none
+	// - return: a uint64_t
+	uint64_t getZobristKey() const;
+
+private:
+	// assign nextShape.setShape the next shape from the randomizer
+	// - params: none
+	// - return: nothing
+	void pickNextShape();
+
+	// update the ghost shape to drop just under the current shape
+	// - params: nothing
+	// - return: nothing
+	void updateGhostShape();
+
+	// update boardKey after the board changes (a lock, a line clear, a new game
+	// or a loaded state)
+	// - params: none
+	// - return: nothing
+	void updateBoardKey();
+
+	// update shapeKey (and pieceZobristKey) after the current shape moves, rotates or spawns
+	// - params: none
+	// - return: nothing
+	void updateShapeKey();
+
+	// update progressKey after a lock (or anything else that changes the next
+	// shape, the randomizer, score, level or rows cleared)
+	// - params: none
+	// - return: nothing
+	void updateProgressKey();
+
+	// copy the nextShape into the currentShape (through assignment)
+	//   position the currentShape to its spawn location.
+	//   The shape has spawned legally if the board can report a drop distance for it
+	//   (getDropDistance() returns -1 when the spawn spot is already blocked).
+	// - params: none
+	// - return: bool, true if the shape spawned legally, false if the board has topped out
+	bool spawnNextShape();
+
+	// make the currentShape fall up to the given number of rows in one move.
+	//   The distance it can fall comes from the board's skyline (getDropDistance()),
+	//   so the cost is the same for 1 row or 20.  If it is already resting on
+	//   the stack or the floor, lock() it instead.
+	// - param 1: an int, the rows to fall
+	// - return: nothing
+	void fall(int rows);
+
+	// spawn the next shape after a lock, then remove the locked rows and
+	// update the score and level (or end the game if the spawn failed)
+	// - params: none
+	// - return: nothing
+	void processLock();
+
+	// Test if a rotation is legal on the tetromino and if so, rotate it.
+	//  To accomplish this (without copying the tetromino):
+	//	 1) ask WallKicks::resolveClockwise() for the first SRS kick where the
+	//      rotated shape fits on the board,
+	//	 2) if there is one - rotate the tetromino and move it by the kick.
+	// - param 1: GridTetromino shape
+	// - return: bool, true/false to indicate successful movement
+	bool attemptRotate(GridTetromino &shape);
+
+	// test if a move is legal on the tetromino, if so, move it.
+	//  To do this (without copying the tetromino):
+	//	 1) test the shape's block locs at its gridLoc plus the move (board.canPlace())
+	//	 2) if legal - move the shape.
+	// - param 1: GridTetromino shape
+	// - param 2: int x;
+	// - param 3: int y;
+	// - return: true/false to indicate successful movement
+	bool attemptMove(GridTetromino &shape, int x, int y);
+
+	// drops the tetromino vertically as far as it can
+	//   legally go.  The distance comes from the board's skyline (getDropDistance()),
+	//   so the shape is moved once rather than one row at a time.
+	// - param 1: GridTetromino shape
+	// - return: nothing;
+	void drop(GridTetromino &shape);
+
+	// copy the contents (color) of the tetromino's mapped block locs to the grid.
+	//	 1) get the tetromino's mapped locs via tetromino.getBlockLocsMappedToGrid()
+	//   2) use the board's lockBlocks() method to set the content at the mapped locations,
+	//      keeping the rows it completed in lockedRows.
+	//   3) record the fact that we placed a shape by setting shapePlacedSinceLastStep
+	//      to true
+	//   4) tell the listener (onShapeLocked)
+	// - param 1: GridTetromino shape
+	// - return: nothing
+	void lock(GridTetromino &shape);
+
+	// Determine if a Tetromino can legally be placed at its current position
+	// on the gameboard.
+	//   Uses Gameboard's canPlace() on the shape's block locs at its gridLoc, which
+	//   checks the borders and the board content in a single pass.
+	// - param 1: GridTetromino shape
+	// - return: bool, true if shape is within borders and
+	//           the shape's mapped board locs are empty (false otherwise).
+	bool isPositionLegal(const GridTetromino &shape) const;
+
+	// Determine if the shape is within the left, right, & bottom gameboard borders
+	//   * Ignore the upper border because we want shapes to be able to drop
+	//     in from the top of the gameboard.
+	//   All of a shape's blocks must be inside these 3 borders to return true
+	// - param 1: GridTetromino shape
+	// - return: bool, true if the shape is within the left, right, and lower border
+	//	         of the grid, but *NOT* the top border (false otherwise)
+	bool isWithinBorders(const GridTetromino &shape) const;
+
+	// set gravity from the level
+	//   - level 0 falls a row every MAX_FRAMES_PER_ROW frames, and each level
+	//     takes 1/100th of a second off that
+	//   - once that reaches 1 row per frame, each further 1/60th of a second
+	//     adds another row per frame, up to MAX_GRAVITY
+	// params: none
+	// return: nothing
+	void determineGravity();
+};
+
+#endif /* TETRISENGINE_H */
@@ -1,50 +1,58 @@
-// This class encapsulates the tetris game and its drawing routines, gameplay, & control logic.
+// This class is the SFML front end of a tetris game: it draws, plays and controls a TetrisEngine.
 // This class was designed so with the idea of potentially instantiating 2 of them
 // and have them run side by side (player vs player).
 // So, anything you would need for an individual tetris game has been included here.
 // Anything you might use between games (like the background, or the sprite used for 
 // rendering a tetromino block) was left in main.cpp
 // 
+// The rules and state of the game (board, shapes, score, level) live in the
+// TetrisEngine, which has no SFML dependency.  This class is a thin layer on top:
+// it turns key presses into engine inputs, draws what the engine holds, and
+// listens to the engine (as a TetrisListener) to play sounds and update text.
+// Every input goes to the engine through applyInput(), which also records it in
+// a Replay; each finished game's replay is saved to REPLAY_FILE.
+//
+// The game can also be played by an InputPolicy instead of (or as well as) the
+// keyboard - see setAutoPlayer().  Its inputs are chosen every frame, just before
+// the engine is stepped, and go through applyInput() like the keys do, so a bot's
+// game is recorded and replays the same way.
+//
 // This class is responsible for:
-//   - setting up the board,
 //	 - drawing game elements to the screen
-//   - spawning tetrominoes,
-//   - handling user input,
-//   - moving and placing tetrominoes 
+//   - playing the game's sounds
+//   - handling user input
 //
 //  [expected .cpp size: ~ 275 lines]
 
 #ifndef TETRISGAME_H
 #define TETRISGAME_H
 
-#include "Gameboard.h"
-#include "GridTetromino.h"
+#include <string>
+#include "TetrisEngine.h"
+#include "FixedTimestep.h"
+#include "InputPolicy.h"
+#include "Replay.h"
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 
 
-class TetrisGame
+class TetrisGame : public TetrisListener
 {
 public:
 	// STATIC CONSTANTS
 	static const int BLOCK_WIDTH;			  // pixel width of a tetris block, init to 32
 	static const int BLOCK_HEIGHT;			  // pixel height of a tetris block, int to 32
-	static const double MAX_SECONDS_PER_TICK; // the slowest "tick" rate (in seconds), init to 0.75
-	static const double MIN_SECONDS_PER_TICK; // the fastest "tick" rate (in seconds), init to 0.20
-	static const double MAX_LEVELS;
+	static const std::string REPLAY_FILE;	  // where each finished game's replay is saved, init to "lastgame.replay"
 
 private:	
 	// MEMBER VARIABLES
 
 	// State members ---------------------------------------------
-	int score;					// the current game score.
-	int level;					// the current level the player is on
-	int cleared;				// the amount of rows cleared on the current level
-	bool gameOver;
-    Gameboard board;			// the gameboard (grid) to represent where all the blocks are.
-    GridTetromino nextShape;	// the tetromino shape that is "on deck".
-    GridTetromino currentShape;	// the tetromino that is currently falling.
-	GridTetromino ghostShape;	// the ghost shape for where the current shape will land
+	TetrisEngine engine;		// the rules and state of the game
+	FixedTimestep timestep;		// turns the time between game loops into engine steps
+	Replay replay;				// the recording of the current game
+	bool recording{ false };	// false once the game stops matching its recording (see loadState())
+	InputPolicy *autoPlayer{ nullptr };	// plays the game every frame (not owned), or nullptr for the keyboard alone
 	
 	// Graphics members ------------------------------------------
 	sf::Sprite& blockSprite;		// the sprite used for all the blocks.
@@ -80,24 +88,18 @@ private:
 	sf::SoundBuffer clearedBuffer;		//SFML sound buffer for the cleared sound effect 
 	sf::Sound clearedSound;			//SFML sound object for the cleared sound effect
 	
-	// Time members ----------------------------------------------
-	// Note: a "tick" is the amount of time it takes a block to fall one line.
-	double secondsPerTick = MAX_SECONDS_PER_TICK; // the seconds per tick (changes depending on score)	
-
-	double secondsSinceLastTick{ 0.0 };			// update this every game loop until it is >= secsPerTick,
-												// we then know to trigger a tick.  Reduce this var (by a tick) & repeat.
-	bool shapePlacedSinceLastGameLoop{ false };	// Tracks whether we have placed (locked) a shape on
-												// the gameboard in the current gameloop	
 public:
 	// MEMBER FUNCTIONS
 
 	// constructor
 	//   initialize/assign private member vars names that match param names
-	//   reset() the game
 	//   load font from file: fonts/RedOctober.ttf
 	//   setup scoreText
-	// - params: already specified
-	TetrisGame(sf::RenderWindow& window, sf::Sprite& blockSprite, const Point& gameboardOffset, const Point& nextShapeOffset);
+	//   load the sounds, then listen to the engine and reset() it
+	// - params 1-4: already specified
+	// - param 5: a uint64_t, the seed for the first game's piece sequence
+	//   (each later game is seeded from the previous game's randomizer)
+	TetrisGame(sf::RenderWindow& window, sf::Sprite& blockSprite, const Point& gameboardOffset, const Point& nextShapeOffset, uint64_t seed);
 
 
 	// Draw anything to do with the game,
@@ -109,92 +111,62 @@ public:
 
 	// Event and game loop processing
 	// handles keypress events (up, left, right, down, space)
+	// by passing the matching input to the engine
 	// - param 1: sf::Event event
 	// - return: nothing
 	void onKeyPressed(sf::Event event);
 
-	// called every game loop to handle ticks & tetromino placement (locking)
-	// - param 1: float secondsSinceLastLoop
+	// called every game loop to advance the engine
+	//   the elapsed time goes into the fixed timestep, and the engine is stepped
+	//   once for each whole frame that is due (after the auto player's inputs, if any)
+	// - param 1: sf::Time timeSinceLastLoop
 	// return: nothing
-	void processGameLoop(float secondsSinceLastLoop);
+	void processGameLoop(sf::Time timeSinceLastLoop);
 
-	// A tick() forces the currentShape to move (if there were no tick,
-	// the currentShape would float in position forever). This should
-	// call attemptMove() on the currentShape.  If not successful, lock() 
-	// the currentShape (it can move no further).
-	// - params: none
+	// let an InputPolicy play the game (e.g. a bot - see BeamSearch.h)
+	//   the policy is started on the current game's seed, and again for each new game
+	// - param 1: an InputPolicy pointer (not owned), or nullptr to go back to the keyboard alone
 	// - return: nothing
-	void tick();
+	void setAutoPlayer(InputPolicy *policy);
 
-	// getter for the gameOver member variable
+	// get the InputPolicy playing the game
+	// - params: none
+	// - return: an InputPolicy pointer, or nullptr for none
+	InputPolicy *getAutoPlayer() const;
+
+	// getter for the engine's gameOver state
 	// - params: none
 	// - return: bool representing current state of the game
 	bool getGameOver() const;
 
-private:
-	// reset everything for a new game (use existing functions) 
-	//  - set the score to 0 and call updateScoreDisplay()
-	//  - call determineSecondsPerTick() to determine the tick rate.
-	//  - clear the gameboard,
-	//  - pick & spawn next shape
-	//  - pick next shape again (for the "on-deck" shape)
+	// take a snapshot of the game (see TetrisEngine::saveState())
 	// - params: none
-	// - return: nothing
-	void reset();
+	// - return: a GameState, the snapshot
+	GameState saveState() const;
 
-	// assign nextShape.setShape a new random shape  
-	// - params: none
-	// - return: nothing
-	void pickNextShape();
-	
-	// update the ghost shape to drop just under the current shape
-	// - params: nothing
+	// carry on from a snapshot (see TetrisEngine::loadState()),
+	//   then bring the score, level and game over text up to date
+	//   (the current game is no longer recorded: its replay would not play back)
+	// - param 1: a GameState, the snapshot
 	// - return: nothing
-	void updateGhostShape();
-
-	// copy the nextShape into the currentShape (through assignment)
-	//   position the currentShape to its spawn location.
-	// - params: none
-	// - return: bool, true/false based on isPositionLegal()
-	bool spawnNextShape();																	
-
-	// Test if a rotation is legal on the tetromino and if so, rotate it. 
-	//  To accomplish this:
-	//	 1) create a (local) temporary copy of the tetromino
-	//	 2) rotate it (temp.rotateClockwise())
-	//	 3) test if temp rotation was legal (isPositionLegal()), 
-	//      if so - rotate the original tetromino.
-	// - param 1: GridTetromino shape
-	// - return: bool, true/false to indicate successful movement
-	bool attemptRotate(GridTetromino &shape);
-   
-	// test if a move is legal on the tetromino, if so, move it.
-	//  To do this:
-	//	 1) create a (local) temporary copy of the tetromino
-	//	 2) move it (temp.move())
-	//	 3) test if temp move was legal (isPositionLegal(),
-	//      if so - move the original.	
-	// - param 1: GridTetromino shape
-	// - param 2: int x;
-	// - param 3: int y;
-	// - return: true/false to indicate successful movement
-	bool attemptMove(GridTetromino &shape, int x, int y);
+	void loadState(const GameState &state);
+
+	// TetrisListener events =========================================
+	// (called by the engine - play the matching sound and update the text)
+	void onNewGame() override;
+	void onRotate() override;
+	void onHardDrop() override;
+	void onRowsCleared(int rows) override;
+	void onScoreChanged(int64_t score) override;
+	void onLevelUp(int level) override;
+	void onGameOver() override;
 
-	// drops the tetromino vertically as far as it can 
-	//   legally go.  Use attemptMove(). This can be done in 1 line.
-	// - param 1: GridTetromino shape
-	// - return: nothing;
-	void drop(GridTetromino &shape);
+private:
+	// record an input in the replay and give it to the engine
+	// - param 1: the Input
+	// - return: nothing
+	void applyInput(TetrisEngine::Input input);
 
-	// copy the contents (color) of the tetromino's mapped block locs to the grid.
-		//	 1) get the tetromino's mapped locs via tetromino.getBlockLocsMappedToGrid()
-		//   2) use the board's setContent() method to set the content at the mapped locations.
-		//   3) record the fact that we placed a shape by setting shapePlacedSinceLastGameLoop
-		//      to true
-		// - param 1: GridTetromino shape
-		// - return: nothing
-	void lock(GridTetromino &shape);
-	
 	// Graphics methods ==============================================
 	
 	// Draw a tetris block sprite on the canvas		
@@ -230,7 +202,7 @@ private:
 	// param 1: GridTetromino tetromino
 	// param 2: Point topLeft
 	// return: nothing
-	void drawTetromino(GridTetromino &tetromino, Point topLeft, int transparency);
+	void drawTetromino(const GridTetromino &tetromino, Point topLeft, int transparency);
 	
 	// update the score display
 	// form a string "score: ##" to display the current score
@@ -245,37 +217,6 @@ private:
 	// params: none:
 	// return: nothing
 	void updateLevelDisplay();
-
-	// State & gameplay/logic methods ================================
-
-	// Determine if a Tetromino can legally be placed at its current position
-	// on the gameboard.
-	//   Tip: Make use of Gameboard's areLocsEmpty() and pass it the shape's mapped locs.
-	// - param 1: GridTetromino shape
-	// - return: bool, true if shape is within borders (isWithinBorders()) and 
-	//           the shape's mapped board locs are empty (false otherwise).
-	bool isPositionLegal(GridTetromino &shape) const;
-
-	
-	// Determine if the shape is within the left, right, & bottom gameboard borders
-	//   * Ignore the upper border because we want shapes to be able to drop
-	//     in from the top of the gameboard.
-	//   All of a shape's blocks must be inside these 3 borders to return true
-	// - param 1: GridTetromino shape
-	// - return: bool, true if the shape is within the left, right, and lower border
-	//	         of the grid, but *NOT* the top border (false otherwise)
-	bool isWithinBorders(GridTetromino shape) const;
-
-
-	// set secsPerTick 
-	//   - basic: use MAX_SECS_PER_TICK
-	//   - advanced: base it on score (higher score results in lower secsPerTick)
-	// params: none
-	// return: nothing
-	void determineSecondsPerTick();
-
-
 };
 
 #endif /* TETRISGAME_H */
-
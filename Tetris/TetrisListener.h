@@ -0,0 +1,50 @@
+// The TetrisListener interface lets something watch a TetrisEngine.
+//
+// The engine holds the rules and state of a game and knows nothing about windows,
+// sounds or fonts.  Anything that wants to react to what happens in a game
+// (play a sound, update a score display, log a replay...) derives from this class,
+// overrides the events it cares about and registers itself with
+// TetrisEngine::setListener().  Every event does nothing by default.
+//
+// Events are reported as they happen, from inside TetrisEngine::input() and
+// TetrisEngine::step().
+
+#ifndef TETRISLISTENER_H
+#define TETRISLISTENER_H
+
+#include <cstdint>
+
+class TetrisListener
+{
+public:
+	virtual ~TetrisListener() {}
+
+	// a new game has started (the board is empty, score and level are 0)
+	virtual void onNewGame() {}
+
+	// the current shape was rotated
+	virtual void onRotate() {}
+
+	// the current shape was hard dropped (and locked)
+	virtual void onHardDrop() {}
+
+	// the current shape was locked onto the board (by a hard drop, or by landing)
+	virtual void onShapeLocked() {}
+
+	// completed rows were removed from the board
+	// - param 1: an int, the number of rows removed (1-4)
+	virtual void onRowsCleared(int rows) {}
+
+	// the score changed
+	// - param 1: an int64_t, the new score
+	virtual void onScoreChanged(int64_t score) {}
+
+	// the player reached a new level
+	// - param 1: an int, the new level
+	virtual void onLevelUp(int level) {}
+
+	// the next shape could not spawn, the game is over
+	virtual void onGameOver() {}
+};
+
+#endif /* TETRISLISTENER_H */
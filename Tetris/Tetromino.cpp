@@ -1,4 +1,6 @@
 #include "Tetromino.h"
+#include "TetrominoTables.h"
+#include <cassert>
 #include <iostream>
 
 
@@ -12,7 +14,14 @@ Tetromino::Tetromino()
 // returns the current Color of the Tetromino
 TetColor Tetromino::getColor() const
 {
-	return color;
+	return TetrominoTables::SHAPES.colors[shape];
+}
+
+
+// returns the current rotation index of the Tetromino
+int Tetromino::getRotation() const
+{
+	return rotation;
 }
 
 
@@ -23,71 +32,39 @@ TetShape Tetromino::getShape() const
 }
 
 
-TetShape Tetromino::getRandomShape()
+// returns the block locations of the shape (relative to [0,0]),
+// straight from the precomputed orientation in TetrominoTables
+const BlockList &Tetromino::getBlockLocs() const
 {
-	int rand_num = rand() % static_cast<int>(TetShape::COUNT);
-	return static_cast<TetShape>(rand_num);
+	return TetrominoTables::SHAPES.orientations[shape][rotation].blocks;
 }
 
-// sets the shape for the Tetromino
-//color and blocks are based on the shape so those are set as well
+// sets the shape for the Tetromino (in its spawn orientation)
+//color and blocks are looked up from the shape, so nothing else is set
 void Tetromino::setShape(TetShape shape)
 {
 	this->shape = shape;
-	switch (shape) 
-	{
-		case O:
-			color = TetColor::YELLOW;
-			blockLocs = { Point(0,0), Point(0,1), Point(1,0), Point(1,1) };
-			break;
-		case I:
-			color = TetColor::BLUE_LIGHT;
-			blockLocs = { Point(0,0), Point(0,-1), Point(0,1), Point(0,2) };
-			break;
-		case S:
-			color = TetColor::RED;
-			blockLocs = { Point(0,0), Point(-1,0), Point(0,1), Point(1,1) };
-			break;
-		case Z:
-			color = TetColor::GREEN;
-			blockLocs = { Point(0,0), Point(0,1), Point(1,0), Point(-1,1) };
-			break;
-		case L:
-			color = TetColor::ORANGE;
-			blockLocs = { Point(0,0), Point(1,-1), Point(0,-1), Point(0,1) };
-			break;
-		case J:
-			color = TetColor::BLUE_DARK;
-			blockLocs = { Point(0,0), Point(0,1), Point(-1,-1), Point(0,-1) };
-			break;
-		case T:
-			color = TetColor::PURPLE;
-			blockLocs = { Point(0,0), Point(-1,0), Point(1,0), Point(0,-1) };
-			break;
-	}
+	setRotation(0);
+}
 
+// sets the rotation index (the blocks are looked up from it)
+void Tetromino::setRotation(int rotation)
+{
+	assert((0 <= rotation && rotation < TetrominoTables::ROTATION_COUNT) && "Tetromino rotation out of range");
+	this->rotation = static_cast<int8_t>(rotation);
 }
 
 // rotates the tetromino 90 degrees 
 void Tetromino::rotateClockwise()
 {
-	if (shape == TetShape::O)
-	{
-	}
-	else 
-	{
-		for (auto& blockloc : blockLocs)
-		{
-			blockloc.multiplyX(-1);
-			blockloc.swapXY();
-		}
-	}
+	setRotation((rotation + 1) % TetrominoTables::ROTATION_COUNT);
 }
 
 
 // prints the tetromino to a 7/7 grid
 void Tetromino::printToConsole() const
 {
+	const BlockList &blockLocs = getBlockLocs();
 	Point current_point = Point(-3, 3);
 	for (int i = 0; i < 7; i++)
 	{
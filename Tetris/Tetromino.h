@@ -1,10 +1,12 @@
 #pragma once
-#include <vector>
+#include <cstdint>
 #include "Point.h"
+#include "BlockList.h"
 
 
 // all the possible colors for a tetris piece
-enum TetColor
+// (stored in a byte, to keep tetrominoes and game states small)
+enum TetColor : int8_t
 {
 	RED,
 	ORANGE,
@@ -16,7 +18,8 @@ enum TetColor
 };
 
 // all the possible shapes for a tetris piece
-enum TetShape
+// (stored in a byte, to keep tetrominoes and game states small)
+enum TetShape : int8_t
 {
 	S,
 	Z,
@@ -32,10 +35,10 @@ class Tetromino
 {
 	friend class TestSuite;// (allows TestSuite access to private members for testing)
 	private:
-		TetColor color;
+		// the shape and its orientation are all a tetromino is: its color and
+		// blocks are looked up in TetrominoTables, so copying one is two bytes
 		TetShape shape;
-	protected:
-		std::vector<Point> blockLocs;
+		int8_t rotation{ 0 };	// the orientation (0-3) of the shape, an index into TetrominoTables
 	public:
 		// constructor for the Tetromino class
 		Tetromino();
@@ -49,23 +52,29 @@ class Tetromino
 		TetColor getColor() const;
 
 
-		// returns a random tetshape
-		static TetShape getRandomShape();
+		// returns the current rotation index (0-3) of the Tetromino
+		int getRotation() const;
 
-		// - set the shape
-		// - set the blockLocs for the shape
-		// - set the color for the shape
+
+		// returns the block locations of the shape (relative to [0,0]),
+		// a reference into the precomputed orientation in TetrominoTables
+		const BlockList &getBlockLocs() const;
+
+
+		// set the shape (in its spawn orientation, rotation 0)
+		// (its blocks and color come from TetrominoTables)
 		void setShape(TetShape shape);
 
 
+		// set the rotation index (0-3) of the shape
+		// assert the rotation is between 0 and 3
+		void setRotation(int rotation);
+
+
 		// rotate the shape 90 degrees around [0,0] (clockwise)
-		// to do this:
-		// - iterate through blockLocs
-		// - rotate each Point 90 degrees clockwise around [0,0]
-		// hint: as you rotate the point [1,2] clockwise around [0,0], note
-		// how the x,y values change. Once you find the pattern you can use
-		// a couple existing methods in the Point class to accomplish this.
-		// make it so that the TetShape::O doesnt rotate
+		// every orientation is precomputed (see TetrominoTables.h), so this
+		// just steps the rotation index.
+		// the TetShape::O orientations are all the same, so it doesn't rotate.
 		void rotateClockwise();
 
 
@@ -0,0 +1,138 @@
+// Compile-time tables describing every TetShape in each of its 4 orientations.
+//
+// Rather than building a shape's block locations at runtime and rotating them
+// point by point, every (shape, rotation) pair is worked out once by the compiler.
+// A tetromino then only needs its shape and a rotation index (0-3); rotating is
+// an index increment and everything else is a table lookup.
+//
+// For each orientation the table holds:
+//   - the 4 block offsets (relative to the shape's [0,0] block, y grows downwards),
+//     both as arrays and as the BlockList a Tetromino hands out
+//   - the bounding box of those offsets (minX/maxX/minY/maxY)
+//   - one bitmask per row of the bounding box: bit (x - minX) of rowMasks[y - minY]
+//     is set for every block at [x,y].  These line up with Gameboard row masks,
+//     so collision tests can be done with shifts and ANDs.
+//
+// Rotation is 90 degrees clockwise around [0,0]: [x,y] becomes [y,-x]
+// (the same as Point::multiplyX(-1) followed by Point::swapXY()).
+// The O shape does not rotate.
+
+#ifndef TETROMINOTABLES_H
+#define TETROMINOTABLES_H
+
+#include <cstdint>
+#include "Tetromino.h"
+
+namespace TetrominoTables
+{
+	static const int BLOCK_COUNT = 4;		// blocks in every tetromino
+	static const int ROTATION_COUNT = 4;	// orientations of every tetromino
+
+	// one orientation of a shape
+	struct Orientation
+	{
+		int8_t x[BLOCK_COUNT];				// block x offsets
+		int8_t y[BLOCK_COUNT];				// block y offsets
+		int8_t minX, maxX, minY, maxY;		// bounding box of the offsets
+		uint16_t rowMasks[BLOCK_COUNT];		// per-row block masks, from minY downwards
+		BlockList blocks;					// the offsets as Points (see Tetromino::getBlockLocs())
+	};
+
+	// every orientation of every shape, indexed [shape][rotation]
+	struct ShapeTable
+	{
+		Orientation orientations[TetShape::COUNT][ROTATION_COUNT];
+		TetColor colors[TetShape::COUNT];
+	};
+
+	// the spawn orientation (rotation 0) of each shape, in TetShape order
+	struct BaseShape
+	{
+		int8_t x[BLOCK_COUNT];
+		int8_t y[BLOCK_COUNT];
+		TetColor color;
+	};
+
+	constexpr BaseShape BASE_SHAPES[TetShape::COUNT] =
+	{
+		{ { 0, -1, 0, 1 }, { 0, 0, 1, 1 }, TetColor::RED },			// S
+		{ { 0, 0, 1, -1 }, { 0, 1, 0, 1 }, TetColor::GREEN },		// Z
+		{ { 0, 1, 0, 0 }, { 0, -1, -1, 1 }, TetColor::ORANGE },		// L
+		{ { 0, 0, -1, 0 }, { 0, 1, -1, -1 }, TetColor::BLUE_DARK },	// J
+		{ { 0, 0, 1, 1 }, { 0, 1, 0, 1 }, TetColor::YELLOW },		// O
+		{ { 0, 0, 0, 0 }, { 0, -1, 1, 2 }, TetColor::BLUE_LIGHT },	// I
+		{ { 0, -1, 1, 0 }, { 0, 0, 0, -1 }, TetColor::PURPLE }		// T
+	};
+
+	// fill in the bounding box, row masks and block list of an orientation from its offsets
+	constexpr void finishOrientation(Orientation &o)
+	{
+		o.minX = o.maxX = o.x[0];
+		o.minY = o.maxY = o.y[0];
+		for (int i = 1; i < BLOCK_COUNT; i++)
+		{
+			if (o.x[i] < o.minX) { o.minX = o.x[i]; }
+			if (o.x[i] > o.maxX) { o.maxX = o.x[i]; }
+			if (o.y[i] < o.minY) { o.minY = o.y[i]; }
+			if (o.y[i] > o.maxY) { o.maxY = o.y[i]; }
+		}
+		for (int row = 0; row < BLOCK_COUNT; row++)
+		{
+			o.rowMasks[row] = 0;
+		}
+		for (int i = 0; i < BLOCK_COUNT; i++)
+		{
+			o.rowMasks[o.y[i] - o.minY] |= static_cast<uint16_t>(1 << (o.x[i] - o.minX));
+		}
+		o.blocks = BlockList{ Point(o.x[0], o.y[0]), Point(o.x[1], o.y[1]), Point(o.x[2], o.y[2]), Point(o.x[3], o.y[3]) };
+	}
+
+	// build every orientation by rotating each base shape clockwise
+	constexpr ShapeTable buildShapeTable()
+	{
+		ShapeTable table{};
+		for (int shape = 0; shape < TetShape::COUNT; shape++)
+		{
+			table.colors[shape] = BASE_SHAPES[shape].color;
+			for (int i = 0; i < BLOCK_COUNT; i++)
+			{
+				table.orientations[shape][0].x[i] = BASE_SHAPES[shape].x[i];
+				table.orientations[shape][0].y[i] = BASE_SHAPES[shape].y[i];
+			}
+			finishOrientation(table.orientations[shape][0]);
+
+			for (int rotation = 1; rotation < ROTATION_COUNT; rotation++)
+			{
+				const Orientation &previous = table.orientations[shape][rotation - 1];
+				Orientation &current = table.orientations[shape][rotation];
+				for (int i = 0; i < BLOCK_COUNT; i++)
+				{
+					if (shape == TetShape::O)
+					{
+						current.x[i] = previous.x[i];
+						current.y[i] = previous.y[i];
+					}
+					else
+					{
+						current.x[i] = previous.y[i];
+						current.y[i] = static_cast<int8_t>(-previous.x[i]);
+					}
+				}
+				finishOrientation(current);
+			}
+		}
+		return table;
+	}
+
+	constexpr ShapeTable SHAPES = buildShapeTable();
+
+	// sanity checks, evaluated by the compiler
+	static_assert(SHAPES.orientations[TetShape::I][1].minX == -1 && SHAPES.orientations[TetShape::I][1].maxX == 2 &&
+		SHAPES.orientations[TetShape::I][1].rowMasks[0] == 0xF, "I shape should lie flat after one rotation");
+	static_assert(SHAPES.orientations[TetShape::O][3].rowMasks[0] == 0x3 && SHAPES.orientations[TetShape::O][3].rowMasks[1] == 0x3,
+		"O shape should not rotate");
+	static_assert(SHAPES.orientations[TetShape::T][0].rowMasks[0] == 0x2 && SHAPES.orientations[TetShape::T][0].rowMasks[1] == 0x7,
+		"T shape should point upwards at spawn");
+}
+
+#endif /* TETROMINOTABLES_H */
@@ -0,0 +1,180 @@
+#include <cassert>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include "TranspositionTable.h"
+
+static const uint64_t USED = 1ull << 63;		// set in the data of every stored entry
+static const int CACHE_LINE = 64;				// bytes in a bucket
+static const int SAMPLE_BUCKETS = 250;			// buckets getPerMille() looks at
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "TranspositionTable needs lock-free 64 bit atomics");
+static_assert(sizeof(float) == sizeof(uint32_t), "a value must fit in 32 bits");
+
+// pack an entry's data word
+// - param 1: a float, the value
+// - param 2: an int, the depth
+// - param 3: a uint8_t, the generation
+// - param 4: an int, the move
+// - return: a uint64_t, the data (never 0)
+static uint64_t packData(float value, int depth, uint8_t generation, int move)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits | static_cast<uint64_t>(depth) << 32 | static_cast<uint64_t>(generation) << 40 |
+		static_cast<uint64_t>(move) << 48 | USED;
+}
+
+// get the depth out of an entry's data word
+static int depthOf(uint64_t data)
+{
+	return static_cast<int>((data >> 32) & 0xFF);
+}
+
+// get the generation out of an entry's data word
+static uint8_t generationOf(uint64_t data)
+{
+	return static_cast<uint8_t>(data >> 40);
+}
+
+// constructor - allocate an empty table
+// assert bucketBits is between 1 and 30
+// - param 1: an int, log2 of the number of buckets (the table takes 64 << bucketBits bytes)
+TranspositionTable::TranspositionTable(int bucketBits)
+{
+	assert(bucketBits >= 1 && bucketBits <= 30 && "TranspositionTable - bucketBits out of range");
+	static_assert(sizeof(Slot) * BUCKET_SIZE == CACHE_LINE, "a bucket should be a cache line");
+	static_assert(std::is_trivially_destructible<Slot>::value, "the slots are never destroyed, only their bytes freed");
+
+	size_t buckets = static_cast<size_t>(1) << bucketBits;
+	bucketMask = buckets - 1;
+	// (new only promises the alignment of the largest plain type - as little as
+	//  8 bytes on a 32 bit build - so allocate a cache line more and make the
+	//  slots from the first byte on a cache line)
+	size_t size = buckets * CACHE_LINE;
+	size_t space = size + CACHE_LINE;
+	memory.reset(new uint8_t[space]);
+	void *start = memory.get();
+	start = std::align(CACHE_LINE, size, start, space);
+	assert(start && "TranspositionTable - a cache line more should always leave room to align");
+	slots = static_cast<Slot *>(start);
+	for (size_t i = 0; i < getCapacity(); i++)
+	{
+		new (&slots[i]) Slot;
+	}
+	clear();
+}
+
+// look up a position
+//   (thread safe, lock-free)
+// - param 1: a uint64_t, the position's Zobrist key
+// - param 2: an Entry, filled in if the position is found
+// - return: bool, true if it was found
+bool TranspositionTable::probe(uint64_t key, Entry &entry) const
+{
+	const Slot *bucket = slots + (key & bucketMask) * BUCKET_SIZE;
+	for (int i = 0; i < BUCKET_SIZE; i++)
+	{
+		uint64_t data = bucket[i].data.load(std::memory_order_relaxed);
+		uint64_t check = bucket[i].check.load(std::memory_order_relaxed);
+		if (data != 0 && (check ^ data) == key)
+		{
+			uint32_t bits = static_cast<uint32_t>(data);
+			std::memcpy(&entry.value, &bits, sizeof(bits));
+			entry.depth = depthOf(data);
+			entry.move = static_cast<int>((data >> 48) & MAX_MOVE);
+			return true;
+		}
+	}
+	return false;
+}
+
+// remember a position (replacing an entry if the bucket is full - see the top of this file)
+//   (thread safe, lock-free)
+// assert depth is between 0 and MAX_DEPTH, and move between 0 and MAX_MOVE
+// - param 1: a uint64_t, the position's Zobrist key
+// - param 2: a float, the value
+// - param 3: an int, the plies searched below the position (0 for a plain evaluation)
+// - param 4: an int, the best move found from the position (caller defined), or 0
+// - return: nothing
+void TranspositionTable::store(uint64_t key, float value, int depth, int move)
+{
+	assert(depth >= 0 && depth <= MAX_DEPTH && "TranspositionTable - depth out of range");
+	assert(move >= 0 && move <= MAX_MOVE && "TranspositionTable - move out of range");
+
+	Slot *bucket = slots + (key & bucketMask) * BUCKET_SIZE;
+	Slot *victim = nullptr;
+	int victimWorth = 0;
+	for (int i = 0; i < BUCKET_SIZE; i++)
+	{
+		uint64_t data = bucket[i].data.load(std::memory_order_relaxed);
+		uint64_t check = bucket[i].check.load(std::memory_order_relaxed);
+		if (data != 0 && (check ^ data) == key)
+		{
+			if (generationOf(data) == generation && depthOf(data) > depth)
+			{
+				return;		// a deeper search of the same position is already here
+			}
+			victim = &bucket[i];
+			break;
+		}
+		// an empty entry is worth least; otherwise its depth less a ply for each generation it has aged
+		int worth = (data == 0) ? -MAX_DEPTH - 256 : depthOf(data) - static_cast<uint8_t>(generation - generationOf(data));
+		if (!victim || worth < victimWorth)
+		{
+			victim = &bucket[i];
+			victimWorth = worth;
+		}
+	}
+
+	uint64_t data = packData(value, depth, generation, move);
+	victim->data.store(data, std::memory_order_relaxed);
+	victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+// start a new search generation: entries stored before now are the first to be
+// replaced (but are still found until they are)
+//   (call between searches, not during one)
+// - params: none
+// - return: nothing
+void TranspositionTable::newSearch()
+{
+	generation++;
+}
+
+// empty the table
+//   (call between searches, not during one)
+// - params: none
+// - return: nothing
+void TranspositionTable::clear()
+{
+	for (size_t i = 0; i < getCapacity(); i++)
+	{
+		slots[i].data.store(0, std::memory_order_relaxed);
+		slots[i].check.store(0, std::memory_order_relaxed);
+	}
+	generation = 0;
+}
+
+// get the number of entries the table holds
+// - params: none
+// - return: a size_t, buckets * BUCKET_SIZE
+size_t TranspositionTable::getCapacity() const
+{
+	return (bucketMask + 1) * BUCKET_SIZE;
+}
+
+// get how full the table is, from a sample of its first buckets
+// - params: none
+// - return: an int, the entries in use per thousand (from any generation)
+int TranspositionTable::getPerMille() const
+{
+	size_t sample = getCapacity() < static_cast<size_t>(SAMPLE_BUCKETS * BUCKET_SIZE) ? getCapacity() : SAMPLE_BUCKETS * BUCKET_SIZE;
+	size_t used = 0;
+	for (size_t i = 0; i < sample; i++)
+	{
+		used += (slots[i].data.load(std::memory_order_relaxed) != 0) ? 1 : 0;
+	}
+	return static_cast<int>(used * 1000 / sample);
+}
@@ -0,0 +1,111 @@
+// A TranspositionTable remembers what a bot search worked out about positions,
+// keyed by their Zobrist keys (see Zobrist.h), so a position reached again - by
+// another route, or on another thread - is looked up instead of worked out again.
+//
+// The table is a fixed size (a power of two of buckets, allocated once by the
+// constructor) and never grows: when a bucket is full, a store replaces one of
+// its entries.  Each bucket is 4 entries, 64 bytes - one cache line - and a key
+// always lands in the same bucket (its low bits), so a probe or a store touches
+// one line.  The replacement policy, in order:
+//   - the same key: overwritten, unless the entry there came from a deeper
+//     search in the current generation (it is worth more than the new one)
+//   - an empty entry
+//   - otherwise the entry worth least: the shallowest, counting each search
+//     generation it has aged (see newSearch()) as a ply less deep
+//
+// It is lock-free: any number of threads can probe and store at once, with no
+// mutex.  Each entry is two 64-bit atomics, the data (value, depth, move,
+// generation) and the key XORed with the data.  Two threads storing to the same
+// entry at once can leave one's key word with the other's data word, but then
+// key ^ data no longer gives back either key, so probe() sees a miss rather than
+// a wrong value.  The atomics are relaxed (on x86 they are plain loads and
+// stores): a probe may miss an entry another thread is storing, never more.
+//
+// The values are floats, so a caller that mixes cached and fresh values must
+// round the fresh ones to float too, or the two can compare differently.
+
+#ifndef TRANSPOSITIONTABLE_H
+#define TRANSPOSITIONTABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+class TranspositionTable
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+public:
+	// CONSTANTS
+	static const int BUCKET_SIZE = 4;		// entries per bucket (a cache line)
+	static const int MAX_DEPTH = 255;		// the deepest depth an entry can hold
+	static const int MAX_MOVE = 0x7FFF;		// the largest move an entry can hold
+
+	// what a probe finds
+	struct Entry
+	{
+		float value;		// the stored value
+		int depth;			// the plies searched below the position (0 for a plain evaluation)
+		int move;			// the best move found from the position (caller defined), or 0
+	};
+
+private:
+	// one entry: data is 0 while the entry is empty
+	struct Slot
+	{
+		std::atomic<uint64_t> check;	// the key ^ data
+		std::atomic<uint64_t> data;		// value (bits 0-31), depth (32-39), generation (40-47), move (48-62), used (63)
+	};
+
+	std::unique_ptr<uint8_t[]> memory;	// the bytes the slots are made in, with room to start the table on a cache line
+	Slot *slots;						// the first slot of the first bucket
+	uint64_t bucketMask;				// the buckets - 1 (the buckets are a power of two)
+	uint8_t generation{ 0 };			// the current search generation (see newSearch())
+
+public:
+	// constructor - allocate an empty table
+	// assert bucketBits is between 1 and 30
+	// - param 1: an int, log2 of the number of buckets (the table takes 64 << bucketBits bytes)
+	TranspositionTable(int bucketBits);
+
+	// look up a position
+	//   (thread safe, lock-free)
+	// - param 1: a uint64_t, the position's Zobrist key
+	// - param 2: an Entry, filled in if the position is found
+	// - return: bool, true if it was found
+	bool probe(uint64_t key, Entry &entry) const;
+
+	// remember a position (replacing an entry if the bucket is full - see the top of this file)
+	//   (thread safe, lock-free)
+	// assert depth is between 0 and MAX_DEPTH, and move between 0 and MAX_MOVE
+	// - param 1: a uint64_t, the position's Zobrist key
+	// - param 2: a float, the value
+	// - param 3: an int, the plies searched below the position (0 for a plain evaluation)
+	// - param 4: an int, the best move found from the position (caller defined), or 0
+	// - return: nothing
+	void store(uint64_t key, float value, int depth = 0, int move = 0);
+
+	// start a new search generation: entries stored before now are the first to be
+	// replaced (but are still found until they are)
+	//   (call between searches, not during one)
+	// - params: none
+	// - return: nothing
+	void newSearch();
+
+	// empty the table
+	//   (call between searches, not during one)
+	// - params: none
+	// - return: nothing
+	void clear();
+
+	// get the number of entries the table holds
+	// - params: none
+	// - return: a size_t, buckets * BUCKET_SIZE
+	size_t getCapacity() const;
+
+	// get how full the table is, from a sample of its first buckets
+	// - params: none
+	// - return: an int, the entries in use per thousand (from any generation)
+	int getPerMille() const;
+};
+
+#endif /* TRANSPOSITIONTABLE_H */
@@ -0,0 +1,36 @@
+#include "WallKicks.h"
+#include "TetrominoTables.h"
+
+// Find where a shape can rotate clockwise to.
+//   Try each kick candidate for the shape and rotation in order, testing the
+//   next orientation's row masks against the board, and stop at the first fit.
+// - param 1: the Gameboard to test against
+// - param 2: the TetShape being rotated
+// - param 3: an int, the rotation (0-3) the shape is turning from
+// - param 4: an int, the x of the shape's gridLoc
+// - param 5: an int, the y of the shape's gridLoc
+// - param 6: a Point, set to the kick (offset to add to the gridLoc) that fits
+// - return: true if a kick fits, false if the rotation is impossible
+bool WallKicks::resolveClockwise(const Gameboard &board, TetShape shape, int rotation, int x, int y, Point &kick)
+{
+	const TetrominoTables::Orientation &next =
+		TetrominoTables::SHAPES.orientations[shape][(rotation + 1) % TetrominoTables::ROTATION_COUNT];
+	int rowCount = next.maxY - next.minY + 1;
+	int width = next.maxX - next.minX + 1;
+
+	// O never kicks, I has its own table
+	int candidates = (shape == TetShape::O) ? 1 : KICK_COUNT;
+	const Kick *kicks = getKicks(shape, rotation);
+
+	for (int i = 0; i < candidates; i++)
+	{
+		int left = x + kicks[i].x + next.minX;
+		int top = y + kicks[i].y + next.minY;
+		if (board.canPlaceRows(next.rowMasks, rowCount, width, left, top))
+		{
+			kick.setXY(kicks[i].x, kicks[i].y);
+			return true;
+		}
+	}
+	return false;
+}
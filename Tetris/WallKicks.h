@@ -0,0 +1,103 @@
+// Super Rotation System (SRS) wall kicks.
+//
+// When a rotated shape does not fit where it is, SRS tries up to 4 alternative
+// positions ("kicks") before giving up, so a shape can rotate off a wall or the
+// stack the way real rule sets allow.  Which kicks are tried depends on the shape
+// (I has its own table, J/L/S/T/Z share one; O never needs to kick) and on the
+// rotation the shape is turning from.
+//
+// The kick tables are compile-time constants.  This game's rotateClockwise()
+// turns [x,y] into [y,-x] with y growing downwards (see TetrominoTables.h), which
+// is counter-clockwise on screen, so the offsets are the standard SRS
+// counter-clockwise ones (0 -> L, L -> 2, 2 -> R, R -> 0), converted to grid
+// co-ordinates (the SRS y values are negated).
+//
+// Every shape turns around the same block SRS does, but not every shape spawns
+// in SRS state 0: SPAWN_STATES gives the SRS state of each shape's rotation 0,
+// and getKicks() picks the row for the state a shape is turning from.  (The I
+// turns around a block rather than the centre of its 4x4 box, so its kicks are
+// tried from where that turn leaves it.)
+//
+// Each candidate is tested with Gameboard::canPlaceRows() - the shape's
+// precomputed row masks shifted against the board's row masks - and the
+// first candidate that fits wins.
+
+#ifndef WALLKICKS_H
+#define WALLKICKS_H
+
+#include <cstdint>
+#include "Gameboard.h"
+#include "Tetromino.h"
+
+namespace WallKicks
+{
+	static const int KICK_COUNT = 5;	// candidates per rotation (the first is "no kick")
+
+	// a kick offset, in grid co-ordinates
+	struct Kick
+	{
+		int8_t x;
+		int8_t y;
+	};
+
+	// the SRS states, in clockwise order; each turn here goes to the one before
+	enum State { STATE_0, STATE_R, STATE_2, STATE_L, STATE_COUNT };
+
+	// the SRS state of each shape at rotation 0, in TetShape order
+	constexpr State SPAWN_STATES[TetShape::COUNT] =
+	{
+		STATE_2,	// S (an SRS Z, flat, its top row on the left)
+		STATE_2,	// Z (an SRS S, flat, its top row on the right)
+		STATE_R,	// L (an SRS J, upright, its foot at the top right)
+		STATE_L,	// J (an SRS L, upright, its foot at the top left)
+		STATE_0,	// O
+		STATE_R,	// I (upright)
+		STATE_0		// T (pointing up)
+	};
+
+	// kicks for J, L, S, T and Z, indexed [SRS state turning from][candidate]
+	constexpr Kick JLSTZ_KICKS[STATE_COUNT][KICK_COUNT] =
+	{
+		{ { 0, 0 }, { 1, 0 }, { 1, -1 }, { 0, 2 }, { 1, 2 } },		// 0 -> L
+		{ { 0, 0 }, { 1, 0 }, { 1, 1 }, { 0, -2 }, { 1, -2 } },		// R -> 0
+		{ { 0, 0 }, { -1, 0 }, { -1, -1 }, { 0, 2 }, { -1, 2 } },	// 2 -> R
+		{ { 0, 0 }, { -1, 0 }, { -1, 1 }, { 0, -2 }, { -1, -2 } }	// L -> 2
+	};
+
+	// kicks for I, indexed [SRS state turning from][candidate]
+	constexpr Kick I_KICKS[STATE_COUNT][KICK_COUNT] =
+	{
+		{ { 0, 0 }, { -1, 0 }, { 2, 0 }, { -1, -2 }, { 2, 1 } },	// 0 -> L
+		{ { 0, 0 }, { 2, 0 }, { -1, 0 }, { 2, -1 }, { -1, 2 } },	// R -> 0
+		{ { 0, 0 }, { 1, 0 }, { -2, 0 }, { 1, 2 }, { -2, -1 } },	// 2 -> R
+		{ { 0, 0 }, { -2, 0 }, { 1, 0 }, { -2, 1 }, { 1, -2 } }		// L -> 2
+	};
+
+	// Get the kicks to try when a shape turns clockwise from a rotation.
+	// - param 1: the TetShape being rotated
+	// - param 2: an int, the rotation (0-3) the shape is turning from
+	// - return: a pointer to the shape's KICK_COUNT candidates, in order
+	constexpr const Kick *getKicks(TetShape shape, int rotation)
+	{
+		int state = (SPAWN_STATES[shape] - rotation + STATE_COUNT) % STATE_COUNT;
+		return (shape == TetShape::I) ? I_KICKS[state] : JLSTZ_KICKS[state];
+	}
+
+	// a T pointing up turns to point left (0 -> L), kicking right first, away from a wall on its left
+	static_assert(getKicks(TetShape::T, 0)[1].x == 1 && getKicks(TetShape::T, 3)[3].y == -2,
+		"T kicks should be the SRS counter-clockwise ones");
+
+	// Find where a shape can rotate clockwise to.
+	//   Try each kick candidate for the shape and rotation in order, testing the
+	//   next orientation's row masks against the board, and stop at the first fit.
+	// - param 1: the Gameboard to test against
+	// - param 2: the TetShape being rotated
+	// - param 3: an int, the rotation (0-3) the shape is turning from
+	// - param 4: an int, the x of the shape's gridLoc
+	// - param 5: an int, the y of the shape's gridLoc
+	// - param 6: a Point, set to the kick (offset to add to the gridLoc) that fits
+	// - return: true if a kick fits, false if the rotation is impossible
+	bool resolveClockwise(const Gameboard &board, TetShape shape, int rotation, int x, int y, Point &kick);
+}
+
+#endif /* WALLKICKS_H */
@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <cassert>
+#include "WorkerPool.h"
+
+// constructor - start the threads
+// - param 1: an int, the number of workers, counting the thread that calls run()
+//   (0 for one per hardware thread)
+WorkerPool::WorkerPool(int workers)
+{
+	if (workers <= 0)
+	{
+		workers = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+	}
+	for (int worker = 1; worker < workers; worker++)
+	{
+		threads.emplace_back(&WorkerPool::workerLoop, this, worker);
+	}
+}
+
+// destructor - stop and join the threads
+WorkerPool::~WorkerPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (auto &thread : threads)
+	{
+		thread.join();
+	}
+}
+
+// run a job on every worker and wait for all of its tasks to finish
+//   (not reentrant: a task must not call run() on the same pool)
+// - param 1: an int, the number of tasks (numbered 0 to taskCount - 1)
+// - param 2: the Job, called once for each task
+// - return: nothing
+void WorkerPool::run(int taskCount, const Job &job)
+{
+	assert(taskCount >= 0 && "WorkerPool - the number of tasks can't be negative");
+	if (threads.empty() || taskCount <= 1)
+	{
+		for (int task = 0; task < taskCount; task++)
+		{
+			job(task, 0);
+		}
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		assert(this->job == nullptr && "WorkerPool - run() is not reentrant");
+		this->job = &job;
+		this->taskCount = taskCount;
+		nextTask.store(0, std::memory_order_relaxed);
+		running = static_cast<int>(threads.size());
+		jobNumber++;
+	}
+	wake.notify_all();
+	drain(0);
+
+	std::unique_lock<std::mutex> lock(mutex);
+	finished.wait(lock, [this]() { return running == 0; });
+	this->job = nullptr;
+}
+
+// get the number of workers, counting the thread that calls run()
+// - params: none
+// - return: an int, at least 1
+int WorkerPool::getWorkers() const
+{
+	return static_cast<int>(threads.size()) + 1;
+}
+
+// take task numbers and run them until there are none left
+// - param 1: an int, the worker
+// - return: nothing
+void WorkerPool::drain(int worker)
+{
+	for (int task = nextTask.fetch_add(1, std::memory_order_relaxed); task < taskCount;
+		task = nextTask.fetch_add(1, std::memory_order_relaxed))
+	{
+		(*job)(task, worker);
+	}
+}
+
+// the loop each thread runs: wait for a job, drain() it, repeat until stopping
+// - param 1: an int, the worker
+// - return: nothing
+void WorkerPool::workerLoop(int worker)
+{
+	uint64_t lastJob = 0;
+	while (true)
+	{
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			wake.wait(lock, [this, lastJob]() { return stopping || jobNumber != lastJob; });
+			if (stopping)
+			{
+				return;
+			}
+			lastJob = jobNumber;
+		}
+
+		drain(worker);
+
+		std::lock_guard<std::mutex> lock(mutex);
+		if (--running == 0)
+		{
+			finished.notify_one();
+		}
+	}
+}
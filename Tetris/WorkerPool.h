@@ -0,0 +1,83 @@
+// A WorkerPool keeps a few threads waiting to share out the parts of one job,
+// for searches that split every move into many small tasks (see BeamSearch).
+//
+// GameFarm starts its threads once per run, which is fine for a run that lasts
+// minutes.  A bot search is different: it splits its work many times a second,
+// each time into a few dozen tasks that take microseconds, so starting threads
+// for each would cost more than the work.  The pool's threads are started once,
+// by the constructor, and sleep on a condition variable between jobs.
+//
+// run() hands out a job's tasks by number, from one atomic counter: each thread
+// (the calling thread too - it is worker 0) takes the next task number until
+// they run out, so a thread that drew quick tasks just takes more.  run() returns
+// once every task is done.  Which worker runs which task is not fixed, so a job
+// that wants the same result on any number of threads must not depend on it
+// (other than to pick the worker's own scratch memory).
+
+#ifndef WORKERPOOL_H
+#define WORKERPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class WorkerPool
+{
+	friend class TestSuite;// (allows TestSuite access to private members for testing)
+public:
+	// a job: called once for each task number, with the worker running it
+	typedef std::function<void(int task, int worker)> Job;
+
+private:
+	std::vector<std::thread> threads;	// the workers other than the caller (workers 1 and up)
+	std::mutex mutex;					// guards everything below but nextTask
+	std::condition_variable wake;		// signalled when a job starts (or the pool stops)
+	std::condition_variable finished;	// signalled when the last worker finishes a job
+	const Job *job{ nullptr };			// the job being run
+	int taskCount{ 0 };					// its number of tasks
+	std::atomic<int> nextTask{ 0 };		// the next task number to hand out
+	int running{ 0 };					// threads still working on the job
+	uint64_t jobNumber{ 0 };			// counts jobs, so a woken thread knows there is a new one
+	bool stopping{ false };				// set by the destructor
+
+public:
+	// constructor - start the threads
+	// - param 1: an int, the number of workers, counting the thread that calls run()
+	//   (0 for one per hardware thread)
+	WorkerPool(int workers = 0);
+
+	// destructor - stop and join the threads
+	~WorkerPool();
+
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	// run a job on every worker and wait for all of its tasks to finish
+	//   (not reentrant: a task must not call run() on the same pool)
+	// - param 1: an int, the number of tasks (numbered 0 to taskCount - 1)
+	// - param 2: the Job, called once for each task
+	// - return: nothing
+	void run(int taskCount, const Job &job);
+
+	// get the number of workers, counting the thread that calls run()
+	// - params: none
+	// - return: an int, at least 1
+	int getWorkers() const;
+
+private:
+	// take task numbers and run them until there are none left
+	// - param 1: an int, the worker
+	// - return: nothing
+	void drain(int worker);
+
+	// the loop each thread runs: wait for a job, drain() it, repeat until stopping
+	// - param 1: an int, the worker
+	// - return: nothing
+	void workerLoop(int worker);
+};
+
+#endif /* WORKERPOOL_H */
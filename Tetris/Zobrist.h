@@ -0,0 +1,104 @@
+// Compile-time Zobrist keys, for hashing positions in bot searches.
+//
+// A search reaches the same board by many routes (two placements in either
+// order, an O in any rotation), and working out the same board's score twice is
+// wasted work.  A Zobrist key names a position with one 64-bit number that is
+// cheap to keep up to date: every cell has its own random key, and a board's key
+// is the XOR of the keys of its filled cells, so filling or emptying a cell is
+// a single XOR.  Gameboard keeps its key this way (getZobristKey()), through
+// every setContent(), lock and line clear.
+//
+// The falling shape adds the keys of its shape, rotation, column and row, and
+// the next shape one more (see TetrisEngine::getZobristKey()).
+//
+// Only occupancy counts, not color: to a search, two boards with the same cells
+// filled are the same position.  (Checksum.h is the other way round - it is for
+// spotting games that drift apart, so it covers colors too.)
+//
+// The keys come from a splitmix64 sequence, worked out once by the compiler.
+
+#ifndef ZOBRIST_H
+#define ZOBRIST_H
+
+#include <cstdint>
+#include "Gameboard.h"
+#include "TetrominoTables.h"
+
+namespace Zobrist
+{
+	static const int MARGIN = 4;									// positions kept off each edge of the board
+	static const int PIECE_COLUMNS = Gameboard::MAX_X + 2 * MARGIN;	// falling shape gridLoc columns (-MARGIN to MAX_X+MARGIN-1)
+	static const int PIECE_ROWS = Gameboard::MAX_Y + 2 * MARGIN;	// falling shape gridLoc rows (-MARGIN to MAX_Y+MARGIN-1)
+
+	// every key
+	struct Keys
+	{
+		uint64_t cells[Gameboard::MAX_Y][Gameboard::MAX_X];		// a filled cell
+		uint64_t shapes[TetShape::COUNT];						// the falling shape
+		uint64_t rotations[TetrominoTables::ROTATION_COUNT];	// its rotation
+		uint64_t columns[PIECE_COLUMNS];						// its gridLoc column
+		uint64_t rows[PIECE_ROWS];								// its gridLoc row
+		uint64_t nextShapes[TetShape::COUNT];					// the "on deck" shape
+	};
+
+	// step a splitmix64 state and return its next output
+	constexpr uint64_t nextKey(uint64_t &state)
+	{
+		uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+	// deal every key from one sequence
+	constexpr Keys buildKeys()
+	{
+		Keys keys{};
+		uint64_t state = 0x5A0B1D7ull;
+		for (int y = 0; y < Gameboard::MAX_Y; y++)
+		{
+			for (int x = 0; x < Gameboard::MAX_X; x++)
+			{
+				keys.cells[y][x] = nextKey(state);
+			}
+		}
+		for (int shape = 0; shape < TetShape::COUNT; shape++)
+		{
+			keys.shapes[shape] = nextKey(state);
+			keys.nextShapes[shape] = nextKey(state);
+		}
+		for (int rotation = 0; rotation < TetrominoTables::ROTATION_COUNT; rotation++)
+		{
+			keys.rotations[rotation] = nextKey(state);
+		}
+		for (int x = 0; x < PIECE_COLUMNS; x++)
+		{
+			keys.columns[x] = nextKey(state);
+		}
+		for (int y = 0; y < PIECE_ROWS; y++)
+		{
+			keys.rows[y] = nextKey(state);
+		}
+		return keys;
+	}
+
+	constexpr Keys KEYS = buildKeys();
+
+	// get the key of a falling shape
+	//   (a shape more than MARGIN off the board shares the key of the nearest position kept)
+	// - param 1: an int, the TetShape
+	// - param 2: an int, the rotation
+	// - param 3: an int for X (its gridLoc)
+	// - param 4: an int for Y (its gridLoc)
+	// - return: a uint64_t
+	inline uint64_t pieceKey(int shape, int rotation, int x, int y)
+	{
+		int column = x + MARGIN;
+		int row = y + MARGIN;
+		column = (column < 0) ? 0 : ((column >= PIECE_COLUMNS) ? PIECE_COLUMNS - 1 : column);
+		row = (row < 0) ? 0 : ((row >= PIECE_ROWS) ? PIECE_ROWS - 1 : row);
+		return KEYS.shapes[shape] ^ KEYS.rotations[rotation] ^ KEYS.columns[column] ^ KEYS.rows[row];
+	}
+}
+
+#endif /* ZOBRIST_H */
@@ -0,0 +1,127 @@
+// The C interface in libtetris.h, implemented over TetrisEngine.
+//
+// Nothing here throws across the interface: the only allocation is in
+// tetris_create(), which uses the nothrow new and reports failure as NULL.
+
+#include <cstring>
+#include <new>
+#include "libtetris.h"
+#include "GameState.h"
+#include "Gameboard.h"
+#include "TetrisEngine.h"
+
+static_assert(TETRIS_WIDTH == Gameboard::MAX_X && TETRIS_HEIGHT == Gameboard::MAX_Y, "libtetris.h board size is out of date");
+static_assert(TETRIS_HEIGHT * sizeof(uint16_t) == sizeof(tetris_observation::rows), "tetris_observation.rows is the wrong size");
+static_assert(TETRIS_T == static_cast<int>(TetShape::T) && TETRIS_S == static_cast<int>(TetShape::S), "libtetris.h shape order is out of date");
+static_assert(TETRIS_MOVE_LEFT - 1 == TetrisEngine::MOVE_LEFT && TETRIS_HARD_DROP - 1 == TetrisEngine::HARD_DROP,
+	"libtetris.h inputs are out of date");
+
+struct tetris_game
+{
+	TetrisEngine engine;
+
+	explicit tetris_game(uint64_t seed)
+		:engine(seed)
+	{
+	}
+};
+
+// describe a shape for the C side
+static void fillPiece(const GridTetromino &shape, tetris_piece &piece)
+{
+	piece.shape = shape.getShape();
+	piece.rotation = shape.getRotation();
+	piece.x = shape.getGridLoc().getX();
+	piece.y = shape.getGridLoc().getY();
+}
+
+int tetris_version(void)
+{
+	return TETRIS_API_VERSION;
+}
+
+tetris_game *tetris_create(uint64_t seed)
+{
+	return new (std::nothrow) tetris_game(seed);
+}
+
+void tetris_destroy(tetris_game *game)
+{
+	delete game;
+}
+
+void tetris_reset(tetris_game *game, uint64_t seed)
+{
+	game->engine = TetrisEngine(seed);
+}
+
+int tetris_step(tetris_game *game, int input)
+{
+	if (input >= TETRIS_MOVE_LEFT && input <= TETRIS_HARD_DROP)
+	{
+		game->engine.input(static_cast<TetrisEngine::Input>(input - 1));
+	}
+	game->engine.step();
+	return game->engine.getGameOver() ? 1 : 0;
+}
+
+size_t tetris_snapshot_size(void)
+{
+	return sizeof(GameState);
+}
+
+void tetris_snapshot(const tetris_game *game, void *buffer)
+{
+	GameState state = game->engine.saveState();
+	std::memcpy(buffer, &state, sizeof(state));
+}
+
+void tetris_restore(tetris_game *game, const void *buffer)
+{
+	GameState state;
+	std::memcpy(&state, buffer, sizeof(state));
+	game->engine.loadState(state);
+}
+
+void tetris_observe(const tetris_game *game, tetris_observation *observation)
+{
+	tetris_observe_board_bits(game, observation->rows);
+	tetris_observe_pieces(game, &observation->current, &observation->next);
+	tetris_observe_stats(game, &observation->stats);
+}
+
+void tetris_observe_board_u8(const tetris_game *game, uint8_t *cells)
+{
+	const uint16_t *rows = game->engine.getBoard().getRowMasks();
+	for (int y = 0; y < Gameboard::MAX_Y; y++)
+	{
+		for (int x = 0; x < Gameboard::MAX_X; x++)
+		{
+			cells[y * Gameboard::MAX_X + x] = static_cast<uint8_t>((rows[y] >> x) & 1);
+		}
+	}
+}
+
+void tetris_observe_board_bits(const tetris_game *game, uint16_t *rows)
+{
+	std::memcpy(rows, game->engine.getBoard().getRowMasks(), Gameboard::MAX_Y * sizeof(uint16_t));
+}
+
+void tetris_observe_pieces(const tetris_game *game, tetris_piece *current, tetris_piece *next)
+{
+	fillPiece(game->engine.getCurrentShape(), *current);
+	fillPiece(game->engine.getNextShape(), *next);
+}
+
+void tetris_observe_stats(const tetris_game *game, tetris_stats *stats)
+{
+	stats->score = game->engine.getScore();
+	stats->level = game->engine.getLevel();
+	stats->frame = game->engine.getFrame();
+	stats->game_over = game->engine.getGameOver() ? 1 : 0;
+}
+
+uint64_t tetris_checksum(const tetris_game *game)
+{
+	return game->engine.getChecksum();
+}
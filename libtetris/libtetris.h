@@ -0,0 +1,184 @@
+/* libtetris - a C interface to the tetris engine, for driving games from other
+ * languages and training code.
+ *
+ * A tetris_game is a TetrisEngine (see Tetris/TetrisEngine.h) behind an opaque
+ * handle: no window, no sound, nothing loaded from disk.  The calls are
+ *   - tetris_create() / tetris_destroy(): the only calls that allocate or free
+ *   - tetris_reset():   start a new game from a seed
+ *   - tetris_step():    apply one input (or none) and advance the game one frame
+ *   - tetris_snapshot() / tetris_restore(): save and reload the whole game state
+ *   - tetris_observe*(): copy what the game looks like into the caller's buffers
+ *   - tetris_checksum(): the game's rolling checksum, to check two copies of a
+ *     game (two peers, two builds) are still playing in lockstep
+ * Every observation is written straight into memory the caller owns, so a
+ * training loop can step and observe millions of times without the library
+ * allocating anything or building intermediate copies.
+ *
+ * Only plain C types cross this interface (no C++ classes, exceptions or STL),
+ * and the header compiles as C or C++, so the ABI is stable across compilers.
+ * Check tetris_version() against TETRIS_API_VERSION to detect a mismatched
+ * header and library.
+ *
+ * Building: the libtetris project in Tetris.sln builds libtetris.dll on Windows.
+ * On Linux build the same sources into a shared library, e.g. from the repo root:
+ *   g++ -std=c++14 -O2 -shared -fPIC -fvisibility=hidden -DLIBTETRIS_EXPORTS -ITetris
+ *       libtetris/libtetris.cpp Tetris/BlockList.cpp Tetris/Gameboard.cpp Tetris/GridTetromino.cpp
+ *       Tetris/Point.cpp Tetris/Randomizer.cpp Tetris/TetrisEngine.cpp Tetris/Tetromino.cpp
+ *       Tetris/WallKicks.cpp -o libtetris.so
+ */
+
+#ifndef LIBTETRIS_H
+#define LIBTETRIS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/* TETRIS_API marks the exported functions */
+#if defined(_WIN32)
+#if defined(LIBTETRIS_EXPORTS)
+#define TETRIS_API __declspec(dllexport)
+#else
+#define TETRIS_API __declspec(dllimport)
+#endif
+#else
+#define TETRIS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TETRIS_API_VERSION 3	/* bumped whenever a declaration below changes */
+#define TETRIS_WIDTH 10			/* board columns (Gameboard::MAX_X) */
+#define TETRIS_HEIGHT 19		/* board rows (Gameboard::MAX_Y) */
+
+/* the inputs tetris_step() accepts */
+enum
+{
+	TETRIS_NO_INPUT = 0,
+	TETRIS_MOVE_LEFT,
+	TETRIS_MOVE_RIGHT,
+	TETRIS_SOFT_DROP,
+	TETRIS_ROTATE,
+	TETRIS_HARD_DROP
+};
+
+/* the shapes, in the order tetris_piece.shape uses */
+enum
+{
+	TETRIS_S = 0,
+	TETRIS_Z,
+	TETRIS_L,
+	TETRIS_J,
+	TETRIS_O,
+	TETRIS_I,
+	TETRIS_T
+};
+
+/* a game (opaque - only ever used through a pointer) */
+typedef struct tetris_game tetris_game;
+
+/* a shape and where it is: x, y is its gridLoc (its [0,0] block) and rotation is 0-3 */
+typedef struct tetris_piece
+{
+	int32_t shape;
+	int32_t rotation;
+	int32_t x;
+	int32_t y;
+} tetris_piece;
+
+/* the game's numbers */
+typedef struct tetris_stats
+{
+	int64_t score;
+	int32_t level;
+	uint32_t frame;			/* frames stepped in the current game */
+	int32_t game_over;		/* 1 once the game has ended (tetris_step() does nothing until a reset) */
+} tetris_stats;
+
+/* everything tetris_observe() writes */
+typedef struct tetris_observation
+{
+	uint16_t rows[TETRIS_HEIGHT];	/* occupancy bitplane: bit x of rows[y] is set when column x of row y is filled (row 0 is the top) */
+	tetris_piece current;			/* the falling shape */
+	tetris_piece next;				/* the "on deck" shape */
+	tetris_stats stats;
+} tetris_observation;
+
+/* get the interface version the library was built with
+ * - return: TETRIS_API_VERSION (of the library, not of this header) */
+TETRIS_API int tetris_version(void);
+
+/* create a game and start it
+ * - param 1: the seed for the game's piece sequence
+ * - return: the game, or NULL if it could not be allocated */
+TETRIS_API tetris_game *tetris_create(uint64_t seed);
+
+/* destroy a game made by tetris_create() (NULL is ignored) */
+TETRIS_API void tetris_destroy(tetris_game *game);
+
+/* start a new game from a seed
+ * - param 1: the game
+ * - param 2: the seed for the new game's piece sequence */
+TETRIS_API void tetris_reset(tetris_game *game, uint64_t seed);
+
+/* apply an input (TETRIS_NO_INPUT for none) and advance the game one frame
+ * - param 1: the game
+ * - param 2: one of the TETRIS_ inputs above
+ * - return: 1 if the game is over, else 0 */
+TETRIS_API int tetris_step(tetris_game *game, int input);
+
+/* get the size of a snapshot, in bytes */
+TETRIS_API size_t tetris_snapshot_size(void);
+
+/* save the whole state of a game
+ *   (a snapshot is the engine's GameState as it is in memory: it can be
+ *   restored into any game made by the same library build, not a different one)
+ * - param 1: the game
+ * - param 2: a buffer of at least tetris_snapshot_size() bytes, filled in */
+TETRIS_API void tetris_snapshot(const tetris_game *game, void *buffer);
+
+/* carry on a game from a snapshot made by tetris_snapshot()
+ * - param 1: the game
+ * - param 2: the snapshot */
+TETRIS_API void tetris_restore(tetris_game *game, const void *buffer);
+
+/* write the board bitplane, both pieces and the stats
+ * - param 1: the game
+ * - param 2: a tetris_observation, filled in */
+TETRIS_API void tetris_observe(const tetris_game *game, tetris_observation *observation);
+
+/* write the board as one byte per cell: 1 for a filled cell, 0 for an empty one
+ * - param 1: the game
+ * - param 2: a buffer of TETRIS_HEIGHT * TETRIS_WIDTH bytes, filled in row by row from the top */
+TETRIS_API void tetris_observe_board_u8(const tetris_game *game, uint8_t *cells);
+
+/* write the board bitplane (as in tetris_observation.rows)
+ * - param 1: the game
+ * - param 2: a buffer of TETRIS_HEIGHT uint16_t, filled in */
+TETRIS_API void tetris_observe_board_bits(const tetris_game *game, uint16_t *rows);
+
+/* write the current and next pieces
+ * - param 1: the game
+ * - param 2: a tetris_piece, set to the falling shape
+ * - param 3: a tetris_piece, set to the "on deck" shape */
+TETRIS_API void tetris_observe_pieces(const tetris_game *game, tetris_piece *current, tetris_piece *next);
+
+/* write the game's numbers
+ * - param 1: the game
+ * - param 2: a tetris_stats, filled in */
+TETRIS_API void tetris_observe_stats(const tetris_game *game, tetris_stats *stats);
+
+/* get the game's rolling checksum (see TetrisEngine::getChecksum()): every
+ * frame stepped folds the whole game state into it, so two games that have
+ * been stepped with the same seed and inputs agree, and a game that drifts
+ * disagrees from the frame it drifts on
+ * - param 1: the game
+ * - return: the checksum, 0 at the start of a game */
+TETRIS_API uint64_t tetris_checksum(const tetris_game *game);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LIBTETRIS_H */